@@ -21,6 +21,10 @@
 #include "etcd_lock.h"
 #include "etcd_election.h"
 #include "etcd_cluster.h"
+#include "etcd_cache.h"
+#include "etcd_shm.h"
+#include "etcd_lease_mgr.h"
+#include "etcd_batch.h"
 #include "etcd_txn.h"  /* For FREE_REQUEST_OPS macro */
 
 /* Types and common functions defined in etcd_common.h */
@@ -32,6 +36,8 @@ static void cq_async_callback(EV_P_ ev_async *w, int revents);
 static void process_grpc_event(pTHX_ ev_etcd_t *client, void *tag, int success);
 static void process_txn_response(pTHX_ pending_call_t *pc);
 static void process_auth_response(pTHX_ pending_call_t *pc);
+static void process_reauth_response(pTHX_ pending_call_t *pc, int success);
+static int queue_for_reauth(pTHX_ ev_etcd_t *client, pending_call_t *pc);
 static void process_user_add_response(pTHX_ pending_call_t *pc);
 static void process_user_delete_response(pTHX_ pending_call_t *pc);
 static void process_user_change_password_response(pTHX_ pending_call_t *pc);
@@ -47,8 +53,9 @@ static void process_user_grant_role_response(pTHX_ pending_call_t *pc);
 static void process_user_revoke_role_response(pTHX_ pending_call_t *pc);
 static void process_user_get_response(pTHX_ pending_call_t *pc);
 static void process_user_list_response(pTHX_ pending_call_t *pc);
-static SV* response_op_to_hashref(pTHX_ Etcdserverpb__ResponseOp *op);
-static void parse_request_ops(pTHX_ SV *src_av, Etcdserverpb__RequestOp ***dst_ops, size_t *dst_n);
+static SV* response_op_to_hashref(pTHX_ Etcdserverpb__ResponseOp *op, result_format_t format);
+static void parse_request_ops(pTHX_ SV *src_av, Etcdserverpb__RequestOp ***dst_ops, size_t *dst_n,
+                              unsigned char **dst_formats);
 
 /* Reconnection functions */
 static void reconnect_channel(ev_etcd_t *client);
@@ -171,7 +178,7 @@ static void *cq_thread_func(void *arg) {
     while (client->thread_running) {
         /* Poll with 100ms timeout to allow checking thread_running periodically */
         gpr_timespec deadline = gpr_time_add(
-            gpr_now(GPR_CLOCK_REALTIME),
+            gpr_now(GPR_CLOCK_MONOTONIC),
             gpr_time_from_millis(100, GPR_TIMESPAN));
 
         grpc_event event = grpc_completion_queue_next(client->cq, deadline, NULL);
@@ -213,56 +220,107 @@ static void *cq_thread_func(void *arg) {
     return NULL;
 }
 
+/*
+ * Deliver watch and keepalive results deferred during an event pass.
+ * Each stream is pinned while its callback runs so that a cleanup
+ * triggered from inside the callback cannot free it (or unlink the
+ * cursor) under us; the cleanup is completed here instead.
+ */
+static void flush_deferred_results(pTHX_ ev_etcd_t *client) {
+    watch_call_t *wc = client->watches;
+    while (wc && client->active) {
+        watch_call_t *next;
+        wc->delivering++;
+        watch_deliver_deferred(aTHX_ wc, 1);
+        if (!client->active) return;
+        next = wc->next;
+        if (--wc->delivering == 0 && wc->cleanup_pending) {
+            cleanup_watch(aTHX_ wc);
+        }
+        wc = next;
+    }
+
+    keepalive_call_t *kc = client->keepalives;
+    while (kc && client->active) {
+        keepalive_call_t *next;
+        kc->delivering++;
+        keepalive_deliver_deferred(aTHX_ kc, 1);
+        if (!client->active) return;
+        next = kc->next;
+        if (--kc->delivering == 0 && kc->cleanup_pending) {
+            cleanup_keepalive(aTHX_ kc);
+        }
+        kc = next;
+    }
+}
+
 /*
  * ev_async callback - runs in main thread when signaled by gRPC thread.
- * Drains the event queue and processes each event.
+ * Drains the event queue and processes each event. Streams re-arm their
+ * receive while being processed, so the queue is drained again (up to
+ * EV_ETCD_MAX_DRAIN_ROUNDS times) to pick up messages that completed in
+ * the meantime; stream results are then delivered once for the pass.
  */
+#define EV_ETCD_MAX_DRAIN_ROUNDS 64
+
 static void cq_async_callback(struct ev_loop *loop, ev_async *w, int revents) {
     dTHX;
     (void)loop;
     (void)revents;
 
     ev_etcd_t *client = (ev_etcd_t *)((char *)w - offsetof(ev_etcd_t, cq_async));
+    int round;
 
     /* Don't process if client is being destroyed */
     if (!client->active) {
         return;
     }
 
-    /* Drain the queue under lock, then process without lock */
-    pthread_mutex_lock(&client->queue_mutex);
-    queued_event_t *queue = client->event_queue;
-    client->event_queue = NULL;
-    client->event_queue_tail = NULL;
-    pthread_mutex_unlock(&client->queue_mutex);
-
     /* Guard against client being freed during event processing */
     client->in_callback = 1;
 
-    /* Process all queued events */
-    while (queue) {
-        queued_event_t *qe = queue;
-        queue = qe->next;
+    for (round = 0; round < EV_ETCD_MAX_DRAIN_ROUNDS && client->active; round++) {
+        /* Drain the queue under lock, then process without lock */
+        pthread_mutex_lock(&client->queue_mutex);
+        queued_event_t *queue = client->event_queue;
+        client->event_queue = NULL;
+        client->event_queue_tail = NULL;
+        pthread_mutex_unlock(&client->queue_mutex);
 
-        /* Skip NULL tags (e.g., from watch cancel messages) */
-        if (qe->tag) {
-            process_grpc_event(aTHX_ client, qe->tag, qe->success);
+        if (!queue) {
+            break;
         }
 
-        free(qe);
+        /* Process all queued events */
+        while (queue) {
+            queued_event_t *qe = queue;
+            queue = qe->next;
 
-        /* Check if client was destroyed during callback processing */
-        if (!client->active) {
-            /* Free remaining queued events */
-            while (queue) {
-                qe = queue;
-                queue = qe->next;
-                free(qe);
+            /* Skip NULL tags (e.g., from watch cancel messages) */
+            if (qe->tag) {
+                process_grpc_event(aTHX_ client, qe->tag, qe->success);
+            }
+
+            free(qe);
+
+            /* Check if client was destroyed during callback processing */
+            if (!client->active) {
+                /* Free remaining queued events */
+                while (queue) {
+                    qe = queue;
+                    queue = qe->next;
+                    free(qe);
+                }
+                break;
             }
-            break;
         }
     }
 
+    /* Events left after the last round were signalled and come next loop */
+    if (client->active) {
+        flush_deferred_results(aTHX_ client);
+    }
+
     client->in_callback = 0;
 
     /* If DESTROY was called during event processing, finish freeing the struct */
@@ -271,6 +329,132 @@ static void cq_async_callback(struct ev_loop *loop, ev_async *w, int revents) {
     }
 }
 
+/*
+ * Fork handling. gRPC state cannot cross fork(): the parent stops every
+ * client's CQ thread first (atfork_prepare), so that gRPC's own fork
+ * handlers find no thread inside gRPC, then restarts them (atfork_parent).
+ * The child lets go of everything it inherited without touching it and
+ * builds a channel, CQ and thread of its own (atfork_child).
+ */
+static ev_etcd_t *live_clients = NULL;
+static pid_t grpc_owner_pid;
+static int grpc_fork_support;
+
+static void unlink_live_client(ev_etcd_t *client) {
+    ev_etcd_t **cp = &live_clients;
+    while (*cp) {
+        if (*cp == client) {
+            *cp = client->next_client;
+            break;
+        }
+        cp = &(*cp)->next_client;
+    }
+}
+
+/* Drop every gRPC object inherited from the parent, leaking it */
+static void forget_inherited_state(pTHX_ ev_etcd_t *client) {
+    client->channel = NULL;
+    client->cq = NULL;
+
+    queued_event_t *qe = client->event_queue;
+    while (qe) {
+        queued_event_t *next = qe->next;
+        free(qe);
+        qe = next;
+    }
+    client->event_queue = NULL;
+    client->event_queue_tail = NULL;
+    pthread_mutex_init(&client->queue_mutex, NULL);
+
+    /* Unary calls answer to the parent; their callbacks never run here */
+    pending_call_t *pc = client->pending_calls;
+    while (pc) {
+        pending_call_t *next = pc->next;
+        FORGET_INHERITED_CALL(pc);
+        FREE_PENDING_CALL(pc);
+        pc = next;
+    }
+    client->pending_calls = NULL;
+    pc = client->reauth_queue;
+    while (pc) {
+        pending_call_t *next = pc->next;
+        FREE_PENDING_CALL(pc);
+        pc = next;
+    }
+    client->reauth_queue = NULL;
+    client->reauth_in_flight = 0;
+
+    /* So are the writes still waiting to be batched */
+    write_batch_discard(aTHX_ client);
+
+    watch_call_t *wc;
+    for (wc = client->watches; wc; wc = wc->next) {
+        FORGET_INHERITED_CALL(wc);
+    }
+    keepalive_call_t *kc;
+    for (kc = client->keepalives; kc; kc = kc->next) {
+        FORGET_INHERITED_CALL(kc);
+    }
+    observe_call_t *oc;
+    for (oc = client->observes; oc; oc = oc->next) {
+        FORGET_INHERITED_CALL(oc);
+    }
+    if (client->lease_mgr) {
+        lease_mgr_after_fork(aTHX_ client->lease_mgr, 1);
+    }
+}
+
+/* Child side: fresh gRPC state, then streams restored or dropped */
+static void client_after_fork(pTHX_ ev_etcd_t *client, int watches, int keepalives) {
+    forget_inherited_state(aTHX_ client);
+    client->pid = getpid();
+    client->quiesced = 0;
+
+    client->channel = etcd_create_insecure_channel(
+        client->endpoints[client->current_endpoint], NULL);
+    client->cq = grpc_completion_queue_create_for_next(NULL);
+    client->thread_running = 1;
+    if (!client->channel
+        || pthread_create(&client->cq_thread, NULL, cq_thread_func, client) != 0) {
+        client->thread_running = 0;
+        croak("Failed to recreate gRPC state after fork");
+    }
+
+    /* A failed restart reports through the stream's callback, which may
+     * destroy the client; the caller frees it in that case */
+    client->in_callback = 1;
+    watch_call_t *wc = client->watches;
+    while (wc && client->active) {
+        watch_call_t *next = wc->next;
+        if (wc->cache) {
+            cache_after_fork(aTHX_ wc->cache);
+        }
+        watch_after_fork(aTHX_ wc, watches);
+        wc = next;
+    }
+    keepalive_call_t *kc = client->keepalives;
+    while (kc && client->active) {
+        keepalive_call_t *next = kc->next;
+        keepalive_after_fork(aTHX_ kc, keepalives);
+        kc = next;
+    }
+    if (client->lease_mgr && !keepalives) {
+        lease_mgr_after_fork(aTHX_ client->lease_mgr, 0);
+    }
+    lease_pool_t *pool = client->lease_pools;
+    while (pool && client->active) {
+        lease_pool_after_fork(aTHX_ pool);
+        pool = pool->next;
+    }
+    observe_call_t *oc = client->observes;
+    while (oc && client->active) {
+        observe_call_t *next = oc->next;
+        observe_after_fork(aTHX_ oc, watches);
+        oc = next;
+    }
+    client->in_callback = 0;
+}
+
 /*
  * Process a single gRPC event. Called from the main thread.
  */
@@ -282,7 +466,10 @@ static void process_grpc_event(pTHX_ ev_etcd_t *client, void *tag, int success)
             watch_call_t *wc = (watch_call_t *)base;
 
             if (success && wc->active) {
+                    /* Pinned: a cleanup from inside the handler waits for us */
+                    wc->delivering++;
                     process_watch_response(aTHX_ wc);
+                    wc->delivering--;
                     /* Re-arm receive if still active */
                     if (wc->active) {
                         watch_rearm_recv(aTHX_ wc);
@@ -298,6 +485,7 @@ static void process_grpc_event(pTHX_ ev_etcd_t *client, void *tag, int success)
                         /* Reconnection initiated, don't notify callback yet */
                     } else {
                         /* Reconnection failed or disabled, notify callback and cleanup */
+                        watch_deliver_deferred(aTHX_ wc, 0);
                         dSP;
                         ENTER;
                         SAVETMPS;
@@ -325,7 +513,9 @@ static void process_grpc_event(pTHX_ ev_etcd_t *client, void *tag, int success)
             if (success) {
                     /* Process the first message that was received in the initial batch */
                     if (wc->recv_buffer) {
+                        wc->delivering++;
                         process_watch_response(aTHX_ wc);
+                        wc->delivering--;
                     }
                     /* Re-arm to receive more messages */
                     if (wc->active) {
@@ -335,6 +525,7 @@ static void process_grpc_event(pTHX_ ev_etcd_t *client, void *tag, int success)
                         cleanup_watch(aTHX_ wc);
                     }
                 } else {
+                    watch_deliver_deferred(aTHX_ wc, 0);
                     dSP;
                     ENTER;
                     SAVETMPS;
@@ -370,6 +561,7 @@ static void process_grpc_event(pTHX_ ev_etcd_t *client, void *tag, int success)
                         /* Reconnection initiated, don't notify callback yet */
                     } else {
                         /* Reconnection failed or disabled, notify callback and cleanup */
+                        keepalive_deliver_deferred(aTHX_ kc, 0);
                         dSP;
                         ENTER;
                         SAVETMPS;
@@ -407,6 +599,7 @@ static void process_grpc_event(pTHX_ ev_etcd_t *client, void *tag, int success)
                         cleanup_keepalive(aTHX_ kc);
                     }
                 } else {
+                    keepalive_deliver_deferred(aTHX_ kc, 0);
                     dSP;
                     ENTER;
                     SAVETMPS;
@@ -421,6 +614,10 @@ static void process_grpc_event(pTHX_ ev_etcd_t *client, void *tag, int success)
                     LEAVE;
                     cleanup_keepalive(aTHX_ kc);
                 }
+            } else if (base->type == CALL_TYPE_LEASE_STREAM_RECV
+                       || base->type == CALL_TYPE_LEASE_STREAM_SEND) {
+            /* Lease manager's shared keepalive stream */
+            lease_mgr_process_event(aTHX_ base, success);
             } else if (base->type == CALL_TYPE_ELECTION_OBSERVE_RECV) {
             /* Election observe receive completion */
             observe_call_t *oc = (observe_call_t *)base;
@@ -496,8 +693,52 @@ static void process_grpc_event(pTHX_ ev_etcd_t *client, void *tag, int success)
             } else {
             /* Unary RPC completion */
             pending_call_t *pc = (pending_call_t *)base;
+            int parked = 0;
+
+            /* Remove from pending list */
+            pending_call_t **pp = &client->pending_calls;
+            while (*pp) {
+                if (*pp == pc) {
+                    *pp = pc->next;
+                    break;
+                }
+                pp = &(*pp)->next;
+            }
 
-            if (success) {
+            /* Identical gets issued from the callbacks start a new call */
+            if (pc->dedupe_key) {
+                dedupe_forget(aTHX_ pc);
+            }
+
+            /*
+             * A response that beat the cancel is dropped undecoded and the
+             * call fails as CANCELLED. Lock and campaign still deliver
+             * theirs: the key they return has to be released by the caller.
+             */
+            if (success && pc->cancelled && pc->status == GRPC_STATUS_OK
+                && pc->base.type != CALL_TYPE_LOCK
+                && pc->base.type != CALL_TYPE_ELECTION_CAMPAIGN) {
+                pc->status = GRPC_STATUS_CANCELLED;
+                grpc_slice_unref(pc->status_details);
+                pc->status_details = grpc_slice_from_static_string("Cancelled");
+                success = 0;
+            }
+
+            if (pc->base.type == CALL_TYPE_REAUTH) {
+                process_reauth_response(aTHX_ pc, success);
+            } else if (success && pc->status == GRPC_STATUS_UNAUTHENTICATED
+                       && queue_for_reauth(aTHX_ client, pc)) {
+                /* Parked until a fresh token arrives; replayed or failed from there */
+                parked = 1;
+            } else if (pc->base.type == CALL_TYPE_WATCH_RESYNC) {
+                process_watch_resync_response(aTHX_ pc, success);
+            } else if (pc->base.type == CALL_TYPE_LEASE_POOL_GRANT) {
+                lease_pool_grant_done(aTHX_ pc, success);
+            } else if (pc->base.type == CALL_TYPE_WRITE_BATCH) {
+                write_batch_done(aTHX_ pc, success);
+            } else if (success && pc->raw) {
+                process_raw_response(aTHX_ pc);
+            } else if (success) {
                 switch (pc->base.type) {
                         case CALL_TYPE_RANGE:
                             process_range_response(aTHX_ pc);
@@ -649,30 +890,14 @@ static void process_grpc_event(pTHX_ ev_etcd_t *client, void *tag, int success)
                 }
 
                 /* Cleanup unary call */
-                grpc_metadata_array_destroy(&pc->initial_metadata);
-                grpc_metadata_array_destroy(&pc->trailing_metadata);
-                if (pc->recv_buffer) {
-                    grpc_byte_buffer_destroy(pc->recv_buffer);
+                if (!parked) {
+                    FREE_PENDING_CALL(pc);
                 }
-                grpc_slice_unref(pc->status_details);
-                grpc_call_unref(pc->call);
-                SvREFCNT_dec(pc->callback);
-
-                /* Remove from pending list */
-                pending_call_t **pp = &client->pending_calls;
-                while (*pp) {
-                    if (*pp == pc) {
-                        *pp = pc->next;
-                        break;
-                    }
-                    pp = &(*pp)->next;
-                }
-                Safefree(pc);
             }
 }
 
 /* Helper to convert ResponseOp to hashref */
-static SV* response_op_to_hashref(pTHX_ Etcdserverpb__ResponseOp *op) {
+static SV* response_op_to_hashref(pTHX_ Etcdserverpb__ResponseOp *op, result_format_t format) {
     HV *hv = newHV();
 
     if (op->response_case == ETCDSERVERPB__RESPONSE_OP__RESPONSE_RESPONSE_RANGE) {
@@ -680,11 +905,7 @@ static SV* response_op_to_hashref(pTHX_ Etcdserverpb__ResponseOp *op) {
         HV *range = newHV();
         add_header_to_hv(aTHX_ range, rr->header);
 
-        AV *kvs = newAV();
-        for (size_t i = 0; i < rr->n_kvs; i++) {
-            av_push(kvs, kv_to_hashref(aTHX_ rr->kvs[i]));
-        }
-        hv_store(range, "kvs", 3, newRV_noinc((SV *)kvs), 0);
+        hv_store(range, "kvs", 3, kvs_to_sv(aTHX_ rr->kvs, rr->n_kvs, format), 0);
         hv_store(range, "more", 4, newSViv(rr->more), 0);
         hv_store(range, "count", 5, newSViv(rr->count), 0);
 
@@ -720,10 +941,113 @@ static SV* response_op_to_hashref(pTHX_ Etcdserverpb__ResponseOp *op) {
     return newRV_noinc((SV *)hv);
 }
 
-/* Helper to parse Perl array of RequestOps into C structures */
-static void parse_request_ops(pTHX_ SV *src_av, Etcdserverpb__RequestOp ***dst_ops, size_t *dst_n) {
+/*
+ * Range options that need no allocation (limit, sorting, revision bounds,
+ * keys_only, ...), shared by get() and the range ops of txn().
+ */
+static void build_range_options(pTHX_ HV *hv, Etcdserverpb__RangeRequest *req) {
+    SV **svp;
+
+    /* limit */
+    if ((svp = hv_fetchs(hv, "limit", 0)) && SvOK(*svp)) {
+        req->limit = SvIV(*svp);
+    }
+
+    /* revision */
+    if ((svp = hv_fetchs(hv, "revision", 0)) && SvOK(*svp)) {
+        req->revision = SvIV(*svp);
+    }
+
+    /* keys_only */
+    if ((svp = hv_fetchs(hv, "keys_only", 0)) && SvTRUE(*svp)) {
+        req->keys_only = 1;
+    }
+
+    /* count_only */
+    if ((svp = hv_fetchs(hv, "count_only", 0)) && SvTRUE(*svp)) {
+        req->count_only = 1;
+    }
+
+    /* serializable */
+    if ((svp = hv_fetchs(hv, "serializable", 0)) && SvTRUE(*svp)) {
+        req->serializable = 1;
+    }
+
+    /* sort_order: NONE=0, ASCEND=1, DESCEND=2 */
+    if ((svp = hv_fetchs(hv, "sort_order", 0)) && SvOK(*svp)) {
+        const char *order = SvPV_nolen(*svp);
+        if (strEQ(order, "ascend") || strEQ(order, "ASCEND")) {
+            req->sort_order = ETCDSERVERPB__RANGE_REQUEST__SORT_ORDER__ASCEND;
+        } else if (strEQ(order, "descend") || strEQ(order, "DESCEND")) {
+            req->sort_order = ETCDSERVERPB__RANGE_REQUEST__SORT_ORDER__DESCEND;
+        }
+    }
+
+    /* sort_target: KEY=0, VERSION=1, CREATE=2, MOD=3, VALUE=4 */
+    if ((svp = hv_fetchs(hv, "sort_target", 0)) && SvOK(*svp)) {
+        const char *target = SvPV_nolen(*svp);
+        if (strEQ(target, "version") || strEQ(target, "VERSION")) {
+            req->sort_target = ETCDSERVERPB__RANGE_REQUEST__SORT_TARGET__VERSION;
+        } else if (strEQ(target, "create") || strEQ(target, "CREATE")) {
+            req->sort_target = ETCDSERVERPB__RANGE_REQUEST__SORT_TARGET__CREATE;
+        } else if (strEQ(target, "mod") || strEQ(target, "MOD")) {
+            req->sort_target = ETCDSERVERPB__RANGE_REQUEST__SORT_TARGET__MOD;
+        } else if (strEQ(target, "value") || strEQ(target, "VALUE")) {
+            req->sort_target = ETCDSERVERPB__RANGE_REQUEST__SORT_TARGET__VALUE;
+        }
+    }
+
+    /* min_mod_revision */
+    if ((svp = hv_fetchs(hv, "min_mod_revision", 0)) && SvOK(*svp)) {
+        req->min_mod_revision = SvIV(*svp);
+    }
+
+    /* max_mod_revision */
+    if ((svp = hv_fetchs(hv, "max_mod_revision", 0)) && SvOK(*svp)) {
+        req->max_mod_revision = SvIV(*svp);
+    }
+
+    /* min_create_revision */
+    if ((svp = hv_fetchs(hv, "min_create_revision", 0)) && SvOK(*svp)) {
+        req->min_create_revision = SvIV(*svp);
+    }
+
+    /* max_create_revision */
+    if ((svp = hv_fetchs(hv, "max_create_revision", 0)) && SvOK(*svp)) {
+        req->max_create_revision = SvIV(*svp);
+    }
+}
+
+/* Croak on a bad range op "format" before any op is allocated */
+static void check_request_op_formats(pTHX_ SV *src_av) {
+    if (!SvROK(src_av) || SvTYPE(SvRV(src_av)) != SVt_PVAV) return;
+
+    AV *av = (AV *)SvRV(src_av);
+    size_t n = av_len(av) + 1;
+    for (size_t i = 0; i < n; i++) {
+        SV **elem = av_fetch(av, i, 0);
+        if (!elem || !SvROK(*elem) || SvTYPE(SvRV(*elem)) != SVt_PVHV) continue;
+
+        HV *hv = (HV *)SvRV(*elem);
+        SV **range_sv = hv_fetch(hv, "request_range", 13, 0);
+        if (!range_sv) range_sv = hv_fetch(hv, "range", 5, 0);
+        if (!range_sv || !SvROK(*range_sv) || SvTYPE(SvRV(*range_sv)) != SVt_PVHV) continue;
+
+        SV **f = hv_fetch((HV *)SvRV(*range_sv), "format", 6, 0);
+        if (f && SvOK(*f)) parse_result_format(aTHX_ *f);
+    }
+}
+
+/*
+ * Helper to parse Perl array of RequestOps into C structures.
+ * If dst_formats is given it receives one result_format_t per op (the
+ * "format" option of range ops), or NULL when every op uses the default.
+ */
+static void parse_request_ops(pTHX_ SV *src_av, Etcdserverpb__RequestOp ***dst_ops, size_t *dst_n,
+                              unsigned char **dst_formats) {
     *dst_n = 0;
     *dst_ops = NULL;
+    if (dst_formats) *dst_formats = NULL;
 
     if (!SvROK(src_av) || SvTYPE(SvRV(src_av)) != SVt_PVAV) {
         return;
@@ -757,6 +1081,16 @@ static void parse_request_ops(pTHX_ SV *src_av, Etcdserverpb__RequestOp ***dst_o
             Newxz(rr, 1, Etcdserverpb__RangeRequest);
             etcdserverpb__range_request__init(rr);
 
+            /* Already checked by check_request_op_formats, cannot croak */
+            SV **f = hv_fetch(rh, "format", 6, 0);
+            if (dst_formats && f && SvOK(*f)) {
+                result_format_t format = parse_result_format(aTHX_ *f);
+                if (format != RESULT_FORMAT_FULL) {
+                    if (!*dst_formats) Newxz(*dst_formats, n, unsigned char);
+                    (*dst_formats)[i] = (unsigned char)format;
+                }
+            }
+
             SV **k = hv_fetch(rh, "key", 3, 0);
             if (k && SvPOK(*k)) {
                 STRLEN len;
@@ -773,6 +1107,7 @@ static void parse_request_ops(pTHX_ SV *src_av, Etcdserverpb__RequestOp ***dst_o
                 rr->range_end.data = (uint8_t *)str;
                 rr->range_end.len = len;
             }
+            build_range_options(aTHX_ rh, rr);
             (*dst_ops)[i]->request_case = ETCDSERVERPB__REQUEST_OP__REQUEST_REQUEST_RANGE;
             (*dst_ops)[i]->request_range = rr;
             continue;
@@ -854,9 +1189,18 @@ static void process_txn_response(pTHX_ pending_call_t *pc) {
 
     hv_store(result, "succeeded", 9, newSViv(resp->succeeded), 0);
 
+    /* txn_formats holds the success branch formats followed by the failure ones */
+    const unsigned char *formats = NULL;
+    size_t n_formats = 0;
+    if (pc->txn_formats) {
+        formats = resp->succeeded ? pc->txn_formats : pc->txn_formats + pc->txn_n_success;
+        n_formats = resp->succeeded ? pc->txn_n_success : pc->txn_n_failure;
+    }
+
     AV *responses = newAV();
     for (size_t i = 0; i < resp->n_responses; i++) {
-        av_push(responses, response_op_to_hashref(aTHX_ resp->responses[i]));
+        av_push(responses, response_op_to_hashref(aTHX_ resp->responses[i],
+            i < n_formats ? (result_format_t)formats[i] : RESULT_FORMAT_FULL));
     }
     hv_store(result, "responses", 9, newRV_noinc((SV *)responses), 0);
 
@@ -883,14 +1227,17 @@ static void process_auth_response(pTHX_ pending_call_t *pc) {
                 etcdserverpb__authenticate_response__free_unpacked(resp, NULL);
                 return;
             }
-            /* Securely free old token if exists */
-            if (client->auth_token) {
-                memset(client->auth_token, 0, client->auth_token_len);
-                Safefree(client->auth_token);
+            set_auth_token(client, resp->token, token_len);
+
+            /* Remember the credentials that worked, for auto_reauth */
+            if (client->auto_reauth && pc->request) {
+                if (client->reauth_request) {
+                    wipe_byte_buffer(client->reauth_request);
+                    grpc_byte_buffer_destroy(client->reauth_request);
+                }
+                client->reauth_request = pc->request;
+                pc->request = NULL;
             }
-            client->auth_token_len = token_len;
-            Newx(client->auth_token, token_len + 1, char);
-            Copy(resp->token, client->auth_token, token_len + 1, char);
         }
     }
 
@@ -906,6 +1253,323 @@ static void process_auth_response(pTHX_ pending_call_t *pc) {
     CALL_SUCCESS_CALLBACK(pc->callback, result);
 }
 
+/*
+ * Per-call timeout option: seconds, fractions allowed, 0 for no deadline.
+ * Returns pending_call_t.timeout (0 when absent: per-method or client
+ * default). Options that are not a hash are ignored, as elsewhere.
+ */
+static double opts_timeout(pTHX_ SV *opts, const char *method) {
+    if (!opts || !SvROK(opts) || SvTYPE(SvRV(opts)) != SVt_PVHV) return 0;
+
+    SV **svp = hv_fetchs((HV *)SvRV(opts), "timeout", 0);
+    if (!svp || !SvOK(*svp)) return 0;
+
+    NV timeout = SvNV(*svp);
+    if (timeout < 0) {
+        croak("%s: timeout must not be negative", method);
+    }
+    return timeout > 0 ? timeout : -1;
+}
+
+/* As opts_timeout, for the blocking calls whose options must be a hash */
+static double parse_call_timeout(pTHX_ SV *opts, const char *method) {
+    if (opts && (!SvROK(opts) || SvTYPE(SvRV(opts)) != SVt_PVHV)) {
+        croak("%s: options must be a hash reference", method);
+    }
+    return opts_timeout(aTHX_ opts, method);
+}
+
+/*
+ * new(timeouts => {...}): public method name to the call types it starts.
+ * Internal calls share their public counterpart's default.
+ */
+static const struct {
+    const char *name;
+    call_type_t type;
+} method_timeout_names[] = {
+    { "get",                     CALL_TYPE_RANGE },
+    { "get",                     CALL_TYPE_WATCH_RESYNC },
+    { "put",                     CALL_TYPE_PUT },
+    { "delete",                  CALL_TYPE_DELETE },
+    { "txn",                     CALL_TYPE_TXN },
+    { "txn",                     CALL_TYPE_WRITE_BATCH },
+    { "compact",                 CALL_TYPE_COMPACT },
+    { "status",                  CALL_TYPE_STATUS },
+    { "raw_call",                CALL_TYPE_RAW },
+    { "lease_grant",             CALL_TYPE_LEASE_GRANT },
+    { "lease_grant",             CALL_TYPE_LEASE_POOL_GRANT },
+    { "lease_revoke",            CALL_TYPE_LEASE_REVOKE },
+    { "lease_time_to_live",      CALL_TYPE_LEASE_TIME_TO_LIVE },
+    { "lease_leases",            CALL_TYPE_LEASE_LEASES },
+    { "authenticate",            CALL_TYPE_AUTH },
+    { "authenticate",            CALL_TYPE_REAUTH },
+    { "auth_enable",             CALL_TYPE_AUTH_ENABLE },
+    { "auth_disable",            CALL_TYPE_AUTH_DISABLE },
+    { "auth_status",             CALL_TYPE_AUTH_STATUS },
+    { "user_add",                CALL_TYPE_USER_ADD },
+    { "user_delete",             CALL_TYPE_USER_DELETE },
+    { "user_change_password",    CALL_TYPE_USER_CHANGE_PASSWORD },
+    { "user_get",                CALL_TYPE_USER_GET },
+    { "user_list",               CALL_TYPE_USER_LIST },
+    { "user_grant_role",         CALL_TYPE_USER_GRANT_ROLE },
+    { "user_revoke_role",        CALL_TYPE_USER_REVOKE_ROLE },
+    { "role_add",                CALL_TYPE_ROLE_ADD },
+    { "role_delete",             CALL_TYPE_ROLE_DELETE },
+    { "role_get",                CALL_TYPE_ROLE_GET },
+    { "role_list",               CALL_TYPE_ROLE_LIST },
+    { "role_grant_permission",   CALL_TYPE_ROLE_GRANT_PERMISSION },
+    { "role_revoke_permission",  CALL_TYPE_ROLE_REVOKE_PERMISSION },
+    { "lock",                    CALL_TYPE_LOCK },
+    { "unlock",                  CALL_TYPE_UNLOCK },
+    { "election_campaign",       CALL_TYPE_ELECTION_CAMPAIGN },
+    { "election_proclaim",       CALL_TYPE_ELECTION_PROCLAIM },
+    { "election_leader",         CALL_TYPE_ELECTION_LEADER },
+    { "election_resign",         CALL_TYPE_ELECTION_RESIGN },
+    { "member_add",              CALL_TYPE_MEMBER_ADD },
+    { "member_remove",           CALL_TYPE_MEMBER_REMOVE },
+    { "member_update",           CALL_TYPE_MEMBER_UPDATE },
+    { "member_list",             CALL_TYPE_MEMBER_LIST },
+    { "member_promote",          CALL_TYPE_MEMBER_PROMOTE },
+    { "alarm",                   CALL_TYPE_ALARM },
+    { "defragment",              CALL_TYPE_DEFRAGMENT },
+    { "hash_kv",                 CALL_TYPE_HASH_KV },
+    { "move_leader",             CALL_TYPE_MOVE_LEADER },
+};
+
+/*
+ * Fill per-method default deadlines from new(timeouts => {...}). Values
+ * are seconds, fractions allowed; 0 means no deadline for that method.
+ */
+static void parse_method_timeouts(pTHX_ SV *sv, double *timeouts) {
+    HV *hv;
+    HE *he;
+
+    if (!SvROK(sv) || SvTYPE(SvRV(sv)) != SVt_PVHV) {
+        croak("timeouts must be a hash reference");
+    }
+    hv = (HV *)SvRV(sv);
+
+    hv_iterinit(hv);
+    while ((he = hv_iternext(hv))) {
+        const char *name = HePV(he, PL_na);
+        SV *val = HeVAL(he);
+        size_t j;
+        int found = 0;
+
+        if (!SvOK(val)) continue;
+        NV timeout = SvNV(val);
+        if (timeout < 0) {
+            croak("timeouts: %s must not be negative", name);
+        }
+
+        for (j = 0; j < sizeof(method_timeout_names) / sizeof(method_timeout_names[0]); j++) {
+            if (strEQ(name, method_timeout_names[j].name)) {
+                timeouts[method_timeout_names[j].type] = timeout > 0 ? timeout : -1;
+                found = 1;
+            }
+        }
+        if (!found) {
+            croak("timeouts: unknown method '%s'", name);
+        }
+    }
+}
+
+/* Hand out an EV::Etcd::Call for one caller (slot) of a started call */
+static SV *attach_call_handle(pTHX_ pending_call_t *pc, int slot) {
+    call_handle_t *handle;
+    Newx(handle, 1, call_handle_t);
+    handle->pc = pc;
+    handle->slot = slot;
+    handle->next = pc->handle;
+    pc->handle = handle;
+    return sv_setref_pv(newSV(0), "EV::Etcd::Call", (void *)handle);
+}
+
+static SV *new_call_handle(pTHX_ pending_call_t *pc) {
+    return attach_call_handle(aTHX_ pc, 0);
+}
+
+/*
+ * dedupe: a get whose serialized RangeRequest (plus result format and raw
+ * flag) matches one already in flight joins it instead of sending its own.
+ * The first joiner replaces the call's callback with an anonymous XSUB
+ * that fans the one decoded response (or error) out to every caller.
+ * A caller that cancels is detached and gets CANCELLED; the RPC itself is
+ * only cancelled once no caller is left.
+ */
+/* Join callback to pc; returns the caller's slot for its handle */
+static int shared_call_attach(pTHX_ pending_call_t *pc, SV *callback) {
+    if (!pc->callers) {
+        AV *callers = newAV();
+        av_push(callers, pc->callback);  /* the first caller keeps slot 0 */
+        pc->callback = fanout_callback_new(aTHX_ callers);
+        pc->callers = callers;
+        pc->live_callers = 1;
+    }
+    av_push(pc->callers, newSVsv(callback));
+    pc->live_callers++;
+    return (int)av_len(pc->callers);
+}
+
+/* Detach one caller of a shared read; false if it already was */
+static int shared_call_detach(pTHX_ pending_call_t *pc, int slot) {
+    SV **svp = av_fetch(pc->callers, slot, 0);
+    SV *cb;
+    if (!svp || FANOUT_CALLER_DETACHED(*svp)) return 0;
+
+    cb = SvREFCNT_inc_simple_NN(*svp);
+    av_store(pc->callers, slot, newRV_noinc((SV *)av_make(1, &cb)));
+    SvREFCNT_dec(cb);
+    pc->live_callers--;
+    return 1;
+}
+
+/* The in-flight get a request with this dedupe key can join, if any */
+static pending_call_t *dedupe_find(pTHX_ ev_etcd_t *client, SV *key) {
+    HE *he;
+    if (!client->inflight) return NULL;
+    he = hv_fetch_ent(client->inflight, key, 0, 0);
+    return he ? INT2PTR(pending_call_t *, SvIV(HeVAL(he))) : NULL;
+}
+
+static SV *dedupe_key_for(pTHX_ grpc_slice req, result_format_t format, int raw) {
+    char tag[2];
+    SV *key = newSVpvn((const char *)GRPC_SLICE_START_PTR(req), GRPC_SLICE_LENGTH(req));
+    tag[0] = (char)format;
+    tag[1] = (char)raw;
+    sv_catpvn(key, tag, 2);
+    return key;
+}
+
+/*
+ * auto_reauth: a call that fails with UNAUTHENTICATED (usually an expired
+ * token) is parked on client->reauth_queue with its retained request bytes.
+ * One Authenticate call is issued with the last credentials that worked;
+ * when it returns, every parked call is replayed with the new token, or
+ * gets its original error if re-authentication failed. Each call is
+ * replayed at most once.
+ */
+static void fail_reauth_queue(pTHX_ ev_etcd_t *client) {
+    pending_call_t *pc = client->reauth_queue;
+    client->reauth_queue = NULL;
+    while (pc) {
+        pending_call_t *next = pc->next;
+        CALL_ERROR_CALLBACK(pc->callback, pc->status, pc->status_details, "auth");
+        FREE_PENDING_CALL(pc);
+        pc = next;
+    }
+}
+
+static void replay_reauth_queue(pTHX_ ev_etcd_t *client) {
+    pending_call_t *pc = client->reauth_queue;
+    client->reauth_queue = NULL;
+    while (pc) {
+        pending_call_t *next = pc->next;
+        if (pc->cancelled) {
+            CALL_ERROR_CALLBACK(pc->callback, pc->status, pc->status_details, "grpc_call");
+            FREE_PENDING_CALL(pc);
+            pc = next;
+            continue;
+        }
+        grpc_slice_unref(pc->status_details);
+        pc->status_details = grpc_empty_slice();
+        grpc_call_error err = start_unary_call(client, pc, pc->method,
+                                               grpc_byte_buffer_copy(pc->request));
+        if (err != GRPC_CALL_OK) {
+            CALL_SIMPLE_ERROR_CALLBACK(pc->callback, "Failed to replay call after re-authentication");
+            FREE_PENDING_CALL(pc);
+        }
+        pc = next;
+    }
+}
+
+static int start_reauth(pTHX_ ev_etcd_t *client) {
+    pending_call_t *pc;
+    INIT_PENDING_CALL(pc, CALL_TYPE_REAUTH, &PL_sv_undef, client);
+
+    /* Own bytes: a newer authenticate wipes reauth_request while this is sent */
+    grpc_call_error err = start_unary_call(client, pc, METHOD_AUTH_AUTHENTICATE,
+                                           copy_byte_buffer_bytes(client->reauth_request));
+    if (err != GRPC_CALL_OK) {
+        CLEANUP_PENDING_CALL_ON_ERROR(pc);
+        return 0;
+    }
+    client->reauth_in_flight = 1;
+    return 1;
+}
+
+/* Park an UNAUTHENTICATED call for replay. Returns 0 if it is not eligible. */
+static int queue_for_reauth(pTHX_ ev_etcd_t *client, pending_call_t *pc) {
+    if (!client->auto_reauth || !client->reauth_request || !pc->request
+        || pc->reauth_attempted || pc->cancelled || pc->base.type == CALL_TYPE_AUTH) {
+        return 0;
+    }
+
+    /* Internal calls have no Perl callback for the failure paths below;
+     * their own completion handlers deal with the error and retry */
+    if (pc->base.type == CALL_TYPE_LEASE_POOL_GRANT
+        || pc->base.type == CALL_TYPE_WATCH_RESYNC) {
+        return 0;
+    }
+
+    /* Reset per-attempt state; status and details are kept for a failed re-auth */
+    grpc_call_unref(pc->call);
+    pc->call = NULL;
+    grpc_metadata_array_destroy(&pc->initial_metadata);
+    grpc_metadata_array_destroy(&pc->trailing_metadata);
+    grpc_metadata_array_init(&pc->initial_metadata);
+    grpc_metadata_array_init(&pc->trailing_metadata);
+    if (pc->recv_buffer) {
+        grpc_byte_buffer_destroy(pc->recv_buffer);
+        pc->recv_buffer = NULL;
+    }
+    pc->reauth_attempted = 1;
+
+    /* Append to keep replay order */
+    pending_call_t **pp = &client->reauth_queue;
+    while (*pp) pp = &(*pp)->next;
+    pc->next = NULL;
+    *pp = pc;
+
+    if (!client->reauth_in_flight && !start_reauth(aTHX_ client)) {
+        fail_reauth_queue(aTHX_ client);
+    }
+    return 1;
+}
+
+/* Completion of the internal Authenticate call */
+static void process_reauth_response(pTHX_ pending_call_t *pc, int success) {
+    ev_etcd_t *client = pc->client;
+    int ok = 0;
+
+    client->reauth_in_flight = 0;
+
+    if (success && pc->status == GRPC_STATUS_OK && pc->recv_buffer) {
+        grpc_byte_buffer_reader reader;
+        if (grpc_byte_buffer_reader_init(&reader, pc->recv_buffer)) {
+            grpc_slice all = grpc_byte_buffer_reader_readall(&reader);
+            grpc_byte_buffer_reader_destroy(&reader);
+            Etcdserverpb__AuthenticateResponse *resp = etcdserverpb__authenticate_response__unpack(
+                NULL, GRPC_SLICE_LENGTH(all), GRPC_SLICE_START_PTR(all));
+            grpc_slice_unref(all);
+            if (resp) {
+                size_t token_len = resp->token ? strlen(resp->token) : 0;
+                if (token_len > 0 && token_len <= ETCD_MAX_VALUE_SIZE) {
+                    set_auth_token(client, resp->token, token_len);
+                    ok = 1;
+                }
+                etcdserverpb__authenticate_response__free_unpacked(resp, NULL);
+            }
+        }
+    }
+
+    if (ok) {
+        replay_reauth_queue(aTHX_ client);
+    } else {
+        fail_reauth_queue(aTHX_ client);
+    }
+}
+
 /* Helper macro for simple header-only responses */
 #define PROCESS_HEADER_ONLY_RESPONSE(func_name, response_type, unpack_func, free_func) \
 static void func_name(pTHX_ pending_call_t *pc) { \
@@ -1488,30 +2152,215 @@ static void process_user_list_response(pTHX_ pending_call_t *pc) {
     LEAVE;
 }
 
-MODULE = EV::Etcd  PACKAGE = EV::Etcd  PREFIX = ev_etcd_
+/*
+ * Fill a RangeRequest from a get() options hash. range_end storage is
+ * allocated into *range_end_copy (caller frees after serialization) and
+ * the "format" option is returned through *format.
+ */
+static void build_range_request(pTHX_ HV *hv, const char *key_str, STRLEN key_len,
+                                Etcdserverpb__RangeRequest *req, char **range_end_copy,
+                                result_format_t *format) {
+    SV **svp;
+
+    /* format - checked first so a bad value croaks before any allocation */
+    if ((svp = hv_fetchs(hv, "format", 0)) && SvOK(*svp)) {
+        *format = parse_result_format(aTHX_ *svp);
+    }
+
+    /* range_end - for range queries or prefix queries */
+    if ((svp = hv_fetchs(hv, "range_end", 0)) && SvOK(*svp)) {
+        STRLEN range_end_len;
+        const char *range_end_str = SvPV(*svp, range_end_len);
+        VALIDATE_KEY_SIZE(range_end_len);  /* range_end has same limits as key */
+        Newx(*range_end_copy, range_end_len, char);
+        memcpy(*range_end_copy, range_end_str, range_end_len);
+        req->range_end.data = (uint8_t *)*range_end_copy;
+        req->range_end.len = range_end_len;
+    }
+
+    /* prefix - convenience option to get all keys with given prefix */
+    if ((svp = hv_fetchs(hv, "prefix", 0)) && SvTRUE(*svp)) {
+        /* Don't override if range_end was explicitly provided */
+        if (!*range_end_copy && key_len > 0) {
+            size_t range_len;
+            *range_end_copy = compute_prefix_range_end(key_str, key_len, &range_len);
+            if (*range_end_copy) {
+                req->range_end.data = (uint8_t *)*range_end_copy;
+                req->range_end.len = range_len;
+            }
+        }
+    }
 
-PROTOTYPES: DISABLE
+    build_range_options(aTHX_ hv, req);
+}
 
-BOOT:
-    I_EV_API("EV::Etcd");
-    grpc_init();
-    init_method_slices();
-    /* Seed random number generator for backoff jitter */
-    srand((unsigned int)(time(NULL) ^ getpid()));
+/* Fill the option fields of a PutRequest from a put() options hash */
+static void build_put_request(pTHX_ HV *hv, Etcdserverpb__PutRequest *req) {
+    SV **svp;
 
-EV::Etcd
+    /* lease - lease ID to associate with key */
+    if ((svp = hv_fetchs(hv, "lease", 0)) && SvOK(*svp)) {
+        req->lease = SvIV(*svp);
+    }
+
+    /* prev_kv - return previous key-value pair */
+    if ((svp = hv_fetchs(hv, "prev_kv", 0)) && SvTRUE(*svp)) {
+        req->prev_kv = 1;
+    }
+
+    /* ignore_value - update lease without changing value */
+    if ((svp = hv_fetchs(hv, "ignore_value", 0)) && SvTRUE(*svp)) {
+        req->ignore_value = 1;
+    }
+
+    /* ignore_lease - update value without changing lease */
+    if ((svp = hv_fetchs(hv, "ignore_lease", 0)) && SvTRUE(*svp)) {
+        req->ignore_lease = 1;
+    }
+}
+
+/* True if an options hashref has a true "raw" entry */
+static int opts_want_raw(pTHX_ SV *opts) {
+    SV **svp;
+    if (!opts || !SvROK(opts) || SvTYPE(SvRV(opts)) != SVt_PVHV) {
+        return 0;
+    }
+    svp = hv_fetchs((HV *)SvRV(opts), "raw", 0);
+    return svp && SvTRUE(*svp);
+}
+
+/*
+ * Fill the per-watch delivery options shared by watch() and sync(); the
+ * range options differ between the two and are parsed by the caller.
+ */
+static void parse_watch_stream_opts(pTHX_ HV *hv, watch_call_t *wc) {
+    SV **svp;
+
+    /* auto_reconnect - enable/disable automatic reconnection (default: true) */
+    if ((svp = hv_fetchs(hv, "auto_reconnect", 0))) {
+        wc->auto_reconnect = SvTRUE(*svp) ? 1 : 0;
+    }
+
+    /* progress_notify - receive periodic progress notifications */
+    if ((svp = hv_fetchs(hv, "progress_notify", 0)) && SvTRUE(*svp)) {
+        wc->params.progress_notify = 1;
+    }
+
+    /* prev_kv - include previous key-value in events */
+    if ((svp = hv_fetchs(hv, "prev_kv", 0)) && SvTRUE(*svp)) {
+        wc->params.prev_kv = 1;
+    }
+
+    /* batch / max_batch - merge event responses drained in one pass */
+    if ((svp = hv_fetchs(hv, "batch", 0)) && SvTRUE(*svp)) {
+        wc->params.batch = 1;
+    }
+    if ((svp = hv_fetchs(hv, "max_batch", 0)) && SvOK(*svp) && SvIV(*svp) > 0) {
+        wc->params.batch = 1;
+        wc->params.max_batch = (size_t)SvIV(*svp);
+    }
+
+    /* max_pending_events - stop receiving while this many events are held */
+    if ((svp = hv_fetchs(hv, "max_pending_events", 0)) && SvOK(*svp) && SvIV(*svp) > 0) {
+        wc->max_pending_events = (size_t)SvIV(*svp);
+    }
+
+    /* recover_compaction - resync the range when resuming hits a compaction */
+    if ((svp = hv_fetchs(hv, "recover_compaction", 0)) && SvTRUE(*svp)) {
+        wc->params.recover_compaction = 1;
+    }
+
+    /* coalesce - keep only the newest event per key for this many seconds */
+    if ((svp = hv_fetchs(hv, "coalesce", 0)) && SvOK(*svp) && SvNV(*svp) > 0) {
+        wc->params.coalesce = SvNV(*svp);
+    }
+}
+
+/*
+ * Allocate a watch over every key under prefix that starts with a
+ * paged snapshot (sync() and cache()). Not yet on the client's list.
+ */
+static watch_call_t *new_sync_watch(pTHX_ ev_etcd_t *client, const char *prefix, size_t prefix_len,
+                                    SV *on_chunk, SV *on_event) {
+    watch_call_t *wc;
+    Newxz(wc, 1, watch_call_t);
+    init_call_functor(&wc->base, CALL_TYPE_WATCH);
+    wc->callback = newSVsv(on_event);
+    wc->sync_callback = newSVsv(on_chunk);
+    wc->client = client;
+    wc->active = 1;
+    wc->watch_id = -1;
+    grpc_metadata_array_init(&wc->initial_metadata);
+    grpc_metadata_array_init(&wc->trailing_metadata);
+    wc->status_details = grpc_empty_slice();
+    wc->auto_reconnect = 1;
+
+    /* The whole prefix; an empty prefix means every key */
+    Newx(wc->params.key, prefix_len + 1, char);
+    Copy(prefix, wc->params.key, prefix_len, char);
+    wc->params.key[prefix_len] = '\0';
+    wc->params.key_len = prefix_len;
+    if (prefix_len > 0) {
+        wc->params.range_end = compute_prefix_range_end(prefix, prefix_len,
+                                                        &wc->params.range_end_len);
+    }
+    if (!wc->params.range_end) {
+        Newxz(wc->params.range_end, 2, char);
+        wc->params.range_end_len = 1;
+    }
+    return wc;
+}
+
+/* page_size option of sync() and cache(), validated before allocating */
+static size_t parse_page_size(pTHX_ HV *hv) {
+    SV **svp;
+    if (hv && (svp = hv_fetchs(hv, "page_size", 0)) && SvOK(*svp)) {
+        IV page_size = SvIV(*svp);
+        if (page_size < 1) {
+            croak("page_size must be a positive integer");
+        }
+        return (size_t)page_size;
+    }
+    return 0;
+}
+
+MODULE = EV::Etcd  PACKAGE = EV::Etcd  PREFIX = ev_etcd_
+
+PROTOTYPES: DISABLE
+
+BOOT:
+    I_EV_API("EV::Etcd");
+    {
+        /* gRPC reads this once, in grpc_init */
+        const char *fork_env = getenv("GRPC_ENABLE_FORK_SUPPORT");
+        grpc_fork_support = fork_env && (strEQ(fork_env, "1") || strEQ(fork_env, "true"));
+    }
+    grpc_init();
+    grpc_owner_pid = getpid();
+    init_method_slices();
+    /* Seed random number generator for backoff jitter */
+    srand((unsigned int)(time(NULL) ^ getpid()));
+
+EV::Etcd
 ev_etcd_new(class, ...)
     char *class
 CODE:
 {
     ev_etcd_t *client;
     AV *endpoints_av = NULL;
-    int timeout_seconds = 30;  /* Default timeout */
+    double timeout_seconds = 30;  /* Default timeout */
+    double method_timeouts[CALL_TYPE_COUNT] = { 0 };
     int max_retries = 3;       /* Default max retries */
     int health_interval = 0;   /* Default: disabled */
     SV *health_callback = NULL;
     char *init_auth_token = NULL;
     STRLEN init_auth_token_len = 0;
+    int auto_reauth = 0;
+    int multicall = 1;
+    double lease_margin = 0;
+    int dedupe = 0;
+    int batch_max_ops = 0;
+    double batch_max_delay = 0;
     int i;
 
     /* Parse options */
@@ -1523,10 +2372,14 @@ CODE:
                     endpoints_av = (AV *)SvRV(ST(i + 1));
                 }
             } else if (strEQ(key, "timeout")) {
-                timeout_seconds = SvIV(ST(i + 1));
-                if (timeout_seconds < 1) {
-                    timeout_seconds = 1;  /* Minimum 1 second */
+                timeout_seconds = SvNV(ST(i + 1));
+                if (timeout_seconds <= 0) {
+                    timeout_seconds = 1;  /* Unset or nonsense: 1 second */
+                } else if (timeout_seconds < 0.001) {
+                    timeout_seconds = 0.001;  /* Minimum 1 millisecond */
                 }
+            } else if (strEQ(key, "timeouts")) {
+                parse_method_timeouts(aTHX_ ST(i + 1), method_timeouts);
             } else if (strEQ(key, "max_retries")) {
                 max_retries = SvIV(ST(i + 1));
                 if (max_retries < 0) {
@@ -1545,6 +2398,38 @@ CODE:
                 if (SvPOK(ST(i + 1))) {
                     init_auth_token = SvPV(ST(i + 1), init_auth_token_len);
                 }
+            } else if (strEQ(key, "auto_reauth")) {
+                auto_reauth = SvTRUE(ST(i + 1)) ? 1 : 0;
+            } else if (strEQ(key, "multicall")) {
+                multicall = SvTRUE(ST(i + 1)) ? 1 : 0;
+            } else if (strEQ(key, "lease_margin")) {
+                lease_margin = SvNV(ST(i + 1));
+                if (lease_margin < 0) {
+                    lease_margin = 0;
+                }
+            } else if (strEQ(key, "dedupe")) {
+                dedupe = SvTRUE(ST(i + 1)) ? 1 : 0;
+            } else if (strEQ(key, "autobatch")) {
+                SV *sv = ST(i + 1);
+                if (SvROK(sv) && SvTYPE(SvRV(sv)) == SVt_PVHV) {
+                    HV *hv = (HV *)SvRV(sv);
+                    SV **svp;
+                    batch_max_ops = 128;
+                    if ((svp = hv_fetchs(hv, "max_ops", 0)) && SvOK(*svp)) {
+                        batch_max_ops = SvIV(*svp);
+                        if (batch_max_ops < 1) {
+                            croak("autobatch: max_ops must be at least 1");
+                        }
+                    }
+                    if ((svp = hv_fetchs(hv, "max_delay", 0)) && SvOK(*svp)) {
+                        batch_max_delay = SvNV(*svp);
+                        if (batch_max_delay < 0) {
+                            croak("autobatch: max_delay must not be negative");
+                        }
+                    }
+                } else if (SvTRUE(sv)) {
+                    batch_max_ops = 128;
+                }
             }
         }
     }
@@ -1622,18 +2507,22 @@ CODE:
     client->keepalives = NULL;
     client->observes = NULL;
     /* Store auth token if provided */
-    if (init_auth_token && init_auth_token_len > 0) {
-        Newx(client->auth_token, init_auth_token_len + 1, char);
-        Copy(init_auth_token, client->auth_token, init_auth_token_len, char);
-        client->auth_token[init_auth_token_len] = '\0';
-        client->auth_token_len = init_auth_token_len;
-    } else {
-        client->auth_token = NULL;
-        client->auth_token_len = 0;
-    }
+    client->auth_token = grpc_empty_slice();
+    set_auth_token(client, init_auth_token, init_auth_token ? init_auth_token_len : 0);
+    client->auto_reauth = auto_reauth;
     client->timeout_seconds = timeout_seconds;
+    Copy(method_timeouts, client->method_timeouts, CALL_TYPE_COUNT, double);
     client->active = 1;
+    client->pid = getpid();
+    client->next_client = live_clients;
+    live_clients = client;
     client->in_callback = 0;
+    client->multicall = multicall;
+    client->lease_margin = lease_margin;
+    client->dedupe = dedupe;
+    client->batch_max_ops = batch_max_ops;
+    client->batch_max_delay = batch_max_delay;
+    write_batch_init(client);
 
     /* Retry configuration */
     client->max_retries = max_retries;
@@ -1661,7 +2550,7 @@ CODE:
 OUTPUT:
     RETVAL
 
-void
+SV *
 ev_etcd_get(client, key, ...)
     EV::Etcd client
     SV *key
@@ -1683,15 +2572,12 @@ CODE:
     }
 
     VALIDATE_CALLBACK(callback);
+    double timeout = opts_timeout(aTHX_ opts, "get");
 
     STRLEN key_len;
     const char *key_str = SvPV(key, key_len);
     VALIDATE_KEY_SIZE(key_len);
 
-    /* Create pending call structure */
-    pending_call_t *pc;
-    INIT_PENDING_CALL(pc, CALL_TYPE_RANGE, callback, client);
-
     /* Build RangeRequest */
     Etcdserverpb__RangeRequest req = ETCDSERVERPB__RANGE_REQUEST__INIT;
     req.key.data = (uint8_t *)key_str;
@@ -1699,103 +2585,20 @@ CODE:
 
     /* Storage for range_end to ensure it persists through serialization */
     char *range_end_copy = NULL;
+    result_format_t format = RESULT_FORMAT_FULL;
 
-    /* Parse options if provided */
     if (opts && SvROK(opts) && SvTYPE(SvRV(opts)) == SVt_PVHV) {
-        HV *hv = (HV *)SvRV(opts);
-        SV **svp;
-
-        /* range_end - for range queries or prefix queries */
-        if ((svp = hv_fetchs(hv, "range_end", 0)) && SvOK(*svp)) {
-            STRLEN range_end_len;
-            const char *range_end_str = SvPV(*svp, range_end_len);
-            VALIDATE_KEY_SIZE(range_end_len);  /* range_end has same limits as key */
-            Newx(range_end_copy, range_end_len, char);
-            memcpy(range_end_copy, range_end_str, range_end_len);
-            req.range_end.data = (uint8_t *)range_end_copy;
-            req.range_end.len = range_end_len;
-        }
-
-        /* prefix - convenience option to get all keys with given prefix */
-        if ((svp = hv_fetchs(hv, "prefix", 0)) && SvTRUE(*svp)) {
-            /* Don't override if range_end was explicitly provided */
-            if (!range_end_copy && key_len > 0) {
-                size_t range_len;
-                range_end_copy = compute_prefix_range_end(key_str, key_len, &range_len);
-                if (range_end_copy) {
-                    req.range_end.data = (uint8_t *)range_end_copy;
-                    req.range_end.len = range_len;
-                }
-            }
-        }
-
-        /* limit */
-        if ((svp = hv_fetchs(hv, "limit", 0)) && SvOK(*svp)) {
-            req.limit = SvIV(*svp);
-        }
-
-        /* revision */
-        if ((svp = hv_fetchs(hv, "revision", 0)) && SvOK(*svp)) {
-            req.revision = SvIV(*svp);
-        }
-
-        /* keys_only */
-        if ((svp = hv_fetchs(hv, "keys_only", 0)) && SvTRUE(*svp)) {
-            req.keys_only = 1;
-        }
-
-        /* count_only */
-        if ((svp = hv_fetchs(hv, "count_only", 0)) && SvTRUE(*svp)) {
-            req.count_only = 1;
-        }
-
-        /* serializable */
-        if ((svp = hv_fetchs(hv, "serializable", 0)) && SvTRUE(*svp)) {
-            req.serializable = 1;
-        }
-
-        /* sort_order: NONE=0, ASCEND=1, DESCEND=2 */
-        if ((svp = hv_fetchs(hv, "sort_order", 0)) && SvOK(*svp)) {
-            const char *order = SvPV_nolen(*svp);
-            if (strEQ(order, "ascend") || strEQ(order, "ASCEND")) {
-                req.sort_order = ETCDSERVERPB__RANGE_REQUEST__SORT_ORDER__ASCEND;
-            } else if (strEQ(order, "descend") || strEQ(order, "DESCEND")) {
-                req.sort_order = ETCDSERVERPB__RANGE_REQUEST__SORT_ORDER__DESCEND;
-            }
-        }
-
-        /* sort_target: KEY=0, VERSION=1, CREATE=2, MOD=3, VALUE=4 */
-        if ((svp = hv_fetchs(hv, "sort_target", 0)) && SvOK(*svp)) {
-            const char *target = SvPV_nolen(*svp);
-            if (strEQ(target, "version") || strEQ(target, "VERSION")) {
-                req.sort_target = ETCDSERVERPB__RANGE_REQUEST__SORT_TARGET__VERSION;
-            } else if (strEQ(target, "create") || strEQ(target, "CREATE")) {
-                req.sort_target = ETCDSERVERPB__RANGE_REQUEST__SORT_TARGET__CREATE;
-            } else if (strEQ(target, "mod") || strEQ(target, "MOD")) {
-                req.sort_target = ETCDSERVERPB__RANGE_REQUEST__SORT_TARGET__MOD;
-            } else if (strEQ(target, "value") || strEQ(target, "VALUE")) {
-                req.sort_target = ETCDSERVERPB__RANGE_REQUEST__SORT_TARGET__VALUE;
-            }
-        }
-
-        /* min_mod_revision */
-        if ((svp = hv_fetchs(hv, "min_mod_revision", 0)) && SvOK(*svp)) {
-            req.min_mod_revision = SvIV(*svp);
-        }
-
-        /* max_mod_revision */
-        if ((svp = hv_fetchs(hv, "max_mod_revision", 0)) && SvOK(*svp)) {
-            req.max_mod_revision = SvIV(*svp);
-        }
-
-        /* min_create_revision */
-        if ((svp = hv_fetchs(hv, "min_create_revision", 0)) && SvOK(*svp)) {
-            req.min_create_revision = SvIV(*svp);
-        }
+        build_range_request(aTHX_ (HV *)SvRV(opts), key_str, key_len,
+                            &req, &range_end_copy, &format);
+    }
 
-        /* max_create_revision */
-        if ((svp = hv_fetchs(hv, "max_create_revision", 0)) && SvOK(*svp)) {
-            req.max_create_revision = SvIV(*svp);
+    int raw = opts_want_raw(aTHX_ opts);
+    /* A deadline of its own cannot be shared with a call started earlier */
+    int dedupe = timeout == 0 && client->dedupe;
+    if (timeout == 0 && opts && SvROK(opts) && SvTYPE(SvRV(opts)) == SVt_PVHV) {
+        SV **svp = hv_fetchs((HV *)SvRV(opts), "dedupe", 0);
+        if (svp && SvOK(*svp)) {
+            dedupe = SvTRUE(*svp) ? 1 : 0;
         }
     }
 
@@ -1807,79 +2610,47 @@ CODE:
     if (range_end_copy) {
         Safefree(range_end_copy);
     }
-    grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
-    grpc_slice_unref(req_slice);
-
-    /* Create call */
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
-
-    pc->call = grpc_channel_create_call(
-        client->channel,
-        NULL,  /* parent call */
-        GRPC_PROPAGATE_DEFAULTS,
-        client->cq,
-        METHOD_KV_RANGE,
-        NULL,  /* host */
-        deadline,
-        NULL   /* reserved */
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for range");
-    }
-
-    /* Set up operations */
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
-
-    /* Send initial metadata (with auth token if available) */
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
-
-    /* Send message */
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
 
-    /* Send close */
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
+    /* dedupe: join an identical get already in flight */
+    SV *dedupe_key = dedupe ? dedupe_key_for(aTHX_ req_slice, format, raw) : NULL;
+    pending_call_t *pc = dedupe_key ? dedupe_find(aTHX_ client, dedupe_key) : NULL;
+    int slot = 0;
 
-    /* Receive initial metadata */
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
-
-    /* Receive message */
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
-
-    /* Receive status */
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
+    if (pc) {
+        slot = shared_call_attach(aTHX_ pc, callback);
+        SvREFCNT_dec(dedupe_key);
+        grpc_slice_unref(req_slice);
+    } else {
+        INIT_PENDING_CALL(pc, CALL_TYPE_RANGE, callback, client);
+        pc->timeout = timeout;
+        pc->format = format;
+        pc->raw = raw;
 
-    /* Start batch */
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
+        grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
+        grpc_slice_unref(req_slice);
 
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
+        grpc_call_error err = start_unary_call(client, pc, METHOD_KV_RANGE, send_buffer);
+        if (err != GRPC_CALL_OK) {
+            CLEANUP_PENDING_CALL_ON_ERROR(pc);
+            SvREFCNT_dec(dedupe_key);
+            croak("Failed to start gRPC call for range: %d", err);
+        }
 
-    if (err != GRPC_CALL_OK) {
-        /* Cleanup on error */
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
+        if (dedupe_key) {
+            if (!client->inflight) {
+                client->inflight = newHV();
+            }
+            (void)hv_store_ent(client->inflight, dedupe_key, newSViv(PTR2IV(pc)), 0);
+            pc->dedupe_key = dedupe_key;
+        }
     }
 
-    /* Add to pending list */
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : attach_call_handle(aTHX_ pc, slot);
 }
+OUTPUT:
+    RETVAL
 
-void
+SV *
 ev_etcd_put(client, key, value, ...)
     EV::Etcd client
     SV *key
@@ -1902,6 +2673,7 @@ CODE:
     }
 
     VALIDATE_CALLBACK(callback);
+    double timeout = opts_timeout(aTHX_ opts, "put");
 
     STRLEN key_len, value_len;
     const char *key_str = SvPV(key, key_len);
@@ -1909,9 +2681,7 @@ CODE:
     VALIDATE_KEY_SIZE(key_len);
     VALIDATE_VALUE_SIZE(value_len);
 
-    /* Create pending call structure */
-    pending_call_t *pc;
-    INIT_PENDING_CALL(pc, CALL_TYPE_PUT, callback, client);
+    int raw = opts_want_raw(aTHX_ opts);
 
     /* Build PutRequest */
     Etcdserverpb__PutRequest req = ETCDSERVERPB__PUT_REQUEST__INIT;
@@ -1922,30 +2692,26 @@ CODE:
 
     /* Parse options if provided */
     if (opts && SvROK(opts) && SvTYPE(SvRV(opts)) == SVt_PVHV) {
-        HV *hv = (HV *)SvRV(opts);
-        SV **svp;
-
-        /* lease - lease ID to associate with key */
-        if ((svp = hv_fetchs(hv, "lease", 0)) && SvOK(*svp)) {
-            req.lease = SvIV(*svp);
-        }
-
-        /* prev_kv - return previous key-value pair */
-        if ((svp = hv_fetchs(hv, "prev_kv", 0)) && SvTRUE(*svp)) {
-            req.prev_kv = 1;
-        }
-
-        /* ignore_value - update lease without changing value */
-        if ((svp = hv_fetchs(hv, "ignore_value", 0)) && SvTRUE(*svp)) {
-            req.ignore_value = 1;
-        }
+        build_put_request(aTHX_ (HV *)SvRV(opts), &req);
+    }
 
-        /* ignore_lease - update value without changing lease */
-        if ((svp = hv_fetchs(hv, "ignore_lease", 0)) && SvTRUE(*svp)) {
-            req.ignore_lease = 1;
+    /* autobatch: goes out with the other writes of this tick. A put that
+     * can fail on its own (lease not found, key not found for ignore_*)
+     * would fail the whole Txn, so it is sent alone. */
+    if (client->batch_max_ops) {
+        if (!raw && timeout == 0 && !req.lease && !req.ignore_value && !req.ignore_lease) {
+            write_batch_put(aTHX_ client, &req, callback);
+            XSRETURN_UNDEF;
         }
+        write_batch_flush(aTHX_ client);  /* the queued batch is sent first */
     }
 
+    /* Create pending call structure */
+    pending_call_t *pc;
+    INIT_PENDING_CALL(pc, CALL_TYPE_PUT, callback, client);
+    pc->timeout = timeout;
+    pc->raw = raw;
+
     /* Serialize request */
     grpc_slice req_slice;
     SERIALIZE_PROTOBUF_TO_SLICE(req_slice,
@@ -1954,76 +2720,138 @@ CODE:
     grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
     grpc_slice_unref(req_slice);
 
-    /* Create call */
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
+    grpc_call_error err = start_unary_call(client, pc, METHOD_KV_PUT, send_buffer);
+    if (err != GRPC_CALL_OK) {
+        CLEANUP_PENDING_CALL_ON_ERROR(pc);
+        croak("Failed to start gRPC call for put: %d", err);
+    }
 
-    pc->call = grpc_channel_create_call(
-        client->channel,
-        NULL,  /* parent call */
-        GRPC_PROPAGATE_DEFAULTS,
-        client->cq,
-        METHOD_KV_PUT,
-        NULL,  /* host */
-        deadline,
-        NULL   /* reserved */
-    );
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
+}
+OUTPUT:
+    RETVAL
 
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for put");
+EV::Etcd::Prepared
+ev_etcd_prepare(client, op, key, ...)
+    EV::Etcd client
+    const char *op
+    SV *key
+CODE:
+{
+    /* Parse arguments: prepare(op, key, [opts]) */
+    SV *opts = NULL;
+
+    if (items == 4) {
+        opts = ST(3);
+    } else if (items != 3) {
+        croak("Usage: $client->prepare($op, $key, [\\%%opts])");
     }
 
-    /* Set up operations */
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
+    int is_get = strEQ(op, "get");
+    if (!is_get && !strEQ(op, "put")) {
+        croak("prepare: unsupported operation '%s' (expected get or put)", op);
+    }
 
-    /* Send initial metadata (with auth token if available) */
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
+    STRLEN key_len;
+    const char *key_str = SvPV(key, key_len);
+    VALIDATE_KEY_SIZE(key_len);
 
-    /* Send message */
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
+    HV *hv = (opts && SvROK(opts) && SvTYPE(SvRV(opts)) == SVt_PVHV) ? (HV *)SvRV(opts) : NULL;
+    grpc_slice head, tail = grpc_empty_slice();
+    result_format_t format = RESULT_FORMAT_FULL;
 
-    /* Send close */
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
+    if (is_get) {
+        Etcdserverpb__RangeRequest req = ETCDSERVERPB__RANGE_REQUEST__INIT;
+        req.key.data = (uint8_t *)key_str;
+        req.key.len = key_len;
 
-    /* Receive initial metadata */
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
+        char *range_end_copy = NULL;
+        if (hv) {
+            build_range_request(aTHX_ hv, key_str, key_len, &req, &range_end_copy, &format);
+        }
+
+        SERIALIZE_PROTOBUF_TO_SLICE(head,
+            etcdserverpb__range_request__get_packed_size,
+            etcdserverpb__range_request__pack, &req);
+        if (range_end_copy) {
+            Safefree(range_end_copy);
+        }
+    } else {
+        /* Key field alone, then every option field with key and value left empty */
+        Etcdserverpb__PutRequest key_req = ETCDSERVERPB__PUT_REQUEST__INIT;
+        key_req.key.data = (uint8_t *)key_str;
+        key_req.key.len = key_len;
+        SERIALIZE_PROTOBUF_TO_SLICE(head,
+            etcdserverpb__put_request__get_packed_size,
+            etcdserverpb__put_request__pack, &key_req);
+
+        Etcdserverpb__PutRequest opt_req = ETCDSERVERPB__PUT_REQUEST__INIT;
+        if (hv) {
+            build_put_request(aTHX_ hv, &opt_req);
+        }
+        SERIALIZE_PROTOBUF_TO_SLICE(tail,
+            etcdserverpb__put_request__get_packed_size,
+            etcdserverpb__put_request__pack, &opt_req);
+    }
+
+    prepared_request_t *prep;
+    Newxz(prep, 1, prepared_request_t);
+    prep->client = client;
+    prep->client_sv = SvREFCNT_inc_simple_NN(SvRV(ST(0)));
+    prep->type = is_get ? CALL_TYPE_RANGE : CALL_TYPE_PUT;
+    prep->head = head;
+    prep->tail = tail;
+    prep->format = format;
+    prep->raw = opts_want_raw(aTHX_ opts);
+
+    RETVAL = prep;
+}
+OUTPUT:
+    RETVAL
+
+SV *
+ev_etcd_raw_call(client, method, request, callback)
+    EV::Etcd client
+    SV *method
+    SV *request
+    SV *callback
+CODE:
+{
+    VALIDATE_CALLBACK(callback);
+    write_batch_flush(aTHX_ client);  /* autobatch: send the queued batch first */
 
-    /* Receive message */
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
+    STRLEN method_len, request_len;
+    const char *method_str = SvPV(method, method_len);
+    const char *request_str = SvPV(request, request_len);
 
-    /* Receive status */
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
+    const grpc_slice *method_slice = lookup_unary_method(method_str, method_len);
+    if (!method_slice) {
+        croak("raw_call: unknown or streaming method '%s'", method_str);
+    }
+    if (request_len > ETCD_MAX_KEY_SIZE + ETCD_MAX_VALUE_SIZE) {
+        croak("request too large: %zu bytes", (size_t)request_len);
+    }
 
-    /* Start batch */
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
+    pending_call_t *pc;
+    INIT_PENDING_CALL(pc, CALL_TYPE_RAW, callback, client);
+    pc->raw = 1;
 
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
+    grpc_slice req_slice = grpc_slice_from_copied_buffer(request_str, request_len);
+    grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
+    grpc_slice_unref(req_slice);
 
+    grpc_call_error err = start_unary_call(client, pc, *method_slice, send_buffer);
     if (err != GRPC_CALL_OK) {
-        /* Cleanup on error */
         CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
+        croak("Failed to start gRPC call for %s: %d", method_str, err);
     }
 
-    /* Add to pending list */
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
 }
+OUTPUT:
+    RETVAL
 
-void
+SV *
 ev_etcd_delete(client, key, ...)
     EV::Etcd client
     SV *key
@@ -2045,14 +2873,13 @@ CODE:
     }
 
     VALIDATE_CALLBACK(callback);
+    double timeout = opts_timeout(aTHX_ opts, "delete");
 
     STRLEN key_len;
     const char *key_str = SvPV(key, key_len);
     VALIDATE_KEY_SIZE(key_len);
 
-    /* Create pending call structure */
-    pending_call_t *pc;
-    INIT_PENDING_CALL(pc, CALL_TYPE_DELETE, callback, client);
+    int raw = opts_want_raw(aTHX_ opts);
 
     /* Build DeleteRangeRequest */
     Etcdserverpb__DeleteRangeRequest req = ETCDSERVERPB__DELETE_RANGE_REQUEST__INIT;
@@ -2097,6 +2924,21 @@ CODE:
         }
     }
 
+    /* autobatch: single-key deletes go out with the other writes */
+    if (client->batch_max_ops) {
+        if (!raw && timeout == 0 && req.range_end.len == 0) {
+            write_batch_delete(aTHX_ client, &req, callback);
+            XSRETURN_UNDEF;
+        }
+        write_batch_flush(aTHX_ client);  /* the queued batch is sent first */
+    }
+
+    /* Create pending call structure */
+    pending_call_t *pc;
+    INIT_PENDING_CALL(pc, CALL_TYPE_DELETE, callback, client);
+    pc->timeout = timeout;
+    pc->raw = raw;
+
     /* Serialize request */
     grpc_slice req_slice;
     SERIALIZE_PROTOBUF_TO_SLICE(req_slice,
@@ -2108,74 +2950,16 @@ CODE:
     grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
     grpc_slice_unref(req_slice);
 
-    /* Create call */
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
-
-    pc->call = grpc_channel_create_call(
-        client->channel,
-        NULL,  /* parent call */
-        GRPC_PROPAGATE_DEFAULTS,
-        client->cq,
-        METHOD_KV_DELETE,
-        NULL,  /* host */
-        deadline,
-        NULL   /* reserved */
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for delete");
-    }
-
-    /* Set up operations */
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
-
-    /* Send initial metadata (with auth token if available) */
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
-
-    /* Send message */
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
-
-    /* Send close */
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
-
-    /* Receive initial metadata */
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
-
-    /* Receive message */
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
-
-    /* Receive status */
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
-
-    /* Start batch */
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
-
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
-
+    grpc_call_error err = start_unary_call(client, pc, METHOD_KV_DELETE, send_buffer);
     if (err != GRPC_CALL_OK) {
-        /* Cleanup on error */
         CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
+        croak("Failed to start gRPC call for delete: %d", err);
     }
 
-    /* Add to pending list */
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
 }
+OUTPUT:
+    RETVAL
 
 EV::Etcd::Watch
 ev_etcd_watch(client, key, ...)
@@ -2204,6 +2988,15 @@ CODE:
     const char *key_str = SvPV(key, key_len);
     VALIDATE_KEY_SIZE(key_len);
 
+    /* format - validated before anything is allocated */
+    result_format_t format = RESULT_FORMAT_FULL;
+    if (opts && SvROK(opts) && SvTYPE(SvRV(opts)) == SVt_PVHV) {
+        SV **fsvp = hv_fetchs((HV *)SvRV(opts), "format", 0);
+        if (fsvp && SvOK(*fsvp)) {
+            format = parse_result_format(aTHX_ *fsvp);
+        }
+    }
+
     /* Create watch structure */
     watch_call_t *wc;
     Newxz(wc, 1, watch_call_t);
@@ -2232,6 +3025,7 @@ CODE:
     wc->params.start_revision = 0;
     wc->params.prev_kv = 0;
     wc->params.progress_notify = 0;
+    wc->params.format = format;
 
     /* Build WatchCreateRequest wrapped in WatchRequest */
     Etcdserverpb__WatchCreateRequest create_req = ETCDSERVERPB__WATCH_CREATE_REQUEST__INIT;
@@ -2246,10 +3040,9 @@ CODE:
         HV *hv = (HV *)SvRV(opts);
         SV **svp;
 
-        /* auto_reconnect - enable/disable automatic reconnection (default: true) */
-        if ((svp = hv_fetchs(hv, "auto_reconnect", 0))) {
-            wc->auto_reconnect = SvTRUE(*svp) ? 1 : 0;
-        }
+        parse_watch_stream_opts(aTHX_ hv, wc);
+        create_req.progress_notify = wc->params.progress_notify;
+        create_req.prev_kv = wc->params.prev_kv;
 
         /* range_end - explicit end of key range to watch */
         if ((svp = hv_fetchs(hv, "range_end", 0)) && SvOK(*svp)) {
@@ -2291,18 +3084,6 @@ CODE:
             wc->params.start_revision = create_req.start_revision;
         }
 
-        /* progress_notify - receive periodic progress notifications */
-        if ((svp = hv_fetchs(hv, "progress_notify", 0)) && SvTRUE(*svp)) {
-            create_req.progress_notify = 1;
-            wc->params.progress_notify = 1;
-        }
-
-        /* prev_kv - include previous key-value in events */
-        if ((svp = hv_fetchs(hv, "prev_kv", 0)) && SvTRUE(*svp)) {
-            create_req.prev_kv = 1;
-            wc->params.prev_kv = 1;
-        }
-
         /* watch_id - optional explicit watch ID */
         if ((svp = hv_fetchs(hv, "watch_id", 0)) && SvOK(*svp)) {
             create_req.watch_id = SvIV(*svp);
@@ -2401,18 +3182,236 @@ CODE:
 OUTPUT:
     RETVAL
 
-void
-ev_etcd_lease_grant(client, ttl, callback)
+EV::Etcd::Watch
+ev_etcd_sync(client, prefix, ...)
+    EV::Etcd client
+    SV *prefix
+CODE:
+{
+    /* Parse arguments: sync(prefix, [opts,] on_chunk, on_event) */
+    SV *opts = NULL;
+    SV *on_chunk;
+    SV *on_event;
+
+    if (items == 4) {
+        on_chunk = ST(2);
+        on_event = ST(3);
+    } else if (items == 5) {
+        opts = ST(2);
+        on_chunk = ST(3);
+        on_event = ST(4);
+    } else {
+        croak("Usage: $client->sync($prefix, [\\%%opts,] $on_chunk, $on_event)");
+    }
+
+    VALIDATE_CALLBACK(on_chunk);
+    VALIDATE_CALLBACK(on_event);
+
+    STRLEN prefix_len;
+    const char *prefix_str = SvPV(prefix, prefix_len);
+    VALIDATE_KEY_SIZE(prefix_len);
+
+    HV *hv = NULL;
+    if (opts) {
+        if (!SvROK(opts) || SvTYPE(SvRV(opts)) != SVt_PVHV) {
+            croak("sync options must be a hash reference");
+        }
+        hv = (HV *)SvRV(opts);
+    }
+
+    /* format and page_size - validated before anything is allocated */
+    result_format_t format = RESULT_FORMAT_FULL;
+    SV **svp;
+    if (hv && (svp = hv_fetchs(hv, "format", 0)) && SvOK(*svp)) {
+        format = parse_result_format(aTHX_ *svp);
+    }
+    size_t page_size = parse_page_size(aTHX_ hv);
+
+    watch_call_t *wc = new_sync_watch(aTHX_ client, prefix_str, prefix_len, on_chunk, on_event);
+    wc->page_size = page_size;
+    wc->params.format = format;
+
+    if (hv) {
+        parse_watch_stream_opts(aTHX_ hv, wc);
+    }
+
+    /* Listed first so cancel and DESTROY see it while the snapshot pages */
+    wc->next = client->watches;
+    client->watches = wc;
+
+    if (!watch_sync_start(aTHX_ wc)) {
+        wc->active = 0;
+        cleanup_watch(aTHX_ wc);
+        croak("Failed to start gRPC call for sync");
+    }
+
+    RETVAL = wc;
+}
+OUTPUT:
+    RETVAL
+
+EV::Etcd::Cache
+ev_etcd_cache(client, prefix, ...)
+    EV::Etcd client
+    SV *prefix
+CODE:
+{
+    /* Parse arguments: cache(prefix, [opts,] callback) */
+    SV *opts = NULL;
+    SV *callback;
+
+    if (items == 3) {
+        callback = ST(2);
+    } else if (items == 4) {
+        opts = ST(2);
+        callback = ST(3);
+    } else {
+        croak("Usage: $client->cache($prefix, [\\%%opts,] $callback)");
+    }
+
+    VALIDATE_CALLBACK(callback);
+
+    STRLEN prefix_len;
+    const char *prefix_str = SvPV(prefix, prefix_len);
+    VALIDATE_KEY_SIZE(prefix_len);
+
+    HV *hv = NULL;
+    if (opts) {
+        if (!SvROK(opts) || SvTYPE(SvRV(opts)) != SVt_PVHV) {
+            croak("cache options must be a hash reference");
+        }
+        hv = (HV *)SvRV(opts);
+    }
+    size_t page_size = parse_page_size(aTHX_ hv);
+
+    /* history - keep an ordered index with this many versions per key */
+    size_t history = 0;
+    SV **hsvp;
+    if (hv && (hsvp = hv_fetchs(hv, "history", 0)) && SvOK(*hsvp)) {
+        IV n = SvIV(*hsvp);
+        if (n < 1) {
+            croak("history must be a positive integer");
+        }
+        history = (size_t)n;
+    }
+
+    /* persist - warm-start file path */
+    const char *persist = NULL;
+    STRLEN persist_len = 0;
+    if (hv && (hsvp = hv_fetchs(hv, "persist", 0)) && SvOK(*hsvp)) {
+        persist = SvPV(*hsvp, persist_len);
+        if (!persist_len) {
+            croak("persist must be a file path");
+        }
+    }
+
+    /* shared / shared_size - mirror for other processes */
+    etcd_shm_t *shm = NULL;
+    if (hv && (hsvp = hv_fetchs(hv, "shared", 0)) && SvOK(*hsvp)) {
+        const char *shared = SvPV_nolen(*hsvp);
+        size_t shared_size = SHM_DEFAULT_SIZE;
+        SV **ssvp = hv_fetchs(hv, "shared_size", 0);
+        if (ssvp && SvOK(*ssvp)) {
+            if (SvIV(*ssvp) < 4096) {
+                croak("shared_size must be at least 4096");
+            }
+            shared_size = (size_t)SvIV(*ssvp);
+        }
+        shm = shm_create(shared, shared_size);
+        if (!shm) {
+            croak("Cannot create shared mirror %s: %s", shared, Strerror(errno));
+        }
+    }
+
+    watch_call_t *wc = new_sync_watch(aTHX_ client, prefix_str, prefix_len, callback, callback);
+    wc->page_size = page_size;
+    /* Progress notifications keep the staleness age honest on a quiet prefix */
+    wc->params.progress_notify = 1;
+    if (hv) {
+        SV **svp;
+        if ((svp = hv_fetchs(hv, "auto_reconnect", 0))) {
+            wc->auto_reconnect = SvTRUE(*svp) ? 1 : 0;
+        }
+        if ((svp = hv_fetchs(hv, "progress_notify", 0))) {
+            wc->params.progress_notify = SvTRUE(*svp) ? 1 : 0;
+        }
+    }
+
+    etcd_cache_t *cache;
+    Newxz(cache, 1, etcd_cache_t);
+    cache->client = client;
+    cache->client_sv = SvREFCNT_inc_simple_NN(SvRV(ST(0)));
+    Newx(cache->prefix, prefix_len + 1, char);
+    Copy(prefix_str, cache->prefix, prefix_len, char);
+    cache->prefix[prefix_len] = '\0';
+    cache->prefix_len = prefix_len;
+    cache->history = history;
+    cache->shm = shm;
+    cache->wc = wc;
+    wc->cache = cache;
+    if (persist) {
+        Newx(cache->persist_path, persist_len + 1, char);
+        Copy(persist, cache->persist_path, persist_len, char);
+        cache->persist_path[persist_len] = '\0';
+    }
+
+    wc->next = client->watches;
+    client->watches = wc;
+
+    /* A saved snapshot is served at once; only the changes since are fetched */
+    int started = persist && cache_restore(aTHX_ cache)
+        ? watch_resume_at(aTHX_ wc, cache->revision)
+        : watch_sync_start(aTHX_ wc);
+    if (!started) {
+        wc->active = 0;
+        cleanup_watch(aTHX_ wc);
+        if (cache->data) {
+            SvREFCNT_dec((SV *)cache->data);
+        }
+        cache_index_clear(aTHX_ &cache->index);
+        if (cache->persist_path) {
+            Safefree(cache->persist_path);
+        }
+        if (cache->shm) {
+            shm_close(cache->shm);
+        }
+        SvREFCNT_dec(cache->client_sv);
+        Safefree(cache->prefix);
+        Safefree(cache);
+        croak("Failed to start gRPC call for cache");
+    }
+
+    RETVAL = cache;
+}
+OUTPUT:
+    RETVAL
+
+SV *
+ev_etcd_lease_grant(client, ttl, ...)
     EV::Etcd client
     IV ttl
-    SV *callback
 CODE:
 {
+    /* Parse arguments: lease_grant(ttl, [opts,] callback) */
+    SV *opts = NULL;
+    SV *callback;
+
+    if (items == 3) {
+        callback = ST(2);
+    } else if (items == 4) {
+        opts = ST(2);
+        callback = ST(3);
+    } else {
+        croak("Usage: $client->lease_grant($ttl, [\\%%opts,] $callback)");
+    }
+
     VALIDATE_CALLBACK(callback);
+    double timeout = opts_timeout(aTHX_ opts, "lease_grant");
 
     /* Create pending call structure */
     pending_call_t *pc;
     INIT_PENDING_CALL(pc, CALL_TYPE_LEASE_GRANT, callback, client);
+    pc->timeout = timeout;
 
     /* Build LeaseGrantRequest */
     Etcdserverpb__LeaseGrantRequest req = ETCDSERVERPB__LEASE_GRANT_REQUEST__INIT;
@@ -2426,67 +3425,19 @@ CODE:
     grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
     grpc_slice_unref(req_slice);
 
-    /* Create call */
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
-
-    pc->call = grpc_channel_create_call(
-        client->channel,
-        NULL,
-        GRPC_PROPAGATE_DEFAULTS,
-        client->cq,
-        METHOD_LEASE_GRANT,
-        NULL,
-        deadline,
-        NULL
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for lease_grant");
-    }
-
-    /* Set up operations */
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
-
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
-
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
-
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
-
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
-
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
-
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
-
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
-
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
-
+    pc->sent_at = lease_clock();
+    grpc_call_error err = start_unary_call(client, pc, METHOD_LEASE_GRANT, send_buffer);
     if (err != GRPC_CALL_OK) {
         CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
+        croak("Failed to start gRPC call for lease_grant: %d", err);
     }
 
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
 }
+OUTPUT:
+    RETVAL
 
-void
+SV *
 ev_etcd_lease_revoke(client, lease_id, callback)
     EV::Etcd client
     IV lease_id
@@ -2494,6 +3445,13 @@ ev_etcd_lease_revoke(client, lease_id, callback)
 CODE:
 {
     VALIDATE_CALLBACK(callback);
+    write_batch_flush(aTHX_ client);  /* autobatch: send the queued batch first */
+
+    /* A revoked lease is not lost: stop renewing it quietly */
+    if (client->lease_mgr) {
+        (void)lease_mgr_remove(aTHX_ client->lease_mgr, lease_id);
+        lease_forget(aTHX_ client, lease_id);
+    }
 
     /* Create pending call structure */
     pending_call_t *pc;
@@ -2511,67 +3469,117 @@ CODE:
     grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
     grpc_slice_unref(req_slice);
 
-    /* Create call */
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
-
-    pc->call = grpc_channel_create_call(
-        client->channel,
-        NULL,
-        GRPC_PROPAGATE_DEFAULTS,
-        client->cq,
-        METHOD_LEASE_REVOKE,
-        NULL,
-        deadline,
-        NULL
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
+    grpc_call_error err = start_unary_call(client, pc, METHOD_LEASE_REVOKE, send_buffer);
+    if (err != GRPC_CALL_OK) {
         CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for lease_revoke");
+        croak("Failed to start gRPC call for lease_revoke: %d", err);
     }
 
-    /* Set up operations */
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
-
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
+}
+OUTPUT:
+    RETVAL
 
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
+void
+ev_etcd_lease_keep(client, lease_id, ...)
+    EV::Etcd client
+    IV lease_id
+CODE:
+{
+    HV *opts = NULL;
+    SV *callback = NULL;
+    IV ttl = 0;
+    int i;
 
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
+    for (i = 2; i < items; i++) {
+        SV *arg = ST(i);
+        if (SvROK(arg) && SvTYPE(SvRV(arg)) == SVt_PVHV && !opts && !callback) {
+            opts = (HV *)SvRV(arg);
+        } else if (SvROK(arg) && SvTYPE(SvRV(arg)) == SVt_PVCV && !callback) {
+            callback = arg;
+        } else {
+            croak("Usage: $client->lease_keep($lease_id, [\\%%opts,] [$on_expire])");
+        }
+    }
+    if (lease_id <= 0) {
+        croak("lease_keep: lease_id must be positive");
+    }
 
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
+    if (opts) {
+        SV **svp = hv_fetchs(opts, "ttl", 0);
+        if (svp && SvOK(*svp)) {
+            ttl = SvIV(*svp);
+            if (ttl <= 0) {
+                croak("lease_keep: ttl must be positive");
+            }
+        }
+    }
 
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
+    lease_mgr_add(aTHX_ lease_mgr_get(aTHX_ client), lease_id, ttl, callback);
+}
 
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
+int
+ev_etcd_lease_release(client, lease_id)
+    EV::Etcd client
+    IV lease_id
+CODE:
+    RETVAL = client->lease_mgr ? lease_mgr_remove(aTHX_ client->lease_mgr, lease_id) : 0;
+OUTPUT:
+    RETVAL
 
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
+SV *
+ev_etcd_lease_remaining(client, lease_id, margin = NULL)
+    EV::Etcd client
+    IV lease_id
+    SV *margin
+CODE:
+{
+    double left = lease_estimate(aTHX_ client, lease_id);
+    if (left >= 0) {
+        left -= margin && SvOK(margin) ? SvNV(margin) : client->lease_margin;
+        RETVAL = newSVnv(left > 0 ? left : 0);
+    } else {
+        RETVAL = &PL_sv_undef;
+    }
+}
+OUTPUT:
+    RETVAL
 
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
+EV::Etcd::LeasePool
+ev_etcd_lease_pool(client, ...)
+    EV::Etcd client
+CODE:
+{
+    IV ttl = 0;
+    IV size = 8;
+    int i;
 
-    if (err != GRPC_CALL_OK) {
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
+    if ((items - 1) % 2 != 0) {
+        croak("Usage: $client->lease_pool(ttl => $seconds, size => $n)");
+    }
+    for (i = 1; i < items; i += 2) {
+        const char *key = SvPV_nolen(ST(i));
+        if (strEQ(key, "ttl")) {
+            ttl = SvIV(ST(i + 1));
+        } else if (strEQ(key, "size")) {
+            size = SvIV(ST(i + 1));
+        } else {
+            croak("lease_pool: unknown option '%s'", key);
+        }
+    }
+    if (ttl <= 0) {
+        croak("lease_pool: ttl must be positive");
+    }
+    if (size < 1 || size > 100000) {
+        croak("lease_pool: size must be between 1 and 100000");
     }
 
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
+    RETVAL = lease_pool_new(aTHX_ client, SvRV(ST(0)), ttl, (size_t)size);
 }
+OUTPUT:
+    RETVAL
 
-void
+SV *
 ev_etcd_lease_time_to_live(client, lease_id, ...)
     EV::Etcd client
     IV lease_id
@@ -2593,10 +3601,12 @@ CODE:
     }
 
     VALIDATE_CALLBACK(callback);
+    double timeout = opts_timeout(aTHX_ opts, "lease_time_to_live");
 
     /* Create pending call structure */
     pending_call_t *pc;
     INIT_PENDING_CALL(pc, CALL_TYPE_LEASE_TIME_TO_LIVE, callback, client);
+    pc->timeout = timeout;
 
     /* Build LeaseTimeToLiveRequest */
     Etcdserverpb__LeaseTimeToLiveRequest req = ETCDSERVERPB__LEASE_TIME_TO_LIVE_REQUEST__INIT;
@@ -2621,67 +3631,19 @@ CODE:
     grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
     grpc_slice_unref(req_slice);
 
-    /* Create call */
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
-
-    pc->call = grpc_channel_create_call(
-        client->channel,
-        NULL,
-        GRPC_PROPAGATE_DEFAULTS,
-        client->cq,
-        METHOD_LEASE_TTL,
-        NULL,
-        deadline,
-        NULL
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
+    pc->sent_at = lease_clock();
+    grpc_call_error err = start_unary_call(client, pc, METHOD_LEASE_TTL, send_buffer);
+    if (err != GRPC_CALL_OK) {
         CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for lease_ttl");
+        croak("Failed to start gRPC call for lease_ttl: %d", err);
     }
 
-    /* Set up operations */
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
-
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
-
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
-
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
-
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
-
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
-
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
-
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
-
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
-
-    if (err != GRPC_CALL_OK) {
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
-    }
-
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
 }
+OUTPUT:
+    RETVAL
 
-void
+SV *
 ev_etcd_lease_leases(client, callback)
     EV::Etcd client
     SV *callback
@@ -2704,67 +3666,18 @@ CODE:
     grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
     grpc_slice_unref(req_slice);
 
-    /* Create call */
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
-
-    pc->call = grpc_channel_create_call(
-        client->channel,
-        NULL,
-        GRPC_PROPAGATE_DEFAULTS,
-        client->cq,
-        METHOD_LEASE_LEASES,
-        NULL,
-        deadline,
-        NULL
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for lease_leases");
-    }
-
-    /* Set up operations */
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
-
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
-
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
-
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
-
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
-
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
-
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
-
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
-
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
-
+    grpc_call_error err = start_unary_call(client, pc, METHOD_LEASE_LEASES, send_buffer);
     if (err != GRPC_CALL_OK) {
         CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
+        croak("Failed to start gRPC call for lease_leases: %d", err);
     }
 
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
 }
+OUTPUT:
+    RETVAL
 
-void
+SV *
 ev_etcd_compact(client, revision, ...)
     EV::Etcd client
     IV revision
@@ -2786,10 +3699,12 @@ CODE:
     }
 
     VALIDATE_CALLBACK(callback);
+    double timeout = opts_timeout(aTHX_ opts, "compact");
 
     /* Create pending call structure */
     pending_call_t *pc;
     INIT_PENDING_CALL(pc, CALL_TYPE_COMPACT, callback, client);
+    pc->timeout = timeout;
 
     /* Build CompactionRequest */
     Etcdserverpb__CompactionRequest req = ETCDSERVERPB__COMPACTION_REQUEST__INIT;
@@ -2814,67 +3729,18 @@ CODE:
     grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
     grpc_slice_unref(req_slice);
 
-    /* Create call */
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
-
-    pc->call = grpc_channel_create_call(
-        client->channel,
-        NULL,
-        GRPC_PROPAGATE_DEFAULTS,
-        client->cq,
-        METHOD_KV_COMPACT,
-        NULL,
-        deadline,
-        NULL
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for compact");
-    }
-
-    /* Set up operations */
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
-
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
-
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
-
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
-
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
-
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
-
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
-
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
-
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
-
+    grpc_call_error err = start_unary_call(client, pc, METHOD_KV_COMPACT, send_buffer);
     if (err != GRPC_CALL_OK) {
         CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
+        croak("Failed to start gRPC call for compact: %d", err);
     }
 
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
 }
+OUTPUT:
+    RETVAL
 
-void
+SV *
 ev_etcd_status(client, callback)
     EV::Etcd client
     SV *callback
@@ -2897,65 +3763,16 @@ CODE:
     grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
     grpc_slice_unref(req_slice);
 
-    /* Create call */
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
-
-    pc->call = grpc_channel_create_call(
-        client->channel,
-        NULL,
-        GRPC_PROPAGATE_DEFAULTS,
-        client->cq,
-        METHOD_MAINTENANCE_STATUS,
-        NULL,
-        deadline,
-        NULL
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for status");
-    }
-
-    /* Set up operations */
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
-
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
-
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
-
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
-
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
-
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
-
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
-
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
-
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
-
+    grpc_call_error err = start_unary_call(client, pc, METHOD_MAINTENANCE_STATUS, send_buffer);
     if (err != GRPC_CALL_OK) {
         CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
+        croak("Failed to start gRPC call for status: %d", err);
     }
 
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
 }
+OUTPUT:
+    RETVAL
 
 void
 ev_etcd_lease_keepalive(client, lease_id, callback)
@@ -3033,6 +3850,7 @@ CODE:
     ops[3].op = GRPC_OP_RECV_MESSAGE;
     ops[3].data.recv_message.recv_message = &kc->recv_buffer;
 
+    kc->sent_at = lease_clock();
     grpc_call_error err = grpc_call_start_batch(kc->call, ops, 4, &kc->base, NULL);
 
     cleanup_auth_metadata(client, &auth_md);
@@ -3052,20 +3870,37 @@ CODE:
     client->keepalives = kc;
 }
 
-void
-ev_etcd_txn(client, compare_av, success_av, failure_av, callback)
+SV *
+ev_etcd_txn(client, compare_av, success_av, failure_av, ...)
     EV::Etcd client
     SV *compare_av
     SV *success_av
     SV *failure_av
-    SV *callback
 CODE:
 {
+    /* Parse arguments: txn(compare, success, failure, [opts,] callback) */
+    SV *opts = NULL;
+    SV *callback;
+
+    if (items == 5) {
+        callback = ST(4);
+    } else if (items == 6) {
+        opts = ST(4);
+        callback = ST(5);
+    } else {
+        croak("Usage: $client->txn(\\@compare, \\@success, \\@failure, [\\%%opts,] $callback)");
+    }
+
     VALIDATE_CALLBACK(callback);
+    double timeout = opts_timeout(aTHX_ opts, "txn");
+    check_request_op_formats(aTHX_ success_av);
+    check_request_op_formats(aTHX_ failure_av);
+    write_batch_flush(aTHX_ client);  /* autobatch: send the queued batch first */
 
     /* Create pending call structure */
     pending_call_t *pc;
     INIT_PENDING_CALL(pc, CALL_TYPE_TXN, callback, client);
+    pc->timeout = timeout;
 
     /* Build TxnRequest */
     Etcdserverpb__TxnRequest req = ETCDSERVERPB__TXN_REQUEST__INIT;
@@ -3182,17 +4017,30 @@ CODE:
     /* Parse success operations */
     size_t n_success;
     Etcdserverpb__RequestOp **success_ops;
-    parse_request_ops(aTHX_ success_av, &success_ops, &n_success);
+    unsigned char *success_formats;
+    parse_request_ops(aTHX_ success_av, &success_ops, &n_success, &success_formats);
     req.n_success = n_success;
     req.success = success_ops;
 
     /* Parse failure operations */
     size_t n_failure;
     Etcdserverpb__RequestOp **failure_ops;
-    parse_request_ops(aTHX_ failure_av, &failure_ops, &n_failure);
+    unsigned char *failure_formats;
+    parse_request_ops(aTHX_ failure_av, &failure_ops, &n_failure, &failure_formats);
     req.n_failure = n_failure;
     req.failure = failure_ops;
 
+    /* Keep per-op result formats only if some range op asked for one */
+    if (success_formats || failure_formats) {
+        Newxz(pc->txn_formats, n_success + n_failure, unsigned char);
+        if (success_formats) Copy(success_formats, pc->txn_formats, n_success, unsigned char);
+        if (failure_formats) Copy(failure_formats, pc->txn_formats + n_success, n_failure, unsigned char);
+        pc->txn_n_success = n_success;
+        pc->txn_n_failure = n_failure;
+    }
+    if (success_formats) Safefree(success_formats);
+    if (failure_formats) Safefree(failure_formats);
+
     /* Serialize request directly to grpc_slice */
     grpc_slice req_slice;
     SERIALIZE_PROTOBUF_TO_SLICE(req_slice,
@@ -3211,67 +4059,18 @@ CODE:
     grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
     grpc_slice_unref(req_slice);
 
-    /* Create call */
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
-
-    pc->call = grpc_channel_create_call(
-        client->channel,
-        NULL,
-        GRPC_PROPAGATE_DEFAULTS,
-        client->cq,
-        METHOD_KV_TXN,
-        NULL,
-        deadline,
-        NULL
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for txn");
-    }
-
-    /* Set up operations */
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
-
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
-
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
-
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
-
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
-
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
-
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
-
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
-
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
-
+    grpc_call_error err = start_unary_call(client, pc, METHOD_KV_TXN, send_buffer);
     if (err != GRPC_CALL_OK) {
         CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
+        croak("Failed to start gRPC call for txn: %d", err);
     }
 
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
 }
+OUTPUT:
+    RETVAL
 
-void
+SV *
 ev_etcd_authenticate(client, username, password, callback)
     EV::Etcd client
     SV *username
@@ -3315,67 +4114,18 @@ CODE:
     memset(pass_str, 0, pass_len);
     Safefree(pass_str);
 
-    /* Create call */
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
-
-    pc->call = grpc_channel_create_call(
-        client->channel,
-        NULL,
-        GRPC_PROPAGATE_DEFAULTS,
-        client->cq,
-        METHOD_AUTH_AUTHENTICATE,
-        NULL,
-        deadline,
-        NULL
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for authenticate");
-    }
-
-    /* Set up operations */
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
-
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
-
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
-
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
-
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
-
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
-
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
-
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
-
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
-
+    grpc_call_error err = start_unary_call(client, pc, METHOD_AUTH_AUTHENTICATE, send_buffer);
     if (err != GRPC_CALL_OK) {
         CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
+        croak("Failed to start gRPC call for authenticate: %d", err);
     }
 
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
 }
+OUTPUT:
+    RETVAL
 
-void
+SV *
 ev_etcd_user_add(client, username, password, callback)
     EV::Etcd client
     SV *username
@@ -3419,67 +4169,18 @@ CODE:
     memset(pass_str, 0, pass_len);
     Safefree(pass_str);
 
-    /* Create call */
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
-
-    pc->call = grpc_channel_create_call(
-        client->channel,
-        NULL,
-        GRPC_PROPAGATE_DEFAULTS,
-        client->cq,
-        METHOD_AUTH_USER_ADD,
-        NULL,
-        deadline,
-        NULL
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for user_add");
-    }
-
-    /* Set up operations */
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
-
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
-
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
-
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
-
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
-
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
-
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
-
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
-
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
-
+    grpc_call_error err = start_unary_call(client, pc, METHOD_AUTH_USER_ADD, send_buffer);
     if (err != GRPC_CALL_OK) {
         CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
+        croak("Failed to start gRPC call for user_add: %d", err);
     }
 
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
 }
+OUTPUT:
+    RETVAL
 
-void
+SV *
 ev_etcd_user_delete(client, username, callback)
     EV::Etcd client
     SV *username
@@ -3508,67 +4209,18 @@ CODE:
     grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
     grpc_slice_unref(req_slice);
 
-    /* Create call */
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
-
-    pc->call = grpc_channel_create_call(
-        client->channel,
-        NULL,
-        GRPC_PROPAGATE_DEFAULTS,
-        client->cq,
-        METHOD_AUTH_USER_DELETE,
-        NULL,
-        deadline,
-        NULL
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
+    grpc_call_error err = start_unary_call(client, pc, METHOD_AUTH_USER_DELETE, send_buffer);
+    if (err != GRPC_CALL_OK) {
         CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for user_delete");
+        croak("Failed to start gRPC call for user_delete: %d", err);
     }
 
-    /* Set up operations */
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
-
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
-
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
-
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
-
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
-
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
-
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
-
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
+}
+OUTPUT:
+    RETVAL
 
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
-
-    if (err != GRPC_CALL_OK) {
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
-    }
-
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
-}
-
-void
+SV *
 ev_etcd_user_change_password(client, username, password, callback)
     EV::Etcd client
     SV *username
@@ -3612,67 +4264,18 @@ CODE:
     memset(pass_str, 0, pass_len);
     Safefree(pass_str);
 
-    /* Create call */
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
-
-    pc->call = grpc_channel_create_call(
-        client->channel,
-        NULL,
-        GRPC_PROPAGATE_DEFAULTS,
-        client->cq,
-        METHOD_AUTH_USER_CHANGE_PASSWORD,
-        NULL,
-        deadline,
-        NULL
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for user_change_password");
-    }
-
-    /* Set up operations */
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
-
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
-
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
-
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
-
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
-
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
-
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
-
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
-
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
-
+    grpc_call_error err = start_unary_call(client, pc, METHOD_AUTH_USER_CHANGE_PASSWORD, send_buffer);
     if (err != GRPC_CALL_OK) {
         CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
+        croak("Failed to start gRPC call for user_change_password: %d", err);
     }
 
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
 }
+OUTPUT:
+    RETVAL
 
-void
+SV *
 ev_etcd_auth_enable(client, callback)
     EV::Etcd client
     SV *callback
@@ -3695,67 +4298,18 @@ CODE:
     grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
     grpc_slice_unref(req_slice);
 
-    /* Create call */
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
-
-    pc->call = grpc_channel_create_call(
-        client->channel,
-        NULL,
-        GRPC_PROPAGATE_DEFAULTS,
-        client->cq,
-        METHOD_AUTH_ENABLE,
-        NULL,
-        deadline,
-        NULL
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for auth_enable");
-    }
-
-    /* Set up operations */
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
-
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
-
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
-
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
-
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
-
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
-
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
-
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
-
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
-
+    grpc_call_error err = start_unary_call(client, pc, METHOD_AUTH_ENABLE, send_buffer);
     if (err != GRPC_CALL_OK) {
         CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
+        croak("Failed to start gRPC call for auth_enable: %d", err);
     }
 
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
 }
+OUTPUT:
+    RETVAL
 
-void
+SV *
 ev_etcd_auth_disable(client, callback)
     EV::Etcd client
     SV *callback
@@ -3778,67 +4332,18 @@ CODE:
     grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
     grpc_slice_unref(req_slice);
 
-    /* Create call */
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
-
-    pc->call = grpc_channel_create_call(
-        client->channel,
-        NULL,
-        GRPC_PROPAGATE_DEFAULTS,
-        client->cq,
-        METHOD_AUTH_DISABLE,
-        NULL,
-        deadline,
-        NULL
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for auth_disable");
-    }
-
-    /* Set up operations */
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
-
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
-
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
-
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
-
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
-
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
-
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
-
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
-
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
-
+    grpc_call_error err = start_unary_call(client, pc, METHOD_AUTH_DISABLE, send_buffer);
     if (err != GRPC_CALL_OK) {
         CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
+        croak("Failed to start gRPC call for auth_disable: %d", err);
     }
 
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
 }
+OUTPUT:
+    RETVAL
 
-void
+SV *
 ev_etcd_role_add(client, role_name, callback)
     EV::Etcd client
     SV *role_name
@@ -3864,53 +4369,18 @@ CODE:
     grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
     grpc_slice_unref(req_slice);
 
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
-
-    pc->call = grpc_channel_create_call(
-        client->channel, NULL, GRPC_PROPAGATE_DEFAULTS,
-        client->cq, METHOD_AUTH_ROLE_ADD, NULL, deadline, NULL
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for role_add");
-    }
-
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
-
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
-
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
-
+    grpc_call_error err = start_unary_call(client, pc, METHOD_AUTH_ROLE_ADD, send_buffer);
     if (err != GRPC_CALL_OK) {
         CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
+        croak("Failed to start gRPC call for role_add: %d", err);
     }
 
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
 }
+OUTPUT:
+    RETVAL
 
-void
+SV *
 ev_etcd_role_delete(client, role_name, callback)
     EV::Etcd client
     SV *role_name
@@ -3936,53 +4406,18 @@ CODE:
     grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
     grpc_slice_unref(req_slice);
 
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
-
-    pc->call = grpc_channel_create_call(
-        client->channel, NULL, GRPC_PROPAGATE_DEFAULTS,
-        client->cq, METHOD_AUTH_ROLE_DELETE, NULL, deadline, NULL
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for role_delete");
-    }
-
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
-
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
-
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
-
+    grpc_call_error err = start_unary_call(client, pc, METHOD_AUTH_ROLE_DELETE, send_buffer);
     if (err != GRPC_CALL_OK) {
         CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
+        croak("Failed to start gRPC call for role_delete: %d", err);
     }
 
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
 }
+OUTPUT:
+    RETVAL
 
-void
+SV *
 ev_etcd_role_get(client, role_name, callback)
     EV::Etcd client
     SV *role_name
@@ -4008,53 +4443,18 @@ CODE:
     grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
     grpc_slice_unref(req_slice);
 
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
-
-    pc->call = grpc_channel_create_call(
-        client->channel, NULL, GRPC_PROPAGATE_DEFAULTS,
-        client->cq, METHOD_AUTH_ROLE_GET, NULL, deadline, NULL
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for role_get");
-    }
-
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
-
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
-
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
-
+    grpc_call_error err = start_unary_call(client, pc, METHOD_AUTH_ROLE_GET, send_buffer);
     if (err != GRPC_CALL_OK) {
         CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
+        croak("Failed to start gRPC call for role_get: %d", err);
     }
 
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
 }
+OUTPUT:
+    RETVAL
 
-void
+SV *
 ev_etcd_role_list(client, callback)
     EV::Etcd client
     SV *callback
@@ -4074,53 +4474,18 @@ CODE:
     grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
     grpc_slice_unref(req_slice);
 
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
-
-    pc->call = grpc_channel_create_call(
-        client->channel, NULL, GRPC_PROPAGATE_DEFAULTS,
-        client->cq, METHOD_AUTH_ROLE_LIST, NULL, deadline, NULL
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for role_list");
-    }
-
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
-
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
-
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
-
+    grpc_call_error err = start_unary_call(client, pc, METHOD_AUTH_ROLE_LIST, send_buffer);
     if (err != GRPC_CALL_OK) {
         CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
+        croak("Failed to start gRPC call for role_list: %d", err);
     }
 
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
 }
+OUTPUT:
+    RETVAL
 
-void
+SV *
 ev_etcd_role_grant_permission(client, role_name, perm_type, key, range_end, callback)
     EV::Etcd client
     SV *role_name
@@ -4174,53 +4539,18 @@ CODE:
     grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
     grpc_slice_unref(req_slice);
 
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
-
-    pc->call = grpc_channel_create_call(
-        client->channel, NULL, GRPC_PROPAGATE_DEFAULTS,
-        client->cq, METHOD_AUTH_ROLE_GRANT_PERM, NULL, deadline, NULL
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for role_grant_permission");
-    }
-
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
-
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
-
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
-
+    grpc_call_error err = start_unary_call(client, pc, METHOD_AUTH_ROLE_GRANT_PERM, send_buffer);
     if (err != GRPC_CALL_OK) {
         CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
+        croak("Failed to start gRPC call for role_grant_permission: %d", err);
     }
 
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
 }
+OUTPUT:
+    RETVAL
 
-void
+SV *
 ev_etcd_role_revoke_permission(client, role_name, key, range_end, callback)
     EV::Etcd client
     SV *role_name
@@ -4260,53 +4590,18 @@ CODE:
     grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
     grpc_slice_unref(req_slice);
 
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
-
-    pc->call = grpc_channel_create_call(
-        client->channel, NULL, GRPC_PROPAGATE_DEFAULTS,
-        client->cq, METHOD_AUTH_ROLE_REVOKE_PERM, NULL, deadline, NULL
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for role_revoke_permission");
-    }
-
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
-
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
-
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
-
+    grpc_call_error err = start_unary_call(client, pc, METHOD_AUTH_ROLE_REVOKE_PERM, send_buffer);
     if (err != GRPC_CALL_OK) {
         CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
+        croak("Failed to start gRPC call for role_revoke_permission: %d", err);
     }
 
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
 }
+OUTPUT:
+    RETVAL
 
-void
+SV *
 ev_etcd_user_grant_role(client, username, role_name, callback)
     EV::Etcd client
     SV *username
@@ -4336,53 +4631,18 @@ CODE:
     grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
     grpc_slice_unref(req_slice);
 
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
-
-    pc->call = grpc_channel_create_call(
-        client->channel, NULL, GRPC_PROPAGATE_DEFAULTS,
-        client->cq, METHOD_AUTH_USER_GRANT_ROLE, NULL, deadline, NULL
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for user_grant_role");
-    }
-
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
-
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
-
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
-
+    grpc_call_error err = start_unary_call(client, pc, METHOD_AUTH_USER_GRANT_ROLE, send_buffer);
     if (err != GRPC_CALL_OK) {
         CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
+        croak("Failed to start gRPC call for user_grant_role: %d", err);
     }
 
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
 }
+OUTPUT:
+    RETVAL
 
-void
+SV *
 ev_etcd_user_revoke_role(client, username, role_name, callback)
     EV::Etcd client
     SV *username
@@ -4412,53 +4672,18 @@ CODE:
     grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
     grpc_slice_unref(req_slice);
 
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
+    grpc_call_error err = start_unary_call(client, pc, METHOD_AUTH_USER_REVOKE_ROLE, send_buffer);
+    if (err != GRPC_CALL_OK) {
+        CLEANUP_PENDING_CALL_ON_ERROR(pc);
+        croak("Failed to start gRPC call for user_revoke_role: %d", err);
+    }
 
-    pc->call = grpc_channel_create_call(
-        client->channel, NULL, GRPC_PROPAGATE_DEFAULTS,
-        client->cq, METHOD_AUTH_USER_REVOKE_ROLE, NULL, deadline, NULL
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for user_revoke_role");
-    }
-
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
-
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
-
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
-
-    if (err != GRPC_CALL_OK) {
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
-    }
-
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
 }
+OUTPUT:
+    RETVAL
 
-void
+SV *
 ev_etcd_user_get(client, username, callback)
     EV::Etcd client
     SV *username
@@ -4484,53 +4709,18 @@ CODE:
     grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
     grpc_slice_unref(req_slice);
 
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
-
-    pc->call = grpc_channel_create_call(
-        client->channel, NULL, GRPC_PROPAGATE_DEFAULTS,
-        client->cq, METHOD_AUTH_USER_GET, NULL, deadline, NULL
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for user_get");
-    }
-
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
-
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
-
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
-
+    grpc_call_error err = start_unary_call(client, pc, METHOD_AUTH_USER_GET, send_buffer);
     if (err != GRPC_CALL_OK) {
         CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
+        croak("Failed to start gRPC call for user_get: %d", err);
     }
 
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
 }
+OUTPUT:
+    RETVAL
 
-void
+SV *
 ev_etcd_user_list(client, callback)
     EV::Etcd client
     SV *callback
@@ -4550,61 +4740,38 @@ CODE:
     grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
     grpc_slice_unref(req_slice);
 
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
-
-    pc->call = grpc_channel_create_call(
-        client->channel, NULL, GRPC_PROPAGATE_DEFAULTS,
-        client->cq, METHOD_AUTH_USER_LIST, NULL, deadline, NULL
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for user_list");
-    }
-
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
-
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
-
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
-
+    grpc_call_error err = start_unary_call(client, pc, METHOD_AUTH_USER_LIST, send_buffer);
     if (err != GRPC_CALL_OK) {
         CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
+        croak("Failed to start gRPC call for user_list: %d", err);
     }
 
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
 }
+OUTPUT:
+    RETVAL
 
-void
-ev_etcd_lock(client, name, lease_id, callback)
+SV *
+ev_etcd_lock(client, name, lease_id, ...)
     EV::Etcd client
     SV *name
     int64_t lease_id
-    SV *callback
 CODE:
 {
+    SV *opts = NULL;
+    SV *callback;
+
+    if (items == 4) {
+        callback = ST(3);
+    } else if (items == 5) {
+        opts = ST(3);
+        callback = ST(4);
+    } else {
+        croak("Usage: $client->lock($name, $lease_id, [\\%%opts,] $callback)");
+    }
     VALIDATE_CALLBACK(callback);
+    write_batch_flush(aTHX_ client);  /* autobatch: send the queued batch first */
+    double timeout = parse_call_timeout(aTHX_ opts, "lock");
 
     STRLEN name_len;
     const char *name_str = SvPV(name, name_len);
@@ -4612,6 +4779,7 @@ CODE:
 
     pending_call_t *pc;
     INIT_PENDING_CALL(pc, CALL_TYPE_LOCK, callback, client);
+    pc->timeout = timeout;
 
     V3lockpb__LockRequest req = V3LOCKPB__LOCK_REQUEST__INIT;
     req.name.data = (uint8_t *)name_str;
@@ -4625,53 +4793,18 @@ CODE:
     grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
     grpc_slice_unref(req_slice);
 
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
-
-    pc->call = grpc_channel_create_call(
-        client->channel, NULL, GRPC_PROPAGATE_DEFAULTS,
-        client->cq, METHOD_LOCK, NULL, deadline, NULL
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for lock");
-    }
-
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
-
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
-
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
-
+    grpc_call_error err = start_unary_call(client, pc, METHOD_LOCK, send_buffer);
     if (err != GRPC_CALL_OK) {
         CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
+        croak("Failed to start gRPC call for lock: %d", err);
     }
 
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
 }
+OUTPUT:
+    RETVAL
 
-void
+SV *
 ev_etcd_unlock(client, key, callback)
     EV::Etcd client
     SV *key
@@ -4679,6 +4812,7 @@ ev_etcd_unlock(client, key, callback)
 CODE:
 {
     VALIDATE_CALLBACK(callback);
+    write_batch_flush(aTHX_ client);  /* autobatch: send the queued batch first */
 
     pending_call_t *pc;
     INIT_PENDING_CALL(pc, CALL_TYPE_UNLOCK, callback, client);
@@ -4698,62 +4832,39 @@ CODE:
     grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
     grpc_slice_unref(req_slice);
 
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
-
-    pc->call = grpc_channel_create_call(
-        client->channel, NULL, GRPC_PROPAGATE_DEFAULTS,
-        client->cq, METHOD_UNLOCK, NULL, deadline, NULL
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for unlock");
-    }
-
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
-
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
-
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
-
+    grpc_call_error err = start_unary_call(client, pc, METHOD_UNLOCK, send_buffer);
     if (err != GRPC_CALL_OK) {
         CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
+        croak("Failed to start gRPC call for unlock: %d", err);
     }
 
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
 }
+OUTPUT:
+    RETVAL
 
-void
-ev_etcd_election_campaign(client, name, lease_id, value, callback)
+SV *
+ev_etcd_election_campaign(client, name, lease_id, value, ...)
     EV::Etcd client
     SV *name
     int64_t lease_id
     SV *value
-    SV *callback
 CODE:
 {
+    SV *opts = NULL;
+    SV *callback;
+
+    if (items == 5) {
+        callback = ST(4);
+    } else if (items == 6) {
+        opts = ST(4);
+        callback = ST(5);
+    } else {
+        croak("Usage: $client->election_campaign($name, $lease_id, $value, [\\%%opts,] $callback)");
+    }
     VALIDATE_CALLBACK(callback);
+    write_batch_flush(aTHX_ client);  /* autobatch: send the queued batch first */
+    double timeout = parse_call_timeout(aTHX_ opts, "election_campaign");
 
     STRLEN name_len, value_len;
     const char *name_str = SvPV(name, name_len);
@@ -4763,6 +4874,7 @@ CODE:
 
     pending_call_t *pc;
     INIT_PENDING_CALL(pc, CALL_TYPE_ELECTION_CAMPAIGN, callback, client);
+    pc->timeout = timeout;
 
     V3electionpb__CampaignRequest req = V3ELECTIONPB__CAMPAIGN_REQUEST__INIT;
     req.name.data = (uint8_t *)name_str;
@@ -4778,53 +4890,18 @@ CODE:
     grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
     grpc_slice_unref(req_slice);
 
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
-
-    pc->call = grpc_channel_create_call(
-        client->channel, NULL, GRPC_PROPAGATE_DEFAULTS,
-        client->cq, METHOD_ELECTION_CAMPAIGN, NULL, deadline, NULL
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for election_campaign");
-    }
-
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
-
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
-
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
-
+    grpc_call_error err = start_unary_call(client, pc, METHOD_ELECTION_CAMPAIGN, send_buffer);
     if (err != GRPC_CALL_OK) {
         CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
+        croak("Failed to start gRPC call for election_campaign: %d", err);
     }
 
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
 }
+OUTPUT:
+    RETVAL
 
-void
+SV *
 ev_etcd_election_proclaim(client, leader, value, callback)
     EV::Etcd client
     SV *leader
@@ -4833,6 +4910,7 @@ ev_etcd_election_proclaim(client, leader, value, callback)
 CODE:
 {
     VALIDATE_CALLBACK(callback);
+    write_batch_flush(aTHX_ client);  /* autobatch: send the queued batch first */
 
     STRLEN value_len;
     const char *value_str = SvPV(value, value_len);
@@ -4878,53 +4956,18 @@ CODE:
     grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
     grpc_slice_unref(req_slice);
 
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
-
-    pc->call = grpc_channel_create_call(
-        client->channel, NULL, GRPC_PROPAGATE_DEFAULTS,
-        client->cq, METHOD_ELECTION_PROCLAIM, NULL, deadline, NULL
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for election_proclaim");
-    }
-
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
-
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
-
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
-
+    grpc_call_error err = start_unary_call(client, pc, METHOD_ELECTION_PROCLAIM, send_buffer);
     if (err != GRPC_CALL_OK) {
         CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
+        croak("Failed to start gRPC call for election_proclaim: %d", err);
     }
 
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
 }
+OUTPUT:
+    RETVAL
 
-void
+SV *
 ev_etcd_election_leader(client, name, callback)
     EV::Etcd client
     SV *name
@@ -4951,53 +4994,18 @@ CODE:
     grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
     grpc_slice_unref(req_slice);
 
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
-
-    pc->call = grpc_channel_create_call(
-        client->channel, NULL, GRPC_PROPAGATE_DEFAULTS,
-        client->cq, METHOD_ELECTION_LEADER, NULL, deadline, NULL
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for election_leader");
-    }
-
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
-
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
-
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
-
+    grpc_call_error err = start_unary_call(client, pc, METHOD_ELECTION_LEADER, send_buffer);
     if (err != GRPC_CALL_OK) {
         CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
+        croak("Failed to start gRPC call for election_leader: %d", err);
     }
 
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
 }
+OUTPUT:
+    RETVAL
 
-void
+SV *
 ev_etcd_election_resign(client, leader, callback)
     EV::Etcd client
     SV *leader
@@ -5005,6 +5013,7 @@ ev_etcd_election_resign(client, leader, callback)
 CODE:
 {
     VALIDATE_CALLBACK(callback);
+    write_batch_flush(aTHX_ client);  /* autobatch: send the queued batch first */
 
     if (!SvROK(leader) || SvTYPE(SvRV(leader)) != SVt_PVHV) {
         croak("leader must be a hash reference");
@@ -5044,51 +5053,16 @@ CODE:
     grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
     grpc_slice_unref(req_slice);
 
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
-
-    pc->call = grpc_channel_create_call(
-        client->channel, NULL, GRPC_PROPAGATE_DEFAULTS,
-        client->cq, METHOD_ELECTION_RESIGN, NULL, deadline, NULL
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for election_resign");
-    }
-
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
-
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
-
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
-
+    grpc_call_error err = start_unary_call(client, pc, METHOD_ELECTION_RESIGN, send_buffer);
     if (err != GRPC_CALL_OK) {
         CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
+        croak("Failed to start gRPC call for election_resign: %d", err);
     }
 
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
 }
+OUTPUT:
+    RETVAL
 
 void
 ev_etcd_election_observe(client, name, callback, ...)
@@ -5199,7 +5173,7 @@ CODE:
     client->observes = oc;
 }
 
-void
+SV *
 ev_etcd_member_list(client, callback)
     EV::Etcd client
     SV *callback
@@ -5220,53 +5194,18 @@ CODE:
     grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
     grpc_slice_unref(req_slice);
 
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
-
-    pc->call = grpc_channel_create_call(
-        client->channel, NULL, GRPC_PROPAGATE_DEFAULTS,
-        client->cq, METHOD_CLUSTER_MEMBER_LIST, NULL, deadline, NULL
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for member_list");
-    }
-
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
-
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
-
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
-
+    grpc_call_error err = start_unary_call(client, pc, METHOD_CLUSTER_MEMBER_LIST, send_buffer);
     if (err != GRPC_CALL_OK) {
         CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
+        croak("Failed to start gRPC call for member_list: %d", err);
     }
 
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
 }
+OUTPUT:
+    RETVAL
 
-void
+SV *
 ev_etcd_member_add(client, peer_urls, ...)
     EV::Etcd client
     SV *peer_urls
@@ -5288,6 +5227,7 @@ CODE:
     }
 
     VALIDATE_CALLBACK(callback);
+    double timeout = opts_timeout(aTHX_ opts, "member_add");
 
     if (!SvROK(peer_urls) || SvTYPE(SvRV(peer_urls)) != SVt_PVAV) {
         croak("peer_urls must be an array reference");
@@ -5306,6 +5246,7 @@ CODE:
 
     pending_call_t *pc;
     INIT_PENDING_CALL(pc, CALL_TYPE_MEMBER_ADD, callback, client);
+    pc->timeout = timeout;
 
     Etcdserverpb__MemberAddRequest req = ETCDSERVERPB__MEMBER_ADD_REQUEST__INIT;
     req.is_learner = is_learner;
@@ -5337,53 +5278,18 @@ CODE:
     grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
     grpc_slice_unref(req_slice);
 
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
-
-    pc->call = grpc_channel_create_call(
-        client->channel, NULL, GRPC_PROPAGATE_DEFAULTS,
-        client->cq, METHOD_CLUSTER_MEMBER_ADD, NULL, deadline, NULL
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for member_add");
-    }
-
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
-
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
-
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
-
+    grpc_call_error err = start_unary_call(client, pc, METHOD_CLUSTER_MEMBER_ADD, send_buffer);
     if (err != GRPC_CALL_OK) {
         CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
+        croak("Failed to start gRPC call for member_add: %d", err);
     }
 
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
 }
+OUTPUT:
+    RETVAL
 
-void
+SV *
 ev_etcd_member_remove(client, id, callback)
     EV::Etcd client
     UV id
@@ -5405,53 +5311,18 @@ CODE:
     grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
     grpc_slice_unref(req_slice);
 
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
-
-    pc->call = grpc_channel_create_call(
-        client->channel, NULL, GRPC_PROPAGATE_DEFAULTS,
-        client->cq, METHOD_CLUSTER_MEMBER_REMOVE, NULL, deadline, NULL
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for member_remove");
-    }
-
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
-
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
-
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
-
+    grpc_call_error err = start_unary_call(client, pc, METHOD_CLUSTER_MEMBER_REMOVE, send_buffer);
     if (err != GRPC_CALL_OK) {
         CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
+        croak("Failed to start gRPC call for member_remove: %d", err);
     }
 
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
 }
-
-void
+OUTPUT:
+    RETVAL
+
+SV *
 ev_etcd_member_update(client, id, peer_urls, callback)
     EV::Etcd client
     UV id
@@ -5500,53 +5371,18 @@ CODE:
     grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
     grpc_slice_unref(req_slice);
 
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
-
-    pc->call = grpc_channel_create_call(
-        client->channel, NULL, GRPC_PROPAGATE_DEFAULTS,
-        client->cq, METHOD_CLUSTER_MEMBER_UPDATE, NULL, deadline, NULL
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for member_update");
-    }
-
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
-
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
-
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
-
+    grpc_call_error err = start_unary_call(client, pc, METHOD_CLUSTER_MEMBER_UPDATE, send_buffer);
     if (err != GRPC_CALL_OK) {
         CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
+        croak("Failed to start gRPC call for member_update: %d", err);
     }
 
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
 }
+OUTPUT:
+    RETVAL
 
-void
+SV *
 ev_etcd_member_promote(client, id, callback)
     EV::Etcd client
     UV id
@@ -5568,53 +5404,18 @@ CODE:
     grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
     grpc_slice_unref(req_slice);
 
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
-
-    pc->call = grpc_channel_create_call(
-        client->channel, NULL, GRPC_PROPAGATE_DEFAULTS,
-        client->cq, METHOD_CLUSTER_MEMBER_PROMOTE, NULL, deadline, NULL
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for member_promote");
-    }
-
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
-
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
-
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
-
+    grpc_call_error err = start_unary_call(client, pc, METHOD_CLUSTER_MEMBER_PROMOTE, send_buffer);
     if (err != GRPC_CALL_OK) {
         CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
+        croak("Failed to start gRPC call for member_promote: %d", err);
     }
 
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
 }
+OUTPUT:
+    RETVAL
 
-void
+SV *
 ev_etcd_alarm(client, action, ...)
     EV::Etcd client
     char *action
@@ -5636,10 +5437,12 @@ CODE:
     }
 
     VALIDATE_CALLBACK(callback);
+    double timeout = opts_timeout(aTHX_ opts, "alarm");
 
     /* Create pending call structure */
     pending_call_t *pc;
     INIT_PENDING_CALL(pc, CALL_TYPE_ALARM, callback, client);
+    pc->timeout = timeout;
 
     /* Build AlarmRequest */
     Etcdserverpb__AlarmRequest req = ETCDSERVERPB__ALARM_REQUEST__INIT;
@@ -5686,67 +5489,18 @@ CODE:
     grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
     grpc_slice_unref(req_slice);
 
-    /* Create call */
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
-
-    pc->call = grpc_channel_create_call(
-        client->channel,
-        NULL,
-        GRPC_PROPAGATE_DEFAULTS,
-        client->cq,
-        METHOD_MAINTENANCE_ALARM,
-        NULL,
-        deadline,
-        NULL
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for alarm");
-    }
-
-    /* Set up operations */
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
-
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
-
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
-
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
-
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
-
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
-
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
-
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
-
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
-
+    grpc_call_error err = start_unary_call(client, pc, METHOD_MAINTENANCE_ALARM, send_buffer);
     if (err != GRPC_CALL_OK) {
         CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
+        croak("Failed to start gRPC call for alarm: %d", err);
     }
 
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
 }
+OUTPUT:
+    RETVAL
 
-void
+SV *
 ev_etcd_defragment(client, callback)
     EV::Etcd client
     SV *callback
@@ -5769,67 +5523,18 @@ CODE:
     grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
     grpc_slice_unref(req_slice);
 
-    /* Create call */
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
-
-    pc->call = grpc_channel_create_call(
-        client->channel,
-        NULL,
-        GRPC_PROPAGATE_DEFAULTS,
-        client->cq,
-        METHOD_MAINTENANCE_DEFRAGMENT,
-        NULL,
-        deadline,
-        NULL
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for defragment");
-    }
-
-    /* Set up operations */
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
-
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
-
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
-
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
-
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
-
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
-
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
-
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
-
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
-
+    grpc_call_error err = start_unary_call(client, pc, METHOD_MAINTENANCE_DEFRAGMENT, send_buffer);
     if (err != GRPC_CALL_OK) {
         CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
+        croak("Failed to start gRPC call for defragment: %d", err);
     }
 
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
 }
+OUTPUT:
+    RETVAL
 
-void
+SV *
 ev_etcd_hash_kv(client, ...)
     EV::Etcd client
 CODE:
@@ -5867,67 +5572,18 @@ CODE:
     grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
     grpc_slice_unref(req_slice);
 
-    /* Create call */
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
-
-    pc->call = grpc_channel_create_call(
-        client->channel,
-        NULL,
-        GRPC_PROPAGATE_DEFAULTS,
-        client->cq,
-        METHOD_MAINTENANCE_HASH_KV,
-        NULL,
-        deadline,
-        NULL
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for hash_kv");
-    }
-
-    /* Set up operations */
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
-
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
-
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
-
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
-
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
-
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
-
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
-
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
-
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
-
+    grpc_call_error err = start_unary_call(client, pc, METHOD_MAINTENANCE_HASH_KV, send_buffer);
     if (err != GRPC_CALL_OK) {
         CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
+        croak("Failed to start gRPC call for hash_kv: %d", err);
     }
 
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
 }
+OUTPUT:
+    RETVAL
 
-void
+SV *
 ev_etcd_move_leader(client, target_id, callback)
     EV::Etcd client
     UV target_id
@@ -5952,67 +5608,18 @@ CODE:
     grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
     grpc_slice_unref(req_slice);
 
-    /* Create call */
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
-
-    pc->call = grpc_channel_create_call(
-        client->channel,
-        NULL,
-        GRPC_PROPAGATE_DEFAULTS,
-        client->cq,
-        METHOD_MAINTENANCE_MOVE_LEADER,
-        NULL,
-        deadline,
-        NULL
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for move_leader");
-    }
-
-    /* Set up operations */
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
-
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
-
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
-
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
-
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
-
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
-
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
-
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
-
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
-
+    grpc_call_error err = start_unary_call(client, pc, METHOD_MAINTENANCE_MOVE_LEADER, send_buffer);
     if (err != GRPC_CALL_OK) {
         CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
+        croak("Failed to start gRPC call for move_leader: %d", err);
     }
 
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
 }
+OUTPUT:
+    RETVAL
 
-void
+SV *
 ev_etcd_auth_status(client, callback)
     EV::Etcd client
     SV *callback
@@ -6035,64 +5642,110 @@ CODE:
     grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
     grpc_slice_unref(req_slice);
 
-    /* Create call */
-    gpr_timespec deadline = gpr_time_add(
-        gpr_now(GPR_CLOCK_REALTIME),
-        gpr_time_from_seconds(client->timeout_seconds, GPR_TIMESPAN)
-    );
-
-    pc->call = grpc_channel_create_call(
-        client->channel,
-        NULL,
-        GRPC_PROPAGATE_DEFAULTS,
-        client->cq,
-        METHOD_AUTH_STATUS,
-        NULL,
-        deadline,
-        NULL
-    );
-
-    if (!pc->call) {
-        grpc_byte_buffer_destroy(send_buffer);
+    grpc_call_error err = start_unary_call(client, pc, METHOD_AUTH_STATUS, send_buffer);
+    if (err != GRPC_CALL_OK) {
         CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to create gRPC call for auth_status");
+        croak("Failed to start gRPC call for auth_status: %d", err);
     }
 
-    /* Set up operations */
-    grpc_op ops[6] = {0};
-    grpc_metadata auth_md;
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
+}
+OUTPUT:
+    RETVAL
 
-    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
-    setup_auth_metadata(client, &ops[0], &auth_md);
+void
+ev_etcd_atfork_prepare(class)
+    char *class
+CODE:
+{
+    ev_etcd_t *client;
+    PERL_UNUSED_VAR(class);
 
-    ops[1].op = GRPC_OP_SEND_MESSAGE;
-    ops[1].data.send_message.send_message = send_buffer;
+    if (!live_clients) XSRETURN_EMPTY;
+    if (!grpc_fork_support) {
+        croak("atfork_prepare: set GRPC_ENABLE_FORK_SUPPORT=1 in the environment before loading EV::Etcd");
+    }
+    for (client = live_clients; client; client = client->next_client) {
+        if (client->in_callback) {
+            croak("atfork_prepare: cannot fork from inside an EV::Etcd callback");
+        }
+    }
 
-    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
+    /* Signal every thread first, so the waits overlap */
+    for (client = live_clients; client; client = client->next_client) {
+        if (!client->quiesced && client->pid == getpid()) {
+            client->thread_running = 0;
+        }
+    }
+    for (client = live_clients; client; client = client->next_client) {
+        if (!client->quiesced && client->pid == getpid()) {
+            pthread_join(client->cq_thread, NULL);
+            client->quiesced = 1;
+        }
+    }
+}
 
-    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
-    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
+void
+ev_etcd_atfork_parent(class)
+    char *class
+CODE:
+{
+    ev_etcd_t *client;
+    PERL_UNUSED_VAR(class);
+
+    for (client = live_clients; client; client = client->next_client) {
+        if (!client->quiesced) continue;
+        client->quiesced = 0;
+        client->thread_running = 1;
+        if (pthread_create(&client->cq_thread, NULL, cq_thread_func, client) != 0) {
+            client->thread_running = 0;
+            client->quiesced = 1;
+            croak("Failed to restart gRPC completion queue thread");
+        }
+    }
+}
 
-    ops[4].op = GRPC_OP_RECV_MESSAGE;
-    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
+void
+ev_etcd_atfork_child(class, ...)
+    char *class
+CODE:
+{
+    int watches = 1;
+    int keepalives = 0;
+    int i;
+    PERL_UNUSED_VAR(class);
 
-    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
-    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
-    ops[5].data.recv_status_on_client.status = &pc->status;
-    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
+    if ((items - 1) % 2 != 0) {
+        croak("Usage: EV::Etcd->atfork_child(watches => $bool, keepalives => $bool)");
+    }
+    for (i = 1; i < items; i += 2) {
+        const char *key = SvPV_nolen(ST(i));
+        if (strEQ(key, "watches")) {
+            watches = SvTRUE(ST(i + 1)) ? 1 : 0;
+        } else if (strEQ(key, "keepalives")) {
+            keepalives = SvTRUE(ST(i + 1)) ? 1 : 0;
+        } else {
+            croak("atfork_child: unknown option '%s'", key);
+        }
+    }
 
-    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
+    grpc_owner_pid = getpid();
+    ev_loop_fork(EV_DEFAULT);
 
-    cleanup_auth_metadata(client, &auth_md);
-    grpc_byte_buffer_destroy(send_buffer);
+    /* Callbacks may destroy any client: rescan for the next inherited one */
+    for (;;) {
+        ev_etcd_t *client = live_clients;
+        while (client && client->pid == getpid()) {
+            client = client->next_client;
+        }
+        if (!client) break;
 
-    if (err != GRPC_CALL_OK) {
-        CLEANUP_PENDING_CALL_ON_ERROR(pc);
-        croak("Failed to start gRPC call: %d", err);
+        client_after_fork(aTHX_ client, watches, keepalives);
+        /* Destroyed from a restart error callback */
+        if (!client->active) {
+            Safefree(client);
+        }
     }
-
-    pc->next = client->pending_calls;
-    client->pending_calls = pc;
 }
 
 void
@@ -6102,6 +5755,14 @@ CODE:
 {
     /* Mark client as inactive first to prevent callbacks from accessing freed memory */
     client->active = 0;
+    unlink_live_client(client);
+
+    /* A forked child that never ran atfork_child: the gRPC objects and the
+     * thread are the parent's, so only the memory around them is freed */
+    int inherited = client->pid != getpid();
+    if (inherited) {
+        forget_inherited_state(aTHX_ client);
+    }
 
     /* Stop ev_async watcher */
     if (ev_is_active(&client->cq_async)) {
@@ -6140,6 +5801,10 @@ CODE:
         oc = oc->next;
     }
 
+    if (client->lease_mgr) {
+        lease_mgr_cancel(client->lease_mgr);
+    }
+
     /* Cancel pending unary calls */
     pending_call_t *pc = client->pending_calls;
     while (pc) {
@@ -6155,7 +5820,9 @@ CODE:
     }
 
     /* Wait for the gRPC thread to finish */
-    pthread_join(client->cq_thread, NULL);
+    if (!inherited && !client->quiesced) {
+        pthread_join(client->cq_thread, NULL);
+    }
 
     /* Clean up the event queue (any remaining queued events) */
     pthread_mutex_lock(&client->queue_mutex);
@@ -6181,19 +5848,10 @@ CODE:
     pc = client->pending_calls;
     while (pc) {
         pending_call_t *next = pc->next;
-        grpc_metadata_array_destroy(&pc->initial_metadata);
-        grpc_metadata_array_destroy(&pc->trailing_metadata);
-        if (pc->recv_buffer) {
-            grpc_byte_buffer_destroy(pc->recv_buffer);
-        }
-        grpc_slice_unref(pc->status_details);
-        if (pc->call) {
-            grpc_call_unref(pc->call);
-        }
-        SvREFCNT_dec(pc->callback);
-        Safefree(pc);
+        FREE_PENDING_CALL(pc);
         pc = next;
     }
+    client->pending_calls = NULL;
 
     wc = client->watches;
     while (wc) {
@@ -6208,6 +5866,31 @@ CODE:
             grpc_call_unref(wc->call);
         }
         SvREFCNT_dec(wc->callback);
+        if (wc->sync_callback) {
+            SvREFCNT_dec(wc->sync_callback);
+        }
+        if (wc->cache) {
+            wc->cache->wc = NULL;
+        }
+        if (wc->deferred) {
+            SvREFCNT_dec((SV *)wc->deferred);  /* undelivered, client is going away */
+        }
+        ev_timer_stop(EV_DEFAULT, &wc->coalesce_timer);
+        if (wc->coalesced) {
+            SvREFCNT_dec((SV *)wc->coalesced);
+        }
+        if (wc->coalesce_result) {
+            SvREFCNT_dec((SV *)wc->coalesce_result);
+        }
+        if (wc->known) {
+            SvREFCNT_dec((SV *)wc->known);
+        }
+        if (wc->resync_seen) {
+            SvREFCNT_dec((SV *)wc->resync_seen);
+        }
+        if (wc->resync_events) {
+            SvREFCNT_dec(wc->resync_events);
+        }
         /* Free watch params */
         if (wc->params.key) {
             Safefree(wc->params.key);
@@ -6232,6 +5915,9 @@ CODE:
             grpc_call_unref(kc->call);
         }
         SvREFCNT_dec(kc->callback);
+        if (kc->deferred) {
+            SvREFCNT_dec((SV *)kc->deferred);  /* undelivered, client is going away */
+        }
         Safefree(kc);
         kc = next;
     }
@@ -6256,18 +5942,56 @@ CODE:
         oc = next;
     }
 
-    /* Stop health timer */
-    ev_timer_stop(EV_DEFAULT, &client->health_timer);
+    /* Pools outliving the client (global destruction) are left detached */
+    lease_pool_t *pool;
+    for (pool = client->lease_pools; pool; pool = pool->next) {
+        pool->client = NULL;
+        ev_timer_stop(EV_DEFAULT, &pool->retry_timer);
+    }
+    client->lease_pools = NULL;
+
+    if (client->lease_mgr) {
+        lease_mgr_free(aTHX_ client->lease_mgr);
+        client->lease_mgr = NULL;
+    }
+
+    /* Stop health timer */
+    ev_timer_stop(EV_DEFAULT, &client->health_timer);
+
+    /* Writes not yet sent are dropped like calls in flight */
+    write_batch_discard(aTHX_ client);
 
     /* Free health callback */
     if (client->health_callback) {
         SvREFCNT_dec(client->health_callback);
     }
 
-    /* Free auth token - securely zero before freeing */
-    if (client->auth_token) {
-        memset(client->auth_token, 0, client->auth_token_len);
-        Safefree(client->auth_token);
+    /* Calls parked for re-authentication never reached the pending list */
+    pc = client->reauth_queue;
+    while (pc) {
+        pending_call_t *next = pc->next;
+        FREE_PENDING_CALL(pc);
+        pc = next;
+    }
+    client->reauth_queue = NULL;
+
+    /* Every call has left the inflight table by now */
+    if (client->inflight) {
+        SvREFCNT_dec((SV *)client->inflight);
+        client->inflight = NULL;
+    }
+
+    /* Free auth token and saved credentials - securely zero before freeing.
+     * All calls are gone by now, so nothing else references the token. */
+    if (GRPC_SLICE_LENGTH(client->auth_token) > 0) {
+        memset(GRPC_SLICE_START_PTR(client->auth_token), 0, GRPC_SLICE_LENGTH(client->auth_token));
+    }
+    grpc_slice_unref(client->auth_token);
+    client->auth_token = grpc_empty_slice();
+    if (client->reauth_request) {
+        wipe_byte_buffer(client->reauth_request);
+        grpc_byte_buffer_destroy(client->reauth_request);
+        client->reauth_request = NULL;
     }
 
     /* Free endpoints */
@@ -6351,6 +6075,9 @@ CODE:
         grpc_byte_buffer_destroy(send_buffer);
     }
 
+    /* A paused watch has no receive outstanding to complete and clean up */
+    watch_unpark_cancelled(wc);
+
     /* Call callback indicating success */
     dSP;
     ENTER;
@@ -6365,6 +6092,34 @@ CODE:
     LEAVE;
 }
 
+void
+ev_etcd_watch_pause(watch)
+    EV::Etcd::Watch watch
+CODE:
+{
+    /* Takes effect when the outstanding receive completes */
+    watch->paused = 1;
+}
+
+void
+ev_etcd_watch_resume(watch)
+    EV::Etcd::Watch watch
+CODE:
+{
+    watch->paused = 0;
+    if (watch->recv_parked && !watch->delivering) {
+        watch_rearm_recv(aTHX_ watch);
+    }
+}
+
+int
+ev_etcd_watch_paused(watch)
+    EV::Etcd::Watch watch
+CODE:
+    RETVAL = watch->paused;
+OUTPUT:
+    RETVAL
+
 void
 ev_etcd_watch_DESTROY(watch)
     EV::Etcd::Watch watch
@@ -6379,9 +6134,536 @@ CODE:
     (void)watch;  /* Silence unused parameter warning */
 }
 
+MODULE = EV::Etcd  PACKAGE = EV::Etcd::Prepared  PREFIX = ev_etcd_prepared_
+
+SV *
+ev_etcd_prepared_run(prep, ...)
+    EV::Etcd::Prepared prep
+CODE:
+{
+    /* Parse arguments: run($callback) for get, run($value, $callback) for put */
+    SV *callback;
+    SV *value = NULL;
+
+    if (prep->type == CALL_TYPE_PUT) {
+        if (items != 3) {
+            croak("Usage: $prepared->run($value, $callback)");
+        }
+        value = ST(1);
+        callback = ST(2);
+    } else {
+        if (items != 2) {
+            croak("Usage: $prepared->run($callback)");
+        }
+        callback = ST(1);
+    }
+
+    VALIDATE_CALLBACK(callback);
+
+    ev_etcd_t *client = prep->client;
+    if (prep->type == CALL_TYPE_PUT) {
+        write_batch_flush(aTHX_ client);  /* autobatch: send the queued batch first */
+    }
+    grpc_slice slices[3];
+    size_t n_slices = 0;
+    grpc_slice value_slice = grpc_empty_slice();
+
+    slices[n_slices++] = prep->head;
+
+    if (value) {
+        STRLEN value_len;
+        const char *value_str = SvPV(value, value_len);
+        VALIDATE_VALUE_SIZE(value_len);
+
+        /* Empty bytes are omitted in proto3, same as the packer would do */
+        if (value_len > 0) {
+            uint8_t hdr[11];
+            size_t hdr_len = 0;
+            uint64_t v = value_len;
+            hdr[hdr_len++] = 0x12;  /* field 2 (value), wire type 2 */
+            while (v >= 0x80) {
+                hdr[hdr_len++] = (uint8_t)(v | 0x80);
+                v >>= 7;
+            }
+            hdr[hdr_len++] = (uint8_t)v;
+
+            value_slice = grpc_slice_malloc(hdr_len + value_len);
+            memcpy(GRPC_SLICE_START_PTR(value_slice), hdr, hdr_len);
+            memcpy(GRPC_SLICE_START_PTR(value_slice) + hdr_len, value_str, value_len);
+            slices[n_slices++] = value_slice;
+        }
+
+        if (GRPC_SLICE_LENGTH(prep->tail) > 0) {
+            slices[n_slices++] = prep->tail;
+        }
+    }
+
+    pending_call_t *pc;
+    INIT_PENDING_CALL(pc, prep->type, callback, client);
+    pc->format = prep->format;
+    pc->raw = prep->raw;
+
+    /* The byte buffer takes its own references on the slices */
+    grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(slices, n_slices);
+    grpc_slice_unref(value_slice);
+
+    grpc_call_error err = start_unary_call(client, pc,
+        prep->type == CALL_TYPE_PUT ? METHOD_KV_PUT : METHOD_KV_RANGE, send_buffer);
+    if (err != GRPC_CALL_OK) {
+        CLEANUP_PENDING_CALL_ON_ERROR(pc);
+        croak("Failed to start gRPC call for prepared %s: %d",
+              prep->type == CALL_TYPE_PUT ? "put" : "range", err);
+    }
+
+    RETVAL = GIMME_V == G_VOID ? &PL_sv_undef : new_call_handle(aTHX_ pc);
+}
+OUTPUT:
+    RETVAL
+
+void
+ev_etcd_prepared_DESTROY(prep)
+    EV::Etcd::Prepared prep
+CODE:
+{
+    grpc_slice_unref(prep->head);
+    grpc_slice_unref(prep->tail);
+    SvREFCNT_dec(prep->client_sv);
+    Safefree(prep);
+}
+
+MODULE = EV::Etcd  PACKAGE = EV::Etcd::Cache  PREFIX = ev_etcd_cache_
+
+SV *
+ev_etcd_cache_get(cache, key)
+    EV::Etcd::Cache cache
+    SV *key
+CODE:
+{
+    STRLEN key_len;
+    const char *key_str = SvPV(key, key_len);
+    if (!cache_covers(cache, key_str, key_len)) {
+        croak("key is outside the cached prefix");
+    }
+    SV *value = cache_lookup(aTHX_ cache, key_str, key_len);
+    RETVAL = value ? SvREFCNT_inc_simple_NN(value) : &PL_sv_undef;
+}
+OUTPUT:
+    RETVAL
+
+SV *
+ev_etcd_cache_get_prefix(cache, prefix)
+    EV::Etcd::Cache cache
+    SV *prefix
+CODE:
+{
+    STRLEN prefix_len;
+    const char *prefix_str = SvPV(prefix, prefix_len);
+    if (!cache_covers(cache, prefix_str, prefix_len)) {
+        croak("prefix is outside the cached prefix");
+    }
+    RETVAL = newRV_noinc((SV *)cache_lookup_prefix(aTHX_ cache, prefix_str, prefix_len));
+}
+OUTPUT:
+    RETVAL
+
+SV *
+ev_etcd_cache_range(cache, key, ...)
+    EV::Etcd::Cache cache
+    SV *key
+CODE:
+{
+    /* Parse arguments: range(key, [opts]) - the options of get() that apply */
+    if (items > 3) {
+        croak("Usage: $cache->range($key, [\\%%opts])");
+    }
+    if (!cache->history) {
+        croak("range needs a cache created with the history option");
+    }
+
+    STRLEN key_len;
+    const char *key_str = SvPV(key, key_len);
+    const char *end = NULL;
+    STRLEN end_len = 0;
+    char *end_copy = NULL;
+    int64_t revision = cache->revision;
+    cache_sort_t sort = CACHE_SORT_KEY;
+    int descend = 0;
+    size_t limit = 0;
+    int ranged = 0;
+
+    if (items == 3) {
+        SV *opts = ST(2);
+        SV **svp;
+        if (!SvROK(opts) || SvTYPE(SvRV(opts)) != SVt_PVHV) {
+            croak("range options must be a hash reference");
+        }
+        HV *hv = (HV *)SvRV(opts);
+
+        if ((svp = hv_fetchs(hv, "revision", 0)) && SvOK(*svp) && SvIV(*svp) > 0) {
+            revision = SvIV(*svp);
+        }
+        if ((svp = hv_fetchs(hv, "limit", 0)) && SvOK(*svp) && SvIV(*svp) > 0) {
+            limit = (size_t)SvIV(*svp);
+        }
+        if ((svp = hv_fetchs(hv, "sort_order", 0)) && SvOK(*svp)) {
+            const char *order = SvPV_nolen(*svp);
+            descend = strEQ(order, "descend") || strEQ(order, "DESCEND");
+        }
+        if ((svp = hv_fetchs(hv, "sort_target", 0)) && SvOK(*svp)) {
+            const char *target = SvPV_nolen(*svp);
+            if (strEQ(target, "mod") || strEQ(target, "MOD")) {
+                sort = CACHE_SORT_MOD_REVISION;
+            } else if (strEQ(target, "create") || strEQ(target, "CREATE")) {
+                sort = CACHE_SORT_CREATE_REVISION;
+            } else if (!strEQ(target, "key") && !strEQ(target, "KEY")) {
+                croak("unsupported sort_target '%s' for a cache range", target);
+            }
+        }
+        if ((svp = hv_fetchs(hv, "range_end", 0)) && SvOK(*svp)) {
+            end = SvPV(*svp, end_len);
+            ranged = 1;
+        } else if ((svp = hv_fetchs(hv, "prefix", 0)) && SvTRUE(*svp)) {
+            ranged = 1;
+            if (key_len > 0) {
+                size_t range_len;
+                end_copy = compute_prefix_range_end(key_str, key_len, &range_len);
+                end = end_copy;
+                end_len = end_copy ? range_len : 0;
+            }
+        }
+    }
+
+    /* A single key: the range ends right after it */
+    if (!ranged) {
+        Newx(end_copy, key_len + 1, char);
+        Copy(key_str, end_copy, key_len, char);
+        end_copy[key_len] = '\0';
+        end = end_copy;
+        end_len = key_len + 1;
+    }
+    /* "\0" as range_end means every key from key on */
+    if (ranged && end_len == 1 && end[0] == '\0') {
+        end_len = 0;
+    }
+
+    if (!cache->ready || revision < cache->floor || revision > cache->revision) {
+        if (end_copy) Safefree(end_copy);
+        if (!cache->ready) {
+            croak("cache is not ready");
+        }
+        croak("revision %" IVdf " is outside the cached history (%" IVdf "..%" IVdf ")",
+              (IV)revision, (IV)cache->floor, (IV)cache->revision);
+    }
+
+    AV *result = cache_range(aTHX_ cache, key_str, key_len, end, end_len,
+                             revision, sort, descend, limit);
+    if (end_copy) Safefree(end_copy);
+    RETVAL = newRV_noinc((SV *)result);
+}
+OUTPUT:
+    RETVAL
+
+int
+ev_etcd_cache_save(cache)
+    EV::Etcd::Cache cache
+CODE:
+{
+    if (!cache->persist_path) {
+        croak("save needs a cache created with the persist option");
+    }
+    /* On failure $! says why */
+    RETVAL = cache_save(aTHX_ cache);
+}
+OUTPUT:
+    RETVAL
+
+IV
+ev_etcd_cache_floor(cache)
+    EV::Etcd::Cache cache
+CODE:
+    RETVAL = cache->floor;
+OUTPUT:
+    RETVAL
+
+IV
+ev_etcd_cache_revision(cache)
+    EV::Etcd::Cache cache
+CODE:
+    RETVAL = cache->revision;
+OUTPUT:
+    RETVAL
+
+int
+ev_etcd_cache_ready(cache)
+    EV::Etcd::Cache cache
+CODE:
+    RETVAL = cache->ready;
+OUTPUT:
+    RETVAL
+
+SV *
+ev_etcd_cache_stats(cache)
+    EV::Etcd::Cache cache
+CODE:
+{
+    HV *hv = newHV();
+    hv_stores(hv, "hits", newSVuv(cache->hits));
+    hv_stores(hv, "misses", newSVuv(cache->misses));
+    hv_stores(hv, "keys", newSVuv(cache->ready ? HvUSEDKEYS(cache->data) : 0));
+    hv_stores(hv, "revision", newSViv(cache->revision));
+    hv_stores(hv, "loads", newSVuv(cache->loads));
+    if (cache->persist_path) {
+        hv_stores(hv, "saved_revision", newSViv(cache->saved_revision));
+    }
+    if (cache->shm) {
+        hv_stores(hv, "publishes", newSVuv(cache->publishes));
+        hv_stores(hv, "publish_failures", newSVuv(cache->publish_failures));
+    }
+    if (cache->history) {
+        hv_stores(hv, "floor", newSViv(cache->floor));
+    }
+    hv_stores(hv, "watching", newSViv(cache->wc && cache->wc->active));
+    /* Seconds since etcd last told us anything about the prefix */
+    hv_stores(hv, "age", cache->ready
+        ? newSVnv(ev_now(EV_DEFAULT) - cache->updated) : newSV(0));
+    RETVAL = newRV_noinc((SV *)hv);
+}
+OUTPUT:
+    RETVAL
+
+void
+ev_etcd_cache_DESTROY(cache)
+    EV::Etcd::Cache cache
+CODE:
+{
+    /* Keep what changed since the last save for the next start */
+    if (cache->persist_path && cache->ready && cache->revision > cache->saved_revision) {
+        (void)cache_save(aTHX_ cache);
+    }
+
+    /* Leave the mirror with the final contents */
+    if (cache->shm) {
+        if (cache->publish_pending) {
+            ev_timer_stop(EV_DEFAULT, &cache->publish_timer);
+            cache_publish(aTHX_ cache);
+        }
+        shm_close(cache->shm);
+    }
+
+    /* Stop the feeding watch; its completion frees it */
+    watch_call_t *wc = cache->wc;
+    if (wc) {
+        wc->cache = NULL;
+        wc->active = 0;
+        if (wc->call) {
+            grpc_call_cancel(wc->call, NULL);
+        }
+        watch_unpark_cancelled(wc);
+    }
+    if (cache->data) {
+        SvREFCNT_dec((SV *)cache->data);
+    }
+    if (cache->loading) {
+        SvREFCNT_dec((SV *)cache->loading);
+    }
+    cache_index_clear(aTHX_ &cache->index);
+    cache_index_clear(aTHX_ &cache->loading_index);
+    if (cache->persist_path) {
+        Safefree(cache->persist_path);
+    }
+    Safefree(cache->prefix);
+    SvREFCNT_dec(cache->client_sv);
+    Safefree(cache);
+}
+
+MODULE = EV::Etcd  PACKAGE = EV::Etcd::LeasePool  PREFIX = ev_etcd_lease_pool_
+
+SV *
+ev_etcd_lease_pool_take(pool)
+    EV::Etcd::LeasePool pool
+CODE:
+{
+    int64_t id = lease_pool_take(aTHX_ pool);
+    RETVAL = id > 0 ? newSViv(id) : &PL_sv_undef;
+}
+OUTPUT:
+    RETVAL
+
+UV
+ev_etcd_lease_pool_available(pool)
+    EV::Etcd::LeasePool pool
+CODE:
+    RETVAL = pool->len;
+OUTPUT:
+    RETVAL
+
+SV *
+ev_etcd_lease_pool_stats(pool)
+    EV::Etcd::LeasePool pool
+CODE:
+{
+    HV *hv = newHV();
+    hv_stores(hv, "available", newSVuv(pool->len));
+    hv_stores(hv, "granting", newSVuv(pool->granting));
+    hv_stores(hv, "size", newSVuv(pool->size));
+    hv_stores(hv, "ttl", newSViv(pool->ttl));
+    hv_stores(hv, "taken", newSVuv(pool->taken));
+    hv_stores(hv, "granted", newSVuv(pool->granted));
+    hv_stores(hv, "failures", newSVuv(pool->failures));
+    hv_stores(hv, "lost", newSVuv(pool->lost));
+    RETVAL = newRV_noinc((SV *)hv);
+}
+OUTPUT:
+    RETVAL
+
+void
+ev_etcd_lease_pool_DESTROY(pool)
+    EV::Etcd::LeasePool pool
+CODE:
+    lease_pool_free(aTHX_ pool);
+
+MODULE = EV::Etcd  PACKAGE = EV::Etcd::Call  PREFIX = ev_etcd_call_
+
+int
+ev_etcd_call_cancel(handle)
+    EV::Etcd::Call handle
+CODE:
+{
+    pending_call_t *pc = handle->pc;
+    RETVAL = 0;
+    if (pc && pc->callers) {
+        /* Shared read: the RPC goes on while other callers wait for it */
+        RETVAL = shared_call_detach(aTHX_ pc, handle->slot);
+        if (!RETVAL || pc->live_callers > 0) {
+            pc = NULL;
+        }
+    }
+    if (pc && !pc->cancelled) {
+        pc->cancelled = 1;
+        if (pc->dedupe_key) {
+            dedupe_forget(aTHX_ pc);  /* nobody may join a cancelled read */
+        }
+        if (pc->call) {
+            grpc_call_cancel(pc->call, NULL);
+        } else {
+            /* Parked for re-authentication: fails instead of being replayed */
+            pc->status = GRPC_STATUS_CANCELLED;
+            grpc_slice_unref(pc->status_details);
+            pc->status_details = grpc_slice_from_static_string("Cancelled");
+        }
+        RETVAL = 1;
+    }
+}
+OUTPUT:
+    RETVAL
+
+int
+ev_etcd_call_active(handle)
+    EV::Etcd::Call handle
+CODE:
+    RETVAL = handle->pc != NULL;
+OUTPUT:
+    RETVAL
+
+void
+ev_etcd_call_DESTROY(handle)
+    EV::Etcd::Call handle
+CODE:
+{
+    if (handle->pc) {
+        call_handle_t **hp = &handle->pc->handle;
+        while (*hp && *hp != handle) {
+            hp = &(*hp)->next;
+        }
+        if (*hp) {
+            *hp = handle->next;
+        }
+    }
+    Safefree(handle);
+}
+
+MODULE = EV::Etcd  PACKAGE = EV::Etcd::Mirror  PREFIX = ev_etcd_mirror_
+
+EV::Etcd::Mirror
+ev_etcd_mirror_new(class, path)
+    const char *class
+    const char *path
+CODE:
+{
+    (void)class;
+    errno = 0;
+    RETVAL = shm_open_reader(path);
+    if (!RETVAL) {
+        croak("Cannot open shared mirror %s: %s", path,
+              errno ? Strerror(errno) : "not a mirror file");
+    }
+}
+OUTPUT:
+    RETVAL
+
+SV *
+ev_etcd_mirror_get(mirror, key)
+    EV::Etcd::Mirror mirror
+    SV *key
+CODE:
+{
+    STRLEN key_len;
+    const char *key_str = SvPV(key, key_len);
+    SV *value = shm_get(aTHX_ mirror, key_str, key_len);
+    RETVAL = value ? value : &PL_sv_undef;
+}
+OUTPUT:
+    RETVAL
+
+SV *
+ev_etcd_mirror_get_prefix(mirror, prefix)
+    EV::Etcd::Mirror mirror
+    SV *prefix
+CODE:
+{
+    STRLEN prefix_len;
+    const char *prefix_str = SvPV(prefix, prefix_len);
+    RETVAL = newRV_noinc((SV *)shm_get_prefix(aTHX_ mirror, prefix_str, prefix_len));
+}
+OUTPUT:
+    RETVAL
+
+IV
+ev_etcd_mirror_revision(mirror)
+    EV::Etcd::Mirror mirror
+CODE:
+    RETVAL = shm_revision(mirror);
+OUTPUT:
+    RETVAL
+
+UV
+ev_etcd_mirror_generation(mirror)
+    EV::Etcd::Mirror mirror
+CODE:
+    RETVAL = shm_generation(mirror);
+OUTPUT:
+    RETVAL
+
+int
+ev_etcd_mirror_ready(mirror)
+    EV::Etcd::Mirror mirror
+CODE:
+    RETVAL = shm_generation(mirror) > 0;
+OUTPUT:
+    RETVAL
+
+void
+ev_etcd_mirror_DESTROY(mirror)
+    EV::Etcd::Mirror mirror
+CODE:
+    shm_close(mirror);
+
 MODULE = EV::Etcd  PACKAGE = EV::Etcd  PREFIX = ev_etcd_
 
 void
 END()
 CODE:
-    grpc_shutdown();
+    /* A child that did not reinitialize leaves gRPC to the parent */
+    if (getpid() == grpc_owner_pid) {
+        grpc_shutdown();
+    }
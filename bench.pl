@@ -203,6 +203,59 @@ print "==================\n\n";
     EV::run(EV::RUN_ONCE);
 }
 
+# Benchmark 6: Watch event flood, MULTICALL delivery vs one call per response
+{
+    my $concurrency = $ENV{BENCH_CONCURRENCY} || 100;
+    print "6. Watch event flood ($iterations puts, concurrency=$concurrency)...\n";
+
+    for my $multicall (1, 0) {
+        my $watcher = EV::Etcd->new(
+            endpoints => ['127.0.0.1:2379'],
+            multicall => $multicall,
+        );
+        my $flood_prefix = "$prefix/flood$multicall/";
+        my ($events, $responses, $watch_ready) = (0, 0, 0);
+
+        my $watch = $watcher->watch($flood_prefix, { prefix => 1 }, sub {
+            my ($resp, $err) = @_;
+            return if $err;
+            $responses++;
+            $events += @{$resp->{events} || []};
+            $watch_ready = 1;
+            EV::break if $events >= $iterations;
+        });
+
+        my $wait_start = time();
+        while (!$watch_ready && (time() - $wait_start) < 2) {
+            EV::run(EV::RUN_ONCE);
+        }
+        $responses = 0;
+
+        my ($sent, $in_flight) = (0, 0);
+        my $start = time();
+        my $send_batch; $send_batch = sub {
+            while ($sent < $iterations && $in_flight < $concurrency) {
+                $sent++;
+                $in_flight++;
+                $client->put("$flood_prefix$sent", "v", sub {
+                    $in_flight--;
+                    $send_batch->();
+                });
+            }
+        };
+        $send_batch->();
+        EV::run;
+
+        my $elapsed = time() - $start;
+        printf "   multicall=%d: %d events in %d callbacks, %.3f sec, %.0f events/sec\n",
+            $multicall, $events, $responses, $elapsed, $events / $elapsed;
+
+        $watch->cancel(sub {});
+        EV::run(EV::RUN_ONCE);
+    }
+    print "\n";
+}
+
 # Cleanup
 print "Cleaning up...\n";
 $client->delete($prefix, { prefix => 1 }, sub {
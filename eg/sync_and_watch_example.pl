@@ -50,66 +50,51 @@ print "=== Client 1: Loading existing data and watching ===\n";
 
 my $subscriber = EV::Etcd->new(endpoints => ['127.0.0.1:2379']);
 my %local_cache;       # Local copy of the config branch
-my $watch_revision;    # Revision to start watching from
 my $watch_handle;
-my $load_done = 0;
 
-# Step 1: Load all existing data from the branch
-$subscriber->get($prefix, { prefix => 1 }, sub {
-    my ($resp, $err) = @_;
+# sync() pages through the branch at one revision, then watches from the
+# revision after it, so no update between load and watch is missed
+$watch_handle = $subscriber->sync($prefix, { page_size => 2 }, sub {
+    my ($chunk, $err) = @_;
     die "Load failed: $err->{message}" if $err;
 
-    print "Loaded " . scalar(@{$resp->{kvs} || []}) . " keys:\n";
-
-    for my $kv (@{$resp->{kvs} || []}) {
-        my $key = $kv->{key};
-        my $value = $kv->{value};
-        $local_cache{$key} = $value;
-        print "  $key = $value\n";
+    for my $kv (@{$chunk->{kvs}}) {
+        $local_cache{$kv->{key}} = $kv->{value};
+        print "  $kv->{key} = $kv->{value}\n";
     }
+    return if $chunk->{more};
 
-    # IMPORTANT: Start watching from the revision AFTER our get
-    # This ensures we don't miss any updates that happened during/after our get
-    $watch_revision = $resp->{header}{revision} + 1;
-    print "\nWill watch from revision: $watch_revision\n";
-
-    # Step 2: Start watching for changes from that revision
-    $watch_handle = $subscriber->watch($prefix, {
-        prefix        => 1,
-        start_revision => $watch_revision,
-    }, sub {
-        my ($resp, $err) = @_;
-        if ($err) {
-            print "Watch error: $err->{message}\n";
-            return;
-        }
+    print "Loaded " . scalar(keys %local_cache) . " keys at revision $chunk->{revision}\n";
+    print "\nNow watching for changes...\n";
+    EV::break;
+}, sub {
+    my ($resp, $err) = @_;
+    if ($err) {
+        print "Watch error: $err->{message}\n";
+        return;
+    }
 
-        my $events = $resp->{events} || [];
-        return unless @$events;  # Skip empty responses
+    my $events = $resp->{events} || [];
+    return unless @$events;  # Skip empty responses
 
-        print "\n--- Received " . scalar(@$events) . " update(s) ---\n";
+    print "\n--- Received " . scalar(@$events) . " update(s) ---\n";
 
-        for my $event (@$events) {
-            my $type = $event->{type} // 'PUT';
-            my $key = $event->{kv}{key};
-            my $value = $event->{kv}{value} // '';
-            my $mod_rev = $event->{kv}{mod_revision};
+    for my $event (@$events) {
+        my $type = $event->{type} // 'PUT';
+        my $key = $event->{kv}{key};
+        my $value = $event->{kv}{value} // '';
+        my $mod_rev = $event->{kv}{mod_revision};
 
-            if ($type eq 'DELETE') {
-                delete $local_cache{$key};
-                print "  DELETE: $key (rev $mod_rev)\n";
-            } else {
-                $local_cache{$key} = $value;
-                print "  PUT: $key = $value (rev $mod_rev)\n";
-            }
+        if ($type eq 'DELETE') {
+            delete $local_cache{$key};
+            print "  DELETE: $key (rev $mod_rev)\n";
+        } else {
+            $local_cache{$key} = $value;
+            print "  PUT: $key = $value (rev $mod_rev)\n";
         }
+    }
 
-        print "Local cache now has " . scalar(keys %local_cache) . " keys\n";
-    });
-
-    $load_done = 1;
-    print "\nNow watching for changes...\n";
-    EV::break;
+    print "Local cache now has " . scalar(keys %local_cache) . " keys\n";
 });
 
 my $t_load = EV::timer(5, 0, sub { die "Load timeout" });
@@ -0,0 +1,216 @@
+/*
+ * etcd_batch.c - Write batching (autobatch) for EV::Etcd
+ *
+ * With new(autobatch => ...), single-key puts and deletes are not sent on
+ * their own. Each is encoded as a RequestOp right away and appended to the
+ * client's open batch; the batch goes out as one Txn without compares
+ * when its timer fires (max_delay, 0 for the next loop iteration), when
+ * it holds max_ops writes, or before a write it cannot hold. The success
+ * branch of a TxnRequest is field 2, so the request is the encoded ops
+ * back to back.
+ *
+ * Each caller gets the result its own put or delete would have produced,
+ * taken from its ResponseOp with the Txn's header. A failed Txn fails
+ * every write in it, through a fan-out callback. So does a Txn that cannot
+ * be started, on the next loop iteration: flushing happens inside put,
+ * delete and the other write methods, which must not run callbacks.
+ *
+ * etcd rejects a Txn that writes a key twice, so a write to a key already
+ * in the batch sends the batch first.
+ */
+#define PERL_NO_GET_CONTEXT
+#include "EXTERN.h"
+#include "perl.h"
+#include "XSUB.h"
+#include "ppport.h"
+
+#include <EV/EVAPI.h>
+
+#include "etcd_common.h"
+#include "etcd_kv.h"
+#include "etcd_batch.h"
+
+/* Well under etcd's default request size limit of 1.5 MiB */
+#define WRITE_BATCH_MAX_BYTES (1024 * 1024)
+
+static void write_batch_timer_cb(struct ev_loop *loop, ev_timer *w, int revents) {
+    dTHX;
+    (void)loop;
+    (void)revents;
+
+    ev_etcd_t *client = (ev_etcd_t *)((char *)w - offsetof(ev_etcd_t, batch_timer));
+    int outer = client_pin(client);
+    write_batch_flush(aTHX_ client);
+    (void)client_unpin(client, outer);
+}
+
+/* A batch that could not be sent fails from the loop, like a failed Txn */
+static void write_batch_failed_cb(int revents, void *arg) {
+    dTHX;
+    SV *fanout = (SV *)arg;
+    (void)revents;
+
+    CALL_SIMPLE_ERROR_CALLBACK(fanout, "Failed to start gRPC call for batched writes");
+    SvREFCNT_dec(fanout);
+}
+
+void write_batch_init(ev_etcd_t *client) {
+    ev_timer_init(&client->batch_timer, write_batch_timer_cb, 0., 0.);
+}
+
+static void write_batch_free(pTHX_ write_batch_t *batch) {
+    SvREFCNT_dec(batch->ops);
+    SvREFCNT_dec((SV *)batch->callbacks);
+    SvREFCNT_dec((SV *)batch->keys);
+    Safefree(batch);
+}
+
+static void write_batch_add(pTHX_ ev_etcd_t *client, Etcdserverpb__RequestOp *op,
+                            const uint8_t *key, size_t key_len, SV *callback) {
+    write_batch_t *batch = client->batch;
+    size_t len = etcdserverpb__request_op__get_packed_size(op);
+
+    if (batch && (hv_exists(batch->keys, (const char *)key, key_len)
+                  || SvCUR(batch->ops) + len + 11 > WRITE_BATCH_MAX_BYTES)) {
+        write_batch_flush(aTHX_ client);
+        batch = NULL;
+    }
+    if (!batch) {
+        Newx(batch, 1, write_batch_t);
+        batch->ops = newSVpvs("");
+        batch->callbacks = newAV();
+        batch->keys = newHV();
+        client->batch = batch;
+        ev_timer_set(&client->batch_timer, client->batch_max_delay, 0.);
+        ev_timer_start(EV_DEFAULT, &client->batch_timer);
+    }
+
+    /* Field 2 (success), wire type 2, then the length as a varint */
+    uint8_t hdr[11];
+    size_t hdr_len = 0;
+    uint64_t v = len;
+    hdr[hdr_len++] = 0x12;
+    while (v >= 0x80) {
+        hdr[hdr_len++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    hdr[hdr_len++] = (uint8_t)v;
+
+    STRLEN cur = SvCUR(batch->ops);
+    char *buf = SvGROW(batch->ops, cur + hdr_len + len + 1);
+    memcpy(buf + cur, hdr, hdr_len);
+    etcdserverpb__request_op__pack(op, (uint8_t *)buf + cur + hdr_len);
+    SvCUR_set(batch->ops, cur + hdr_len + len);
+
+    av_push(batch->callbacks, newSVsv(callback));
+    (void)hv_store(batch->keys, (const char *)key, key_len, &PL_sv_yes, 0);
+
+    if (av_len(batch->callbacks) + 1 >= client->batch_max_ops) {
+        write_batch_flush(aTHX_ client);
+    }
+}
+
+void write_batch_put(pTHX_ ev_etcd_t *client, Etcdserverpb__PutRequest *req, SV *callback) {
+    Etcdserverpb__RequestOp op = ETCDSERVERPB__REQUEST_OP__INIT;
+    op.request_case = ETCDSERVERPB__REQUEST_OP__REQUEST_REQUEST_PUT;
+    op.request_put = req;
+    write_batch_add(aTHX_ client, &op, req->key.data, req->key.len, callback);
+}
+
+void write_batch_delete(pTHX_ ev_etcd_t *client, Etcdserverpb__DeleteRangeRequest *req,
+                        SV *callback) {
+    Etcdserverpb__RequestOp op = ETCDSERVERPB__REQUEST_OP__INIT;
+    op.request_case = ETCDSERVERPB__REQUEST_OP__REQUEST_REQUEST_DELETE_RANGE;
+    op.request_delete_range = req;
+    write_batch_add(aTHX_ client, &op, req->key.data, req->key.len, callback);
+}
+
+void write_batch_flush(pTHX_ ev_etcd_t *client) {
+    write_batch_t *batch = client->batch;
+    if (!batch) return;
+    client->batch = NULL;
+    ev_timer_stop(EV_DEFAULT, &client->batch_timer);
+
+    pending_call_t *pc;
+    INIT_PENDING_CALL(pc, CALL_TYPE_WRITE_BATCH, &PL_sv_undef, client);
+    SvREFCNT_dec(pc->callback);
+    pc->callers = batch->callbacks;
+    pc->callback = fanout_callback_new(aTHX_ batch->callbacks);
+    batch->callbacks = NULL;
+
+    grpc_slice req_slice = grpc_slice_from_copied_buffer(SvPVX(batch->ops), SvCUR(batch->ops));
+    write_batch_free(aTHX_ batch);
+    grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
+    grpc_slice_unref(req_slice);
+
+    grpc_call_error err = start_unary_call(client, pc, METHOD_KV_TXN, send_buffer);
+    if (err != GRPC_CALL_OK) {
+        /* Not from inside the put or delete that flushed the batch */
+        ev_once(EV_DEFAULT, -1, 0, 0., write_batch_failed_cb,
+                SvREFCNT_inc_simple_NN(pc->callback));
+        CLEANUP_PENDING_CALL_ON_ERROR(pc);
+    }
+}
+
+void write_batch_done(pTHX_ pending_call_t *pc, int success) {
+    if (!success) {
+        CALL_ERROR_CALLBACK(pc->callback, pc->status, pc->status_details, "grpc_call");
+        return;
+    }
+
+    BEGIN_RESPONSE_HANDLER(pc, "txn");
+
+    Etcdserverpb__TxnResponse *resp;
+    UNPACK_RESPONSE(pc, resp, etcdserverpb__txn_response__unpack);
+
+    size_t n = (size_t)(av_len(pc->callers) + 1);
+    if (resp->n_responses != n) {
+        etcdserverpb__txn_response__free_unpacked(resp, NULL);
+        CALL_SIMPLE_ERROR_CALLBACK(pc->callback, "Batched writes: response count mismatch");
+        return;
+    }
+
+    ENTER;
+    SAVETMPS;
+
+    /* Build every result before running any callback */
+    AV *results = (AV *)sv_2mortal((SV *)newAV());
+    av_extend(results, n - 1);
+    for (size_t i = 0; i < n; i++) {
+        Etcdserverpb__ResponseOp *op = resp->responses[i];
+        HV *result;
+        if (op->response_case == ETCDSERVERPB__RESPONSE_OP__RESPONSE_RESPONSE_PUT) {
+            result = put_result_hv(aTHX_ resp->header, op->response_put);
+        } else if (op->response_case == ETCDSERVERPB__RESPONSE_OP__RESPONSE_RESPONSE_DELETE_RANGE) {
+            result = delete_result_hv(aTHX_ resp->header, op->response_delete_range);
+        } else {
+            result = newHV();
+            add_header_to_hv(aTHX_ result, resp->header);
+        }
+        av_push(results, newRV_noinc((SV *)result));
+    }
+    etcdserverpb__txn_response__free_unpacked(resp, NULL);
+
+    /* Every write is answered, even if a callback before it dies */
+    SV *died = NULL;
+    for (size_t i = 0; i < n; i++) {
+        SV **cb = av_fetch(pc->callers, i, 0);
+        SV **result = av_fetch(results, i, 0);
+        if (!cb || !result) continue;
+        call_each_callback(aTHX_ *cb, *result, &PL_sv_undef, &died);
+    }
+
+    FREETMPS;
+    LEAVE;
+    if (died) {
+        croak_sv(sv_2mortal(died));
+    }
+}
+
+void write_batch_discard(pTHX_ ev_etcd_t *client) {
+    ev_timer_stop(EV_DEFAULT, &client->batch_timer);
+    if (client->batch) {
+        write_batch_free(aTHX_ client->batch);
+        client->batch = NULL;
+    }
+}
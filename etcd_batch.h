@@ -0,0 +1,25 @@
+/*
+ * etcd_batch.h - Write batching (autobatch) for EV::Etcd
+ */
+#ifndef ETCD_BATCH_H
+#define ETCD_BATCH_H
+
+#include "etcd_common.h"
+
+void write_batch_init(ev_etcd_t *client);
+
+/* Queue a write; the request is encoded at once and may be freed */
+void write_batch_put(pTHX_ ev_etcd_t *client, Etcdserverpb__PutRequest *req, SV *callback);
+void write_batch_delete(pTHX_ ev_etcd_t *client, Etcdserverpb__DeleteRangeRequest *req,
+                        SV *callback);
+
+/* Send the open batch now; called before any other write is sent */
+void write_batch_flush(pTHX_ ev_etcd_t *client);
+
+/* The batch's Txn completed, from process_grpc_event */
+void write_batch_done(pTHX_ pending_call_t *pc, int success);
+
+/* Client teardown and fork: drop queued writes without answering them */
+void write_batch_discard(pTHX_ ev_etcd_t *client);
+
+#endif /* ETCD_BATCH_H */
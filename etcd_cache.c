@@ -0,0 +1,648 @@
+/*
+ * etcd_cache.c - Watch-coherent client-side cache for EV::Etcd
+ *
+ * The snapshot pages and watch events are applied straight from the
+ * unpacked protobuf messages; no Perl result structures are built.
+ *
+ * With history => N the cache also keeps its keys in a sorted array of
+ * entries, each with its last N versions, for ordered and historical
+ * range reads. Snapshot pages arrive in key order and are appended; keys
+ * created later are inserted with a binary search and a memmove.
+ *
+ * With persist => $path the current contents are written to a file after
+ * each full load, on save() and on destruction. A new cache maps the file,
+ * restores it and watches from the saved revision instead of loading.
+ *
+ * With shared => $path the contents are also published to a shared
+ * mirror (etcd_shm.c) after changes, at most once per loop iteration.
+ */
+#define PERL_NO_GET_CONTEXT
+#include "EXTERN.h"
+#include "perl.h"
+#include "XSUB.h"
+#include "ppport.h"
+
+#include <EV/EVAPI.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "etcd_common.h"
+#include "etcd_cache.h"
+#include "etcd_shm.h"
+
+/* Sweep deleted keys once this many are held and they are a quarter of the index */
+#define CACHE_TOMBSTONE_SWEEP 64
+
+/* Bytewise key order, shorter key first on a common prefix */
+static int cache_key_cmp(const char *a, size_t a_len, const char *b, size_t b_len) {
+    int c = memcmp(a, b, a_len < b_len ? a_len : b_len);
+    if (c) return c;
+    return a_len < b_len ? -1 : a_len > b_len;
+}
+
+/* First position whose key is >= key */
+static size_t index_lower_bound(cache_index_t *idx, const char *key, size_t key_len) {
+    size_t lo = 0, hi = idx->len;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        cache_entry_t *e = idx->entries[mid];
+        if (cache_key_cmp(e->key, e->key_len, key, key_len) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static void index_insert(cache_index_t *idx, size_t pos, cache_entry_t *e) {
+    if (idx->len == idx->cap) {
+        idx->cap = idx->cap ? idx->cap * 2 : 64;
+        Renew(idx->entries, idx->cap, cache_entry_t *);
+    }
+    if (pos < idx->len) {
+        Move(idx->entries + pos, idx->entries + pos + 1, idx->len - pos, cache_entry_t *);
+    }
+    idx->entries[pos] = e;
+    idx->len++;
+}
+
+static void entry_free(pTHX_ cache_entry_t *e) {
+    for (size_t i = 0; i < e->n_versions; i++) {
+        if (e->versions[i].value) {
+            SvREFCNT_dec(e->versions[i].value);
+        }
+    }
+    Safefree(e->versions);
+    Safefree(e->key);
+    Safefree(e);
+}
+
+static cache_entry_t *entry_new(const char *key, size_t key_len, size_t history) {
+    cache_entry_t *e;
+    Newxz(e, 1, cache_entry_t);
+    Newx(e->key, key_len ? key_len : 1, char);
+    Copy(key, e->key, key_len, char);
+    e->key_len = key_len;
+    Newx(e->versions, history, cache_version_t);
+    return e;
+}
+
+void cache_index_clear(pTHX_ cache_index_t *idx) {
+    for (size_t i = 0; i < idx->len; i++) {
+        entry_free(aTHX_ idx->entries[i]);
+    }
+    Safefree(idx->entries);
+    idx->entries = NULL;
+    idx->len = idx->cap = 0;
+}
+
+/* Newest version of an entry is a delete */
+static int entry_deleted(cache_entry_t *e) {
+    return e->n_versions > 0 && !e->versions[e->n_versions - 1].value;
+}
+
+/*
+ * Append a version, dropping the oldest past the history limit. Once a
+ * version is dropped the key's state before its successor is unknown,
+ * which raises the floor.
+ */
+static void entry_push(pTHX_ etcd_cache_t *cache, cache_entry_t *e, cache_version_t *v) {
+    if (e->n_versions == cache->history) {
+        if (e->versions[0].value) {
+            SvREFCNT_dec(e->versions[0].value);
+        }
+        Move(e->versions + 1, e->versions, e->n_versions - 1, cache_version_t);
+        e->n_versions--;
+        int64_t known_from = e->n_versions ? e->versions[0].mod_revision : v->mod_revision;
+        if (known_from > cache->floor) {
+            cache->floor = known_from;
+        }
+    }
+    e->versions[e->n_versions++] = *v;
+}
+
+/* Drop deleted keys that no readable revision can still see */
+static void cache_sweep_tombstones(pTHX_ etcd_cache_t *cache) {
+    cache_index_t *idx = &cache->index;
+    size_t kept = 0;
+    for (size_t i = 0; i < idx->len; i++) {
+        cache_entry_t *e = idx->entries[i];
+        if (entry_deleted(e) && e->versions[e->n_versions - 1].mod_revision <= cache->floor) {
+            entry_free(aTHX_ e);
+            cache->tombstones--;
+        } else {
+            idx->entries[kept++] = e;
+        }
+    }
+    idx->len = kept;
+}
+
+/* Values are handed out without copying, so they must not be modified */
+static SV *cache_store_pvn(pTHX_ HV *hv, const char *key, size_t key_len,
+                           const char *value, size_t value_len) {
+    SV *sv = newSVpvn(value, value_len);
+    SvREADONLY_on(sv);
+    hv_store(hv, key, (I32)key_len, sv, 0);
+    return sv;
+}
+
+static SV *cache_store(pTHX_ HV *hv, Mvccpb__KeyValue *kv) {
+    return cache_store_pvn(aTHX_ hv, kv->key.data ? (const char *)kv->key.data : "", kv->key.len,
+                           kv->value.data ? (const char *)kv->value.data : "", kv->value.len);
+}
+
+static void version_from_kv(cache_version_t *v, Mvccpb__KeyValue *kv, SV *value) {
+    v->value = value;
+    v->mod_revision = kv->mod_revision;
+    v->create_revision = kv->create_revision;
+    v->version = kv->version;
+}
+
+/* One snapshot page; the current contents keep being served meanwhile */
+void cache_load_kvs(pTHX_ etcd_cache_t *cache, Mvccpb__KeyValue **kvs, size_t n_kvs) {
+    if (!cache->loading) {
+        cache->loading = newHV();
+    }
+    for (size_t i = 0; i < n_kvs; i++) {
+        SV *value = cache_store(aTHX_ cache->loading, kvs[i]);
+        if (cache->history) {
+            /* Pages come in key order: append */
+            Mvccpb__KeyValue *kv = kvs[i];
+            cache_entry_t *e = entry_new(kv->key.data ? (const char *)kv->key.data : "",
+                                         kv->key.len, cache->history);
+            version_from_kv(&e->versions[0], kv, SvREFCNT_inc_simple_NN(value));
+            e->n_versions = 1;
+            index_insert(&cache->loading_index, cache->loading_index.len, e);
+        }
+    }
+    cache->updated = ev_now(EV_DEFAULT);
+}
+
+/* Throw away a snapshot that was only partly loaded */
+void cache_load_discard(pTHX_ etcd_cache_t *cache) {
+    if (cache->loading) {
+        SvREFCNT_dec((SV *)cache->loading);
+        cache->loading = NULL;
+    }
+    cache_index_clear(aTHX_ &cache->loading_index);
+}
+
+static void cache_publish_cb(struct ev_loop *loop, ev_timer *w, int revents) {
+    dTHX;
+    (void)loop;
+    (void)revents;
+
+    etcd_cache_t *cache = (etcd_cache_t *)((char *)w - offsetof(etcd_cache_t, publish_timer));
+    cache->publish_pending = 0;
+    cache_publish(aTHX_ cache);
+}
+
+/* Write the contents to the shared mirror now */
+void cache_publish(pTHX_ etcd_cache_t *cache) {
+    if (!cache->shm || !cache->ready) return;
+    if (shm_publish(aTHX_ cache->shm, cache->data, cache->revision)) {
+        cache->publishes++;
+    } else {
+        cache->publish_failures++;
+    }
+}
+
+/* In a forked child: the mirror keeps its one writer, the parent */
+void cache_after_fork(pTHX_ etcd_cache_t *cache) {
+    if (!cache->shm) return;
+    ev_timer_stop(EV_DEFAULT, &cache->publish_timer);
+    cache->publish_pending = 0;
+    shm_close(cache->shm);
+    cache->shm = NULL;
+}
+
+/* Contents changed: publish on the next loop iteration, once per burst */
+static void cache_changed(pTHX_ etcd_cache_t *cache) {
+    if (!cache->shm || cache->publish_pending) return;
+    cache->publish_pending = 1;
+    ev_timer_init(&cache->publish_timer, cache_publish_cb, 0., 0.);
+    ev_timer_start(EV_DEFAULT, &cache->publish_timer);
+}
+
+static int cache_entry_cmp(const void *a, const void *b) {
+    const cache_entry_t *ea = *(cache_entry_t * const *)a;
+    const cache_entry_t *eb = *(cache_entry_t * const *)b;
+    return cache_key_cmp(ea->key, ea->key_len, eb->key, eb->key_len);
+}
+
+/* Snapshot complete: swap it in */
+void cache_loaded(pTHX_ etcd_cache_t *cache, int64_t revision) {
+    if (cache->data) {
+        SvREFCNT_dec((SV *)cache->data);
+    }
+    cache->data = cache->loading ? cache->loading : newHV();
+    cache->loading = NULL;
+    cache->revision = revision;
+    cache->ready = 1;
+    cache->loads++;
+    cache->updated = ev_now(EV_DEFAULT);
+
+    if (cache->history) {
+        cache_index_clear(aTHX_ &cache->index);
+        cache->index = cache->loading_index;
+        Zero(&cache->loading_index, 1, cache_index_t);
+        /* Nothing before the snapshot is known */
+        cache->floor = revision;
+        cache->tombstones = 0;
+    }
+
+    if (cache->persist_path) {
+        (void)cache_save(aTHX_ cache);
+    }
+    cache_changed(aTHX_ cache);
+}
+
+/* Record one event in the ordered index */
+static void cache_index_event(pTHX_ etcd_cache_t *cache, Mvccpb__Event *ev, SV *value) {
+    Mvccpb__KeyValue *kv = ev->kv;
+    const char *key = kv->key.data ? (const char *)kv->key.data : "";
+    cache_index_t *idx = &cache->index;
+    size_t pos = index_lower_bound(idx, key, kv->key.len);
+    cache_entry_t *e = pos < idx->len
+        && cache_key_cmp(idx->entries[pos]->key, idx->entries[pos]->key_len, key, kv->key.len) == 0
+        ? idx->entries[pos] : NULL;
+
+    cache_version_t v;
+    if (ev->type == MVCCPB__EVENT__EVENT_TYPE__DELETE) {
+        if (!e || entry_deleted(e)) return;
+        Zero(&v, 1, cache_version_t);
+        v.mod_revision = kv->mod_revision;
+        entry_push(aTHX_ cache, e, &v);
+        cache->tombstones++;
+        return;
+    }
+
+    if (!e) {
+        e = entry_new(key, kv->key.len, cache->history);
+        index_insert(idx, pos, e);
+    } else if (entry_deleted(e)) {
+        cache->tombstones--;
+    }
+    version_from_kv(&v, kv, SvREFCNT_inc_simple_NN(value));
+    entry_push(aTHX_ cache, e, &v);
+}
+
+/* Apply a watch response; progress notifications only advance the revision */
+void cache_apply_response(pTHX_ etcd_cache_t *cache, Etcdserverpb__WatchResponse *resp) {
+    for (size_t i = 0; i < resp->n_events; i++) {
+        Mvccpb__Event *ev = resp->events[i];
+        Mvccpb__KeyValue *kv = ev->kv;
+        SV *value = NULL;
+        if (!kv) continue;
+        if (ev->type == MVCCPB__EVENT__EVENT_TYPE__DELETE) {
+            hv_delete(cache->data, kv->key.data ? (const char *)kv->key.data : "",
+                      (I32)kv->key.len, G_DISCARD);
+        } else {
+            value = cache_store(aTHX_ cache->data, kv);
+        }
+        if (cache->history) {
+            cache_index_event(aTHX_ cache, ev, value);
+        }
+    }
+    if (resp->header && resp->header->revision > cache->revision) {
+        cache->revision = resp->header->revision;
+    }
+    cache->updated = ev_now(EV_DEFAULT);
+
+    if (cache->tombstones >= CACHE_TOMBSTONE_SWEEP && cache->tombstones * 4 >= cache->index.len) {
+        cache_sweep_tombstones(aTHX_ cache);
+    }
+    /* Progress notifications only move the revision; not worth a rewrite */
+    if (resp->n_events > 0) {
+        cache_changed(aTHX_ cache);
+    }
+}
+
+/* True if key lies under the cached prefix */
+int cache_covers(etcd_cache_t *cache, const char *key, size_t key_len) {
+    return key_len >= cache->prefix_len
+        && memcmp(key, cache->prefix, cache->prefix_len) == 0;
+}
+
+/* Stored value for key, or NULL; counts the hit or miss */
+SV *cache_lookup(pTHX_ etcd_cache_t *cache, const char *key, size_t key_len) {
+    SV **svp = cache->ready ? hv_fetch(cache->data, key, (I32)key_len, 0) : NULL;
+    if (svp) {
+        cache->hits++;
+        return *svp;
+    }
+    cache->misses++;
+    return NULL;
+}
+
+/* key => value for every cached key under prefix */
+HV *cache_lookup_prefix(pTHX_ etcd_cache_t *cache, const char *prefix, size_t prefix_len) {
+    HV *result = newHV();
+    if (!cache->ready) {
+        cache->misses++;
+        return result;
+    }
+    cache->hits++;
+
+    /* The ordered index visits only the matching run */
+    if (cache->history) {
+        cache_index_t *idx = &cache->index;
+        for (size_t i = index_lower_bound(idx, prefix, prefix_len); i < idx->len; i++) {
+            cache_entry_t *e = idx->entries[i];
+            if (e->key_len < prefix_len || memcmp(e->key, prefix, prefix_len) != 0) break;
+            if (entry_deleted(e)) continue;
+            hv_store(result, e->key, (I32)e->key_len,
+                     newSVsv(e->versions[e->n_versions - 1].value), 0);
+        }
+        return result;
+    }
+
+    HE *he;
+    hv_iterinit(cache->data);
+    while ((he = hv_iternext(cache->data))) {
+        I32 klen;
+        char *k = hv_iterkey(he, &klen);
+        if ((size_t)klen >= prefix_len && memcmp(k, prefix, prefix_len) == 0) {
+            hv_store(result, k, klen, newSVsv(hv_iterval(cache->data, he)), 0);
+        }
+    }
+    return result;
+}
+
+/* A key's version visible at revision, or NULL if absent then */
+static cache_version_t *entry_at(cache_entry_t *e, int64_t revision) {
+    for (size_t i = e->n_versions; i > 0; i--) {
+        cache_version_t *v = &e->versions[i - 1];
+        if (v->mod_revision <= revision) {
+            return v->value ? v : NULL;
+        }
+    }
+    return NULL;
+}
+
+typedef struct {
+    cache_entry_t *entry;
+    cache_version_t *version;
+} cache_hit_t;
+
+static int cache_hit_by_mod_revision(const void *a, const void *b) {
+    int64_t ra = ((const cache_hit_t *)a)->version->mod_revision;
+    int64_t rb = ((const cache_hit_t *)b)->version->mod_revision;
+    return ra < rb ? -1 : ra > rb;
+}
+
+static int cache_hit_by_create_revision(const void *a, const void *b) {
+    int64_t ra = ((const cache_hit_t *)a)->version->create_revision;
+    int64_t rb = ((const cache_hit_t *)b)->version->create_revision;
+    return ra < rb ? -1 : ra > rb;
+}
+
+/*
+ * Keys in [start, end) as of revision, as an array of kv hashes. The
+ * caller has checked floor <= revision <= cache->revision. end_len 0
+ * means no upper bound.
+ */
+AV *cache_range(pTHX_ etcd_cache_t *cache, const char *start, size_t start_len,
+                const char *end, size_t end_len, int64_t revision,
+                cache_sort_t sort, int descend, size_t limit) {
+    cache_index_t *idx = &cache->index;
+    cache_hit_t *hits;
+    size_t n = 0;
+    size_t first = index_lower_bound(idx, start, start_len);
+
+    Newx(hits, idx->len - first + 1, cache_hit_t);
+    for (size_t i = first; i < idx->len; i++) {
+        cache_entry_t *e = idx->entries[i];
+        if (end_len && cache_key_cmp(e->key, e->key_len, end, end_len) >= 0) break;
+        cache_version_t *v = entry_at(e, revision);
+        if (v) {
+            hits[n].entry = e;
+            hits[n].version = v;
+            n++;
+        }
+    }
+
+    if (sort == CACHE_SORT_MOD_REVISION) {
+        qsort(hits, n, sizeof(cache_hit_t), cache_hit_by_mod_revision);
+    } else if (sort == CACHE_SORT_CREATE_REVISION) {
+        qsort(hits, n, sizeof(cache_hit_t), cache_hit_by_create_revision);
+    }
+
+    size_t count = limit && limit < n ? limit : n;
+    AV *result = newAV();
+    av_extend(result, count ? count - 1 : 0);
+    for (size_t i = 0; i < count; i++) {
+        cache_hit_t *h = &hits[descend ? n - 1 - i : i];
+        HV *kv = newHV();
+        hv_stores(kv, "key", newSVpvn(h->entry->key, h->entry->key_len));
+        hv_stores(kv, "value", newSVsv(h->version->value));
+        hv_stores(kv, "create_revision", newSViv(h->version->create_revision));
+        hv_stores(kv, "mod_revision", newSViv(h->version->mod_revision));
+        hv_stores(kv, "version", newSViv(h->version->version));
+        av_push(result, newRV_noinc((SV *)kv));
+    }
+    Safefree(hits);
+    return result;
+}
+
+/*
+ * Warm-start file layout, native byte order (the file is a local cache,
+ * not an interchange format):
+ *
+ *   header:  magic[8] "EVETCDC2", revision i64, count u64, flags u64,
+ *            prefix_len u64, prefix
+ *   entries: key_len u32, value_len u32, create_revision i64, mod_revision i64,
+ *            version i64, key, value
+ *
+ * Entry revisions are only meaningful with CACHE_FILE_REVISIONS, which a
+ * cache with history needs.
+ */
+#define CACHE_FILE_MAGIC "EVETCDC2"
+#define CACHE_FILE_HEADER_LEN 40
+#define CACHE_FILE_REVISIONS 1
+
+typedef struct {
+    uint32_t key_len;
+    uint32_t value_len;
+    int64_t create_revision;
+    int64_t mod_revision;
+    int64_t version;
+} cache_file_entry_t;
+
+static int cache_write_entry(FILE *fp, const char *key, size_t key_len, const char *value,
+                             size_t value_len, int64_t create_revision, int64_t mod_revision,
+                             int64_t version) {
+    cache_file_entry_t fe;
+    fe.key_len = (uint32_t)key_len;
+    fe.value_len = (uint32_t)value_len;
+    fe.create_revision = create_revision;
+    fe.mod_revision = mod_revision;
+    fe.version = version;
+    return fwrite(&fe, sizeof(fe), 1, fp) == 1
+        && fwrite(key, 1, key_len, fp) == key_len
+        && fwrite(value, 1, value_len, fp) == value_len;
+}
+
+/*
+ * Write the current contents to a temporary file and rename it over the
+ * persist path. Returns 0 with errno set on failure.
+ */
+int cache_save(pTHX_ etcd_cache_t *cache) {
+    if (!cache->ready) {
+        errno = EAGAIN;
+        return 0;
+    }
+
+    size_t path_len = strlen(cache->persist_path);
+    char *tmp;
+    Newx(tmp, path_len + 32, char);
+    snprintf(tmp, path_len + 32, "%s.%ld.tmp", cache->persist_path, (long)getpid());
+
+    FILE *fp = fopen(tmp, "wb");
+    if (!fp) {
+        Safefree(tmp);
+        return 0;
+    }
+
+    uint64_t count = cache->history ? cache->index.len - cache->tombstones : HvUSEDKEYS(cache->data);
+    uint64_t flags = cache->history ? CACHE_FILE_REVISIONS : 0;
+    uint64_t prefix_len = cache->prefix_len;
+    int64_t revision = cache->revision;
+    int ok = fwrite(CACHE_FILE_MAGIC, 1, 8, fp) == 8
+        && fwrite(&revision, sizeof(revision), 1, fp) == 1
+        && fwrite(&count, sizeof(count), 1, fp) == 1
+        && fwrite(&flags, sizeof(flags), 1, fp) == 1
+        && fwrite(&prefix_len, sizeof(prefix_len), 1, fp) == 1
+        && fwrite(cache->prefix, 1, cache->prefix_len, fp) == cache->prefix_len;
+
+    if (cache->history) {
+        /* Newest version of each live key, in key order */
+        for (size_t i = 0; ok && i < cache->index.len; i++) {
+            cache_entry_t *e = cache->index.entries[i];
+            if (entry_deleted(e)) continue;
+            cache_version_t *v = &e->versions[e->n_versions - 1];
+            STRLEN value_len;
+            const char *value = SvPV(v->value, value_len);
+            ok = cache_write_entry(fp, e->key, e->key_len, value, value_len,
+                                   v->create_revision, v->mod_revision, v->version);
+        }
+    } else {
+        /* Revisions are only tracked with history */
+        HE *he;
+        hv_iterinit(cache->data);
+        while (ok && (he = hv_iternext(cache->data))) {
+            I32 key_len;
+            char *key = hv_iterkey(he, &key_len);
+            STRLEN value_len;
+            const char *value = SvPV(hv_iterval(cache->data, he), value_len);
+            ok = cache_write_entry(fp, key, (size_t)key_len, value, value_len, 0, 0, 0);
+        }
+    }
+
+    if (fclose(fp) != 0) {
+        ok = 0;
+    }
+    if (ok && rename(tmp, cache->persist_path) != 0) {
+        ok = 0;
+    }
+    if (!ok) {
+        int saved_errno = errno;
+        unlink(tmp);
+        errno = saved_errno;
+    } else {
+        cache->saved_revision = cache->revision;
+    }
+    Safefree(tmp);
+    return ok;
+}
+
+/*
+ * Map the persist file and load it as the cache contents. Returns 0,
+ * leaving the cache empty, if there is no usable file for this prefix
+ * (or, with history, one saved without revisions).
+ */
+int cache_restore(pTHX_ etcd_cache_t *cache) {
+    int fd = open(cache->persist_path, O_RDONLY);
+    if (fd < 0) return 0;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < CACHE_FILE_HEADER_LEN) {
+        close(fd);
+        return 0;
+    }
+    size_t size = (size_t)st.st_size;
+    const char *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return 0;
+
+    const char *p = map, *end = map + size;
+    int64_t revision;
+    uint64_t count, flags, prefix_len;
+    int ok = memcmp(p, CACHE_FILE_MAGIC, 8) == 0;
+    p += 8;
+    if (ok) {
+        memcpy(&revision, p, sizeof(revision)); p += sizeof(revision);
+        memcpy(&count, p, sizeof(count)); p += sizeof(count);
+        memcpy(&flags, p, sizeof(flags)); p += sizeof(flags);
+        memcpy(&prefix_len, p, sizeof(prefix_len)); p += sizeof(prefix_len);
+        ok = revision > 0
+            && (!cache->history || (flags & CACHE_FILE_REVISIONS))
+            && prefix_len == cache->prefix_len
+            && (size_t)(end - p) >= prefix_len
+            && memcmp(p, cache->prefix, prefix_len) == 0;
+        p += ok ? prefix_len : 0;
+    }
+
+    HV *data = newHV();
+    cache_index_t idx;
+    Zero(&idx, 1, cache_index_t);
+    for (uint64_t i = 0; ok && i < count; i++) {
+        cache_file_entry_t fe;
+        if ((size_t)(end - p) < sizeof(fe)) { ok = 0; break; }
+        memcpy(&fe, p, sizeof(fe));
+        p += sizeof(fe);
+        if ((size_t)(end - p) < (size_t)fe.key_len + fe.value_len) { ok = 0; break; }
+        const char *key = p, *value = p + fe.key_len;
+        p += (size_t)fe.key_len + fe.value_len;
+
+        SV *sv = cache_store_pvn(aTHX_ data, key, fe.key_len, value, fe.value_len);
+        if (cache->history) {
+            cache_entry_t *e = entry_new(key, fe.key_len, cache->history);
+            e->versions[0].value = SvREFCNT_inc_simple_NN(sv);
+            e->versions[0].create_revision = fe.create_revision;
+            e->versions[0].mod_revision = fe.mod_revision;
+            e->versions[0].version = fe.version;
+            e->n_versions = 1;
+            index_insert(&idx, idx.len, e);
+        }
+    }
+    munmap((void *)map, size);
+
+    if (!ok) {
+        SvREFCNT_dec((SV *)data);
+        cache_index_clear(aTHX_ &idx);
+        return 0;
+    }
+
+    /* Saved in key order; sorted anyway, as lookups rely on it */
+    if (idx.len > 1) {
+        qsort(idx.entries, idx.len, sizeof(cache_entry_t *), cache_entry_cmp);
+    }
+
+    cache->data = data;
+    cache->index = idx;
+    cache->revision = revision;
+    cache->floor = revision;
+    cache->saved_revision = revision;
+    cache->ready = 1;
+    cache->warm = 1;
+    cache->updated = ev_now(EV_DEFAULT);
+    cache_publish(aTHX_ cache);
+    return 1;
+}
@@ -0,0 +1,39 @@
+/*
+ * etcd_cache.h - Watch-coherent client-side cache for EV::Etcd
+ */
+#ifndef ETCD_CACHE_H
+#define ETCD_CACHE_H
+
+#include "etcd_common.h"
+
+/* Result order of cache_range */
+typedef enum {
+    CACHE_SORT_KEY = 0,
+    CACHE_SORT_MOD_REVISION,
+    CACHE_SORT_CREATE_REVISION
+} cache_sort_t;
+
+/* Fed by the cache's watch */
+void cache_load_kvs(pTHX_ etcd_cache_t *cache, Mvccpb__KeyValue **kvs, size_t n_kvs);
+void cache_loaded(pTHX_ etcd_cache_t *cache, int64_t revision);
+void cache_load_discard(pTHX_ etcd_cache_t *cache);
+void cache_apply_response(pTHX_ etcd_cache_t *cache, Etcdserverpb__WatchResponse *resp);
+void cache_index_clear(pTHX_ cache_index_t *idx);
+
+/* persist: warm-start file */
+int cache_save(pTHX_ etcd_cache_t *cache);
+int cache_restore(pTHX_ etcd_cache_t *cache);
+
+/* shared: publish to the mirror now */
+void cache_publish(pTHX_ etcd_cache_t *cache);
+void cache_after_fork(pTHX_ etcd_cache_t *cache);
+
+/* Reads */
+int cache_covers(etcd_cache_t *cache, const char *key, size_t key_len);
+SV *cache_lookup(pTHX_ etcd_cache_t *cache, const char *key, size_t key_len);
+HV *cache_lookup_prefix(pTHX_ etcd_cache_t *cache, const char *prefix, size_t prefix_len);
+AV *cache_range(pTHX_ etcd_cache_t *cache, const char *start, size_t start_len,
+                const char *end, size_t end_len, int64_t revision,
+                cache_sort_t sort, int descend, size_t limit);
+
+#endif /* ETCD_CACHE_H */
@@ -116,14 +116,262 @@ void add_header_to_hv(pTHX_ HV *result, Etcdserverpb__ResponseHeader *header) {
     hv_store(result, "header", 6, newRV_noinc((SV *)hv), 0);
 }
 
-/* Setup auth metadata for gRPC call */
+/* Parse the "format" option value */
+result_format_t parse_result_format(pTHX_ SV *sv) {
+    const char *name = SvPV_nolen(sv);
+    if (strEQ(name, "full")) return RESULT_FORMAT_FULL;
+    if (strEQ(name, "map")) return RESULT_FORMAT_MAP;
+    if (strEQ(name, "pairs")) return RESULT_FORMAT_PAIRS;
+    if (strEQ(name, "columns")) return RESULT_FORMAT_COLUMNS;
+    croak("unknown format '%s' (expected full, map, pairs or columns)", name);
+    return RESULT_FORMAT_FULL;  /* not reached */
+}
+
+/* New SV for a bytes field, "" for NULL data */
+#define BYTES_TO_SV(field) \
+    ((field).data ? newSVpvn((char *)(field).data, (field).len) : newSVpvn("", 0))
+
+/* Convert repeated KeyValue to the requested result format */
+SV* kvs_to_sv(pTHX_ Mvccpb__KeyValue **kvs, size_t n_kvs, result_format_t format) {
+    size_t i;
+
+    switch (format) {
+        case RESULT_FORMAT_MAP: {
+            HV *map = newHV();
+            for (i = 0; i < n_kvs; i++) {
+                hv_store(map, kvs[i]->key.data ? (char *)kvs[i]->key.data : "",
+                         (I32)kvs[i]->key.len, BYTES_TO_SV(kvs[i]->value), 0);
+            }
+            return newRV_noinc((SV *)map);
+        }
+        case RESULT_FORMAT_PAIRS: {
+            AV *pairs = newAV();
+            if (n_kvs > 0) {
+                av_extend(pairs, n_kvs * 2 - 1);
+            }
+            for (i = 0; i < n_kvs; i++) {
+                av_push(pairs, BYTES_TO_SV(kvs[i]->key));
+                av_push(pairs, BYTES_TO_SV(kvs[i]->value));
+            }
+            return newRV_noinc((SV *)pairs);
+        }
+        case RESULT_FORMAT_COLUMNS: {
+            HV *cols = newHV();
+            AV *keys = newAV();
+            AV *values = newAV();
+            AV *mod_revisions = newAV();
+            if (n_kvs > 0) {
+                av_extend(keys, n_kvs - 1);
+                av_extend(values, n_kvs - 1);
+                av_extend(mod_revisions, n_kvs - 1);
+            }
+            for (i = 0; i < n_kvs; i++) {
+                av_push(keys, BYTES_TO_SV(kvs[i]->key));
+                av_push(values, BYTES_TO_SV(kvs[i]->value));
+                av_push(mod_revisions, newSViv(kvs[i]->mod_revision));
+            }
+            hv_store(cols, "keys", 4, newRV_noinc((SV *)keys), 0);
+            hv_store(cols, "values", 6, newRV_noinc((SV *)values), 0);
+            hv_store(cols, "mod_revisions", 13, newRV_noinc((SV *)mod_revisions), 0);
+            return newRV_noinc((SV *)cols);
+        }
+        case RESULT_FORMAT_FULL:
+        default: {
+            AV *av = newAV();
+            if (n_kvs > 0) {
+                av_extend(av, n_kvs - 1);
+            }
+            for (i = 0; i < n_kvs; i++) {
+                av_push(av, kv_to_hashref(aTHX_ kvs[i]));
+            }
+            return newRV_noinc((SV *)av);
+        }
+    }
+}
+
+/*
+ * Convert repeated Event to the requested result format.
+ * In the compact formats a DELETE is represented by an undef value.
+ */
+SV* events_to_sv(pTHX_ Mvccpb__Event **events, size_t n_events, result_format_t format) {
+    size_t i;
+
+    switch (format) {
+        case RESULT_FORMAT_MAP: {
+            HV *map = newHV();
+            for (i = 0; i < n_events; i++) {
+                Mvccpb__KeyValue *kv = events[i]->kv;
+                if (!kv) continue;
+                hv_store(map, kv->key.data ? (char *)kv->key.data : "", (I32)kv->key.len,
+                         events[i]->type == MVCCPB__EVENT__EVENT_TYPE__DELETE
+                             ? newSV(0) : BYTES_TO_SV(kv->value), 0);
+            }
+            return newRV_noinc((SV *)map);
+        }
+        case RESULT_FORMAT_PAIRS: {
+            AV *pairs = newAV();
+            if (n_events > 0) {
+                av_extend(pairs, n_events * 2 - 1);
+            }
+            for (i = 0; i < n_events; i++) {
+                Mvccpb__KeyValue *kv = events[i]->kv;
+                if (!kv) continue;
+                av_push(pairs, BYTES_TO_SV(kv->key));
+                av_push(pairs, events[i]->type == MVCCPB__EVENT__EVENT_TYPE__DELETE
+                    ? newSV(0) : BYTES_TO_SV(kv->value));
+            }
+            return newRV_noinc((SV *)pairs);
+        }
+        case RESULT_FORMAT_COLUMNS: {
+            HV *cols = newHV();
+            AV *types = newAV();
+            AV *keys = newAV();
+            AV *values = newAV();
+            AV *mod_revisions = newAV();
+            if (n_events > 0) {
+                av_extend(types, n_events - 1);
+                av_extend(keys, n_events - 1);
+                av_extend(values, n_events - 1);
+                av_extend(mod_revisions, n_events - 1);
+            }
+            for (i = 0; i < n_events; i++) {
+                Mvccpb__KeyValue *kv = events[i]->kv;
+                int is_delete = events[i]->type == MVCCPB__EVENT__EVENT_TYPE__DELETE;
+                if (!kv) continue;
+                av_push(types, newSVpv(is_delete ? "DELETE" : "PUT", 0));
+                av_push(keys, BYTES_TO_SV(kv->key));
+                av_push(values, is_delete ? newSV(0) : BYTES_TO_SV(kv->value));
+                av_push(mod_revisions, newSViv(kv->mod_revision));
+            }
+            hv_store(cols, "types", 5, newRV_noinc((SV *)types), 0);
+            hv_store(cols, "keys", 4, newRV_noinc((SV *)keys), 0);
+            hv_store(cols, "values", 6, newRV_noinc((SV *)values), 0);
+            hv_store(cols, "mod_revisions", 13, newRV_noinc((SV *)mod_revisions), 0);
+            return newRV_noinc((SV *)cols);
+        }
+        case RESULT_FORMAT_FULL:
+        default: {
+            AV *av = newAV();
+            if (n_events > 0) {
+                av_extend(av, n_events - 1);
+            }
+            for (i = 0; i < n_events; i++) {
+                av_push(av, event_to_hashref(aTHX_ events[i]));
+            }
+            return newRV_noinc((SV *)av);
+        }
+    }
+}
+
+/*
+ * Append the events of src to dst, both built by events_to_sv with the
+ * same format. Arrays (full, pairs) are concatenated; hashes are merged
+ * key by key, concatenating array values (columns) and letting later
+ * scalar values win (map).
+ */
+void append_events_sv(pTHX_ SV *dst, SV *src) {
+    SV *d = SvRV(dst), *s = SvRV(src);
+
+    if (SvTYPE(d) == SVt_PVAV) {
+        AV *sav = (AV *)s;
+        SSize_t i, top = av_len(sav);
+        for (i = 0; i <= top; i++) {
+            SV **svp = av_fetch(sav, i, 0);
+            av_push((AV *)d, svp ? SvREFCNT_inc_simple_NN(*svp) : newSV(0));
+        }
+    } else {
+        HE *he;
+        hv_iterinit((HV *)s);
+        while ((he = hv_iternext((HV *)s))) {
+            SV *val = HeVAL(he);
+            HE *dhe = hv_fetch_ent((HV *)d, HeSVKEY_force(he), 0, HeHASH(he));
+            if (dhe && SvROK(HeVAL(dhe)) && SvROK(val)) {
+                append_events_sv(aTHX_ HeVAL(dhe), val);
+            } else {
+                hv_store_ent((HV *)d, HeSVKEY_force(he), SvREFCNT_inc_simple_NN(val), HeHASH(he));
+            }
+        }
+    }
+}
+
+/* Queue a stream result for delivery at the end of the current pass */
+void defer_stream_result(pTHX_ AV **deferred, HV *result) {
+    if (!*deferred) {
+        *deferred = newAV();
+    }
+    av_push(*deferred, newRV_noinc((SV *)result));
+}
+
+/*
+ * Call callback with ($result, undef) for each queued result, in order,
+ * then release the queue. Delivery stops once *active drops to 0 (the
+ * stream was cancelled from a callback); pass NULL to deliver everything,
+ * e.g. right before the stream's final error callback.
+ *
+ * With multicall set, a plain Perl sub receiving two or more results is
+ * entered once with MULTICALL and re-run per result. @_ is rebuilt in place and the sub's
+ * scope is unwound between runs, so each run sees fresh lexicals.
+ */
+void deliver_stream_results(pTHX_ SV *callback, AV *results, const int *active,
+                            int multicall) {
+    CV *cv = (SvROK(callback) && SvTYPE(SvRV(callback)) == SVt_PVCV)
+        ? (CV *)SvRV(callback) : NULL;
+
+    ENTER;
+    SAVETMPS;
+    SAVEFREESV((SV *)results);
+    SAVEFREESV(SvREFCNT_inc_simple_NN(callback));  /* callback may drop the stream */
+
+    if (multicall && cv && !CvISXSUB(cv) && av_len(results) > 0) {
+        dSP;
+        dMULTICALL;
+        U8 gimme = G_VOID;
+        AV *args = newAV();
+        I32 base_ix;
+
+        SAVEGENERICSV(GvAV(PL_defgv));
+        GvAV(PL_defgv) = args;
+
+        PUSH_MULTICALL(cv);
+        base_ix = PL_savestack_ix;
+        while ((!active || *active) && av_len(results) >= 0) {
+            av_clear(args);
+            av_push(args, av_shift(results));
+            av_push(args, newSV(0));
+            MULTICALL;
+            if (PL_savestack_ix > base_ix) {
+                leave_scope(base_ix);
+            }
+            FREETMPS;
+        }
+        POP_MULTICALL;
+    } else {
+        while ((!active || *active) && av_len(results) >= 0) {
+            SV *result = av_shift(results);
+            dSP;
+            ENTER; SAVETMPS; PUSHMARK(SP); EXTEND(SP, 2);
+            PUSHs(sv_2mortal(result));
+            PUSHs(&PL_sv_undef);
+            PUTBACK; call_sv(callback, G_DISCARD); FREETMPS; LEAVE;
+        }
+    }
+
+    FREETMPS;
+    LEAVE;
+}
+
+/*
+ * Setup auth metadata for gRPC call. The token slice is shared by
+ * reference, so attaching it costs a refcount bump rather than a copy.
+ */
 void setup_auth_metadata(ev_etcd_t *client, grpc_op *op, grpc_metadata *auth_md) {
-    if (client->auth_token && client->auth_token_len > 0) {
+    if (GRPC_SLICE_LENGTH(client->auth_token) > 0) {
         auth_md->key = grpc_slice_from_static_string("authorization");
-        auth_md->value = grpc_slice_from_copied_buffer(client->auth_token, client->auth_token_len);
+        auth_md->value = grpc_slice_ref(client->auth_token);
         op->data.send_initial_metadata.count = 1;
         op->data.send_initial_metadata.metadata = auth_md;
     } else {
+        auth_md->value = grpc_empty_slice();
         op->data.send_initial_metadata.count = 0;
         op->data.send_initial_metadata.metadata = NULL;
     }
@@ -131,9 +379,240 @@ void setup_auth_metadata(ev_etcd_t *client, grpc_op *op, grpc_metadata *auth_md)
 
 /* Cleanup auth metadata after call start */
 void cleanup_auth_metadata(ev_etcd_t *client, grpc_metadata *auth_md) {
-    if (client->auth_token && client->auth_token_len > 0) {
-        grpc_slice_unref(auth_md->value);
+    (void)client;
+    grpc_slice_unref(auth_md->value);
+}
+
+/*
+ * Replace the client's auth token. Calls already started keep their own
+ * reference to the old slice, so it is released rather than wiped here.
+ */
+void set_auth_token(ev_etcd_t *client, const char *token, size_t len) {
+    grpc_slice old = client->auth_token;
+    client->auth_token = len > 0 ? grpc_slice_from_copied_buffer(token, len) : grpc_empty_slice();
+    grpc_slice_unref(old);
+}
+
+/* Zero the contents of a raw byte buffer (credentials) before destroying it */
+void wipe_byte_buffer(grpc_byte_buffer *bb) {
+    if (bb->type != GRPC_BB_RAW) return;
+    for (size_t i = 0; i < bb->data.raw.slice_buffer.count; i++) {
+        grpc_slice *sl = &bb->data.raw.slice_buffer.slices[i];
+        memset(GRPC_SLICE_START_PTR(*sl), 0, GRPC_SLICE_LENGTH(*sl));
+    }
+}
+
+/*
+ * Copy a raw byte buffer into memory of its own. grpc_byte_buffer_copy
+ * shares the slices, so a copy in flight would be zeroed along with the
+ * original by wipe_byte_buffer.
+ */
+grpc_byte_buffer *copy_byte_buffer_bytes(grpc_byte_buffer *bb) {
+    size_t len = 0;
+    for (size_t i = 0; i < bb->data.raw.slice_buffer.count; i++) {
+        len += GRPC_SLICE_LENGTH(bb->data.raw.slice_buffer.slices[i]);
+    }
+
+    grpc_slice copy = grpc_slice_malloc(len);
+    uint8_t *dst = GRPC_SLICE_START_PTR(copy);
+    for (size_t i = 0; i < bb->data.raw.slice_buffer.count; i++) {
+        grpc_slice *sl = &bb->data.raw.slice_buffer.slices[i];
+        memcpy(dst, GRPC_SLICE_START_PTR(*sl), GRPC_SLICE_LENGTH(*sl));
+        dst += GRPC_SLICE_LENGTH(*sl);
+    }
+
+    grpc_byte_buffer *out = grpc_raw_byte_buffer_create(&copy, 1);
+    grpc_slice_unref(copy);
+    return out;
+}
+
+/*
+ * Create and start a unary call: send one message, receive one response.
+ * Consumes send_buffer. On success the call is linked into the client's
+ * pending list; on failure the caller still owns pc (use
+ * CLEANUP_PENDING_CALL_ON_ERROR) and gets the gRPC error code.
+ */
+grpc_call_error start_unary_call(ev_etcd_t *client, pending_call_t *pc,
+                                 grpc_slice method, grpc_byte_buffer *send_buffer) {
+    /* Per-call timeout, else the method's default, else the client's */
+    double timeout = pc->timeout;
+    if (timeout == 0) {
+        timeout = client->method_timeouts[pc->base.type];
+    }
+    if (timeout == 0) {
+        timeout = client->timeout_seconds;
+    }
+
+    /* Monotonic, so wall clock steps neither expire nor extend deadlines */
+    gpr_timespec deadline;
+    if (timeout < 0) {
+        deadline = gpr_inf_future(GPR_CLOCK_MONOTONIC);
+    } else {
+        deadline = gpr_time_add(
+            gpr_now(GPR_CLOCK_MONOTONIC),
+            gpr_time_from_micros((int64_t)(timeout * 1e6), GPR_TIMESPAN));
+    }
+
+    pc->call = grpc_channel_create_call(
+        client->channel,
+        NULL,  /* parent call */
+        GRPC_PROPAGATE_DEFAULTS,
+        client->cq,
+        method,
+        NULL,  /* host */
+        deadline,
+        NULL   /* reserved */
+    );
+
+    if (!pc->call) {
+        grpc_byte_buffer_destroy(send_buffer);
+        return GRPC_CALL_ERROR;
+    }
+
+    /* Keep the request (slice refs, no copy) so it can be replayed after re-auth */
+    if (client->auto_reauth && !pc->request) {
+        pc->request = grpc_byte_buffer_copy(send_buffer);
+        pc->method = method;
+    }
+
+    grpc_op ops[6] = {0};
+    grpc_metadata auth_md;
+
+    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
+    setup_auth_metadata(client, &ops[0], &auth_md);
+
+    ops[1].op = GRPC_OP_SEND_MESSAGE;
+    ops[1].data.send_message.send_message = send_buffer;
+
+    ops[2].op = GRPC_OP_SEND_CLOSE_FROM_CLIENT;
+
+    ops[3].op = GRPC_OP_RECV_INITIAL_METADATA;
+    ops[3].data.recv_initial_metadata.recv_initial_metadata = &pc->initial_metadata;
+
+    ops[4].op = GRPC_OP_RECV_MESSAGE;
+    ops[4].data.recv_message.recv_message = &pc->recv_buffer;
+
+    ops[5].op = GRPC_OP_RECV_STATUS_ON_CLIENT;
+    ops[5].data.recv_status_on_client.trailing_metadata = &pc->trailing_metadata;
+    ops[5].data.recv_status_on_client.status = &pc->status;
+    ops[5].data.recv_status_on_client.status_details = &pc->status_details;
+
+    grpc_call_error err = grpc_call_start_batch(pc->call, ops, 6, &pc->base, NULL);
+
+    cleanup_auth_metadata(client, &auth_md);
+    grpc_byte_buffer_destroy(send_buffer);
+
+    if (err == GRPC_CALL_OK) {
+        pc->next = client->pending_calls;
+        client->pending_calls = pc;
     }
+    return err;
+}
+
+/*
+ * Call one of several callbacks answering the same event, in its own
+ * scope. A callback that dies does not stop the others: the first error
+ * is kept in *died, for the caller to rethrow once every one has run.
+ */
+void call_each_callback(pTHX_ SV *cb, SV *res, SV *err, SV **died) {
+    dSP;
+    ENTER;
+    SAVETMPS;
+    PUSHMARK(SP);
+    EXTEND(SP, 2);
+    PUSHs(res);
+    PUSHs(err);
+    PUTBACK;
+    call_sv(cb, G_DISCARD | G_EVAL);
+    if (SvTRUE(ERRSV) && !*died) {
+        *died = newSVsv(ERRSV);
+    }
+    FREETMPS;
+    LEAVE;
+}
+
+/*
+ * One callback standing for several: an anonymous XSUB that calls every
+ * callback in callers with its own arguments, in order. An entry wrapped
+ * in an array ref has been detached (cancelled) and gets CANCELLED
+ * instead. Every caller is called even if one dies; the first error is
+ * rethrown afterwards. callers is owned by the returned code ref.
+ */
+static MGVTBL fanout_vtbl = { 0 };
+
+static XS(fanout_callback) {
+    dXSARGS;
+    MAGIC *mg = mg_findext((SV *)cv, PERL_MAGIC_ext, &fanout_vtbl);
+    AV *callers = (AV *)mg->mg_obj;
+    SV *result = items > 0 ? ST(0) : &PL_sv_undef;
+    SV *error = items > 1 ? ST(1) : &PL_sv_undef;
+    SV *cancelled = NULL;
+    SV *died = NULL;
+    SSize_t i;
+
+    for (i = 0; i <= av_len(callers); i++) {
+        SV **svp = av_fetch(callers, i, 0);
+        SV *cb, *res = result, *err = error;
+        if (!svp) continue;
+        cb = *svp;
+        if (FANOUT_CALLER_DETACHED(cb)) {
+            SV **inner = av_fetch((AV *)SvRV(cb), 0, 0);
+            if (!inner) continue;
+            cb = *inner;
+            if (!cancelled) {
+                cancelled = sv_2mortal(create_error_hv(aTHX_ GRPC_STATUS_CANCELLED,
+                    "Cancelled", 9, "grpc_call"));
+            }
+            res = &PL_sv_undef;
+            err = cancelled;
+        }
+
+        SvREFCNT_inc_simple_void_NN(cb);
+        call_each_callback(aTHX_ cb, res, err, &died);
+        SvREFCNT_dec(cb);
+    }
+    if (died) {
+        croak_sv(sv_2mortal(died));
+    }
+    XSRETURN_EMPTY;
+}
+
+SV *fanout_callback_new(pTHX_ AV *callers) {
+    CV *fanout = newXS(NULL, fanout_callback, __FILE__);
+    sv_magicext((SV *)fanout, (SV *)callers, PERL_MAGIC_ext, &fanout_vtbl, NULL, 0);
+    SvREFCNT_dec((SV *)callers);  /* now owned by the magic */
+    return newRV_noinc((SV *)fanout);
+}
+
+/*
+ * dedupe: stop new identical gets from joining pc. Only removes the
+ * inflight entry if it still names pc; a later call may have taken it.
+ */
+void dedupe_forget(pTHX_ pending_call_t *pc) {
+    HV *inflight = pc->client->inflight;
+    if (inflight) {
+        HE *he = hv_fetch_ent(inflight, pc->dedupe_key, 0, 0);
+        if (he && INT2PTR(pending_call_t *, SvIV(HeVAL(he))) == pc) {
+            (void)hv_delete_ent(inflight, pc->dedupe_key, G_DISCARD, 0);
+        }
+    }
+    SvREFCNT_dec(pc->dedupe_key);
+    pc->dedupe_key = NULL;
+}
+
+int client_pin(ev_etcd_t *client) {
+    int outer = client->in_callback;
+    client->in_callback = 1;
+    return outer;
+}
+
+int client_unpin(ev_etcd_t *client, int outer) {
+    client->in_callback = outer;
+    if (client->active) return 1;
+    if (!outer) {
+        Safefree(client);
+    }
+    return 0;
 }
 
 /*
@@ -186,6 +665,97 @@ grpc_slice METHOD_MAINTENANCE_HASH_KV;
 grpc_slice METHOD_MAINTENANCE_MOVE_LEADER;
 grpc_slice METHOD_AUTH_STATUS;
 
+/*
+ * Unary methods reachable through raw_call. Streaming methods (Watch,
+ * LeaseKeepAlive, Observe) are left out: a raw call is one message each way.
+ */
+static grpc_slice *const unary_method_slices[] = {
+    &METHOD_KV_RANGE, &METHOD_KV_PUT, &METHOD_KV_DELETE, &METHOD_KV_COMPACT, &METHOD_KV_TXN,
+    &METHOD_LEASE_GRANT, &METHOD_LEASE_REVOKE, &METHOD_LEASE_TTL, &METHOD_LEASE_LEASES,
+    &METHOD_MAINTENANCE_STATUS, &METHOD_MAINTENANCE_ALARM, &METHOD_MAINTENANCE_DEFRAGMENT,
+    &METHOD_MAINTENANCE_HASH_KV, &METHOD_MAINTENANCE_MOVE_LEADER,
+    &METHOD_AUTH_AUTHENTICATE, &METHOD_AUTH_USER_ADD, &METHOD_AUTH_USER_DELETE,
+    &METHOD_AUTH_USER_CHANGE_PASSWORD, &METHOD_AUTH_USER_GET, &METHOD_AUTH_USER_LIST,
+    &METHOD_AUTH_USER_GRANT_ROLE, &METHOD_AUTH_USER_REVOKE_ROLE, &METHOD_AUTH_ENABLE,
+    &METHOD_AUTH_DISABLE, &METHOD_AUTH_ROLE_ADD, &METHOD_AUTH_ROLE_DELETE, &METHOD_AUTH_ROLE_GET,
+    &METHOD_AUTH_ROLE_LIST, &METHOD_AUTH_ROLE_GRANT_PERM, &METHOD_AUTH_ROLE_REVOKE_PERM,
+    &METHOD_AUTH_STATUS,
+    &METHOD_LOCK, &METHOD_UNLOCK,
+    &METHOD_ELECTION_CAMPAIGN, &METHOD_ELECTION_PROCLAIM, &METHOD_ELECTION_LEADER,
+    &METHOD_ELECTION_RESIGN,
+    &METHOD_CLUSTER_MEMBER_ADD, &METHOD_CLUSTER_MEMBER_REMOVE, &METHOD_CLUSTER_MEMBER_UPDATE,
+    &METHOD_CLUSTER_MEMBER_LIST, &METHOD_CLUSTER_MEMBER_PROMOTE,
+    NULL
+};
+
+/*
+ * Find the cached slice for a unary method path such as
+ * "/etcdserverpb.KV/Range" (the leading slash is optional).
+ * Returns NULL for unknown or streaming methods.
+ */
+const grpc_slice *lookup_unary_method(const char *path, size_t path_len) {
+    if (path_len > 0 && path[0] == '/') {
+        path++;
+        path_len--;
+    }
+    for (size_t i = 0; unary_method_slices[i]; i++) {
+        const grpc_slice *m = unary_method_slices[i];
+        /* Cached slices all start with '/' */
+        if (GRPC_SLICE_LENGTH(*m) == path_len + 1 &&
+            memcmp(GRPC_SLICE_START_PTR(*m) + 1, path, path_len) == 0) {
+            return m;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Deliver a unary response as undecoded protobuf bytes: ($bytes, undef).
+ * An uncompressed single-slice buffer is copied straight into the SV,
+ * skipping the intermediate readall slice.
+ */
+void process_raw_response(pTHX_ pending_call_t *pc) {
+    SV *bytes;
+
+    if (pc->status != GRPC_STATUS_OK) {
+        CALL_ERROR_CALLBACK(pc->callback, pc->status, pc->status_details, "raw");
+        return;
+    }
+    if (!pc->recv_buffer) {
+        CALL_SIMPLE_ERROR_CALLBACK(pc->callback, "No response received");
+        return;
+    }
+
+    if (pc->recv_buffer->type == GRPC_BB_RAW &&
+        pc->recv_buffer->data.raw.compression == GRPC_COMPRESS_NONE &&
+        pc->recv_buffer->data.raw.slice_buffer.count == 1) {
+        grpc_slice *only = &pc->recv_buffer->data.raw.slice_buffer.slices[0];
+        bytes = newSVpvn((const char *)GRPC_SLICE_START_PTR(*only), GRPC_SLICE_LENGTH(*only));
+    } else {
+        grpc_byte_buffer_reader reader;
+        if (!grpc_byte_buffer_reader_init(&reader, pc->recv_buffer)) {
+            CALL_SIMPLE_ERROR_CALLBACK(pc->callback, "Failed to read response buffer");
+            return;
+        }
+        grpc_slice all = grpc_byte_buffer_reader_readall(&reader);
+        grpc_byte_buffer_reader_destroy(&reader);
+        bytes = newSVpvn((const char *)GRPC_SLICE_START_PTR(all), GRPC_SLICE_LENGTH(all));
+        grpc_slice_unref(all);
+    }
+
+    dSP;
+    ENTER;
+    SAVETMPS;
+    PUSHMARK(SP);
+    EXTEND(SP, 2);
+    mPUSHs(bytes);
+    PUSHs(&PL_sv_undef);
+    PUTBACK;
+    call_sv(pc->callback, G_DISCARD);
+    FREETMPS;
+    LEAVE;
+}
+
 /* Initialize all cached method slices - thread-safe via atomic flag */
 void init_method_slices(void) {
     static volatile int initialized = 0;
@@ -141,11 +141,32 @@ typedef enum {
     CALL_TYPE_DEFRAGMENT,
     CALL_TYPE_HASH_KV,
     CALL_TYPE_MOVE_LEADER,
-    CALL_TYPE_AUTH_STATUS
+    CALL_TYPE_AUTH_STATUS,
+    CALL_TYPE_RAW,            /* raw_call: any unary method, bytes in/out */
+    CALL_TYPE_REAUTH,         /* internal Authenticate issued by auto_reauth */
+    CALL_TYPE_WATCH_RESYNC,   /* internal Range paging a compacted watch's range */
+    CALL_TYPE_LEASE_STREAM_RECV, /* lease manager's keepalive stream: receive */
+    CALL_TYPE_LEASE_STREAM_SEND, /* lease manager's keepalive stream: send */
+    CALL_TYPE_LEASE_POOL_GRANT,  /* internal LeaseGrant refilling a lease pool */
+    CALL_TYPE_WRITE_BATCH,       /* internal Txn carrying autobatched writes */
+    CALL_TYPE_COUNT
 } call_type_t;
 
-/* Forward declaration */
+/* Forward declarations */
 struct ev_etcd_struct;
+struct etcd_cache;
+
+/*
+ * Result formats for range and watch responses (the "format" option).
+ * The compact formats are built directly from the protobuf response and
+ * skip the per-KV hashes of the default format.
+ */
+typedef enum {
+    RESULT_FORMAT_FULL = 0,  /* array of kv hashrefs (default) */
+    RESULT_FORMAT_MAP,       /* { key => value } */
+    RESULT_FORMAT_PAIRS,     /* [ key, value, key, value, ... ] */
+    RESULT_FORMAT_COLUMNS    /* { keys => [...], values => [...], mod_revisions => [...] } */
+} result_format_t;
 
 /*
  * Queued event structure for passing gRPC completions from
@@ -177,6 +198,23 @@ typedef struct pending_call {
     grpc_slice status_details;
     struct ev_etcd_struct *client;
     struct pending_call *next;
+    result_format_t format;      /* Format of kvs for range responses */
+    unsigned char *txn_formats;  /* Per-op formats for txn: success ops, then failure ops */
+    size_t txn_n_success;        /* Number of success ops (offset of failure formats) */
+    size_t txn_n_failure;        /* Number of failure ops */
+    int raw;                     /* Deliver undecoded response bytes */
+    grpc_byte_buffer *request;   /* Retained request for replay (auto_reauth) */
+    grpc_slice method;           /* Method of the retained request */
+    int reauth_attempted;        /* Already replayed once after re-authentication */
+    struct watch_call *watch;    /* Watch being resynced (CALL_TYPE_WATCH_RESYNC) */
+    struct lease_pool *pool;     /* Pool being refilled (CALL_TYPE_LEASE_POOL_GRANT) */
+    double sent_at;              /* lease_clock() at send, for lease calls */
+    double timeout;              /* Deadline in seconds: 0 the client's, < 0 none */
+    int cancelled;               /* Cancelled through its handle */
+    struct call_handle *handle;  /* EV::Etcd::Call handles handed out (list) */
+    SV *dedupe_key;              /* Key in client->inflight while joinable */
+    AV *callers;                 /* Fan-out callbacks, owned by callback */
+    int live_callers;            /* Shared read: callers not cancelled */
 } pending_call_t;
 
 /* Watch recovery parameters */
@@ -188,6 +226,11 @@ typedef struct watch_params {
     int64_t start_revision;
     int prev_kv;
     int progress_notify;
+    result_format_t format;
+    int batch;             /* Merge event responses drained in one pass */
+    size_t max_batch;      /* Cap on merged events per callback, 0 = none */
+    double coalesce;       /* Coalescing window in seconds, 0 = off */
+    int recover_compaction; /* Resync the range instead of failing on compaction */
 } watch_params_t;
 
 /* Watch structure (for streaming watch) */
@@ -208,6 +251,29 @@ typedef struct watch_call {
     int64_t last_revision;
     watch_params_t params;
     int reconnect_attempt;
+    AV *deferred;          /* Results held back until the end of the pass */
+    int delivering;        /* Nonzero while deferred results are delivered */
+    int cleanup_pending;   /* cleanup_watch requested during delivery */
+    HV *batch_hv;          /* Open batch: last deferred result, owned by deferred */
+    size_t batch_count;    /* Events merged into batch_hv so far */
+    ev_timer coalesce_timer;  /* Closes the coalescing window */
+    HV *coalesced;         /* key => newest packed mvccpb.Event in the window */
+    HV *coalesce_result;   /* Result under construction (header, watch_id) */
+    int paused;            /* pause() called: do not re-arm the receive */
+    int recv_parked;       /* Receive left unarmed (paused or over the mark) */
+    size_t max_pending_events; /* Auto-pause mark for held events, 0 = none */
+    size_t held_events;    /* Events deferred and not yet delivered */
+    HV *known;             /* key => mod_revision of keys reported (recover_compaction) */
+    int resyncing;         /* Re-reading the range after a compaction cancel */
+    int resync_phase;      /* 0: key scan, 1: changed values, 2: sync() snapshot */
+    int64_t resync_since;  /* Last revision seen before the compaction */
+    int64_t resync_revision; /* Revision the range is read at */
+    int64_t resync_compact;  /* compact_revision reported by the server */
+    HV *resync_seen;       /* key => mod_revision present at resync_revision */
+    SV *resync_events;     /* Synthetic events built so far */
+    SV *sync_callback;     /* sync(): receives snapshot chunks */
+    size_t page_size;      /* Keys per Range page, 0 = default */
+    struct etcd_cache *cache; /* cache(): feeds this cache instead of callbacks */
 } watch_call_t;
 
 /* Keepalive structure (for streaming lease keepalive) */
@@ -226,6 +292,10 @@ typedef struct keepalive_call {
     struct keepalive_call *next;
     int auto_reconnect;
     int reconnect_attempt;
+    AV *deferred;          /* Results held back until the end of the pass */
+    int delivering;        /* Nonzero while deferred results are delivered */
+    int cleanup_pending;   /* cleanup_keepalive requested during delivery */
+    double sent_at;        /* lease_clock() when the request went out */
 } keepalive_call_t;
 
 /* Election observe parameters for reconnection */
@@ -271,9 +341,14 @@ typedef struct ev_etcd_struct {
     observe_call_t *observes;
     int active;
     int in_callback;  /* Guard against freeing client during event processing */
-    char *auth_token;
-    size_t auth_token_len;
-    int timeout_seconds;
+    int multicall;    /* Deliver stream result bursts through MULTICALL */
+    grpc_slice auth_token;      /* Refcounted bearer token, empty slice if none */
+    int auto_reauth;            /* Re-authenticate and replay on UNAUTHENTICATED */
+    grpc_byte_buffer *reauth_request; /* Last successful AuthenticateRequest */
+    int reauth_in_flight;
+    pending_call_t *reauth_queue; /* Calls waiting for a fresh token (FIFO) */
+    double timeout_seconds;     /* Default unary deadline */
+    double method_timeouts[CALL_TYPE_COUNT]; /* Per-method: 0 unset, < 0 none */
 
     /* Multiple endpoints for failover */
     char **endpoints;
@@ -288,10 +363,217 @@ typedef struct ev_etcd_struct {
     int health_interval;
     int is_healthy;
     SV *health_callback;
+
+    /* Lease manager (lease_keep), created on first use */
+    struct lease_manager *lease_mgr;
+    struct lease_pool *lease_pools;  /* EV::Etcd::LeasePool objects */
+    double lease_margin;        /* Subtracted from lease_remaining estimates */
+
+    /* dedupe: identical gets in flight share one call */
+    int dedupe;
+    HV *inflight;               /* Request bytes => pending_call_t */
+
+    /* autobatch: puts and deletes of a tick sent as one Txn */
+    int batch_max_ops;          /* 0 when off */
+    double batch_max_delay;
+    struct write_batch *batch;  /* Writes waiting to be sent, or NULL */
+    ev_timer batch_timer;
+
+    /* Fork handling */
+    pid_t pid;                  /* Process the gRPC state belongs to */
+    int quiesced;               /* CQ thread stopped by atfork_prepare */
+    struct ev_etcd_struct *next_client; /* All live clients */
 } ev_etcd_t;
 
+/*
+ * Prepared request (EV::Etcd::Prepared): a get or put whose options were
+ * parsed and serialized once. Running it only wraps the cached slices in a
+ * byte buffer. For put, the value field (tag 2) is spliced in between
+ * the key (field 1) and the remaining option fields.
+ */
+typedef struct prepared_request {
+    ev_etcd_t *client;
+    SV *client_sv;           /* Referent of the client object, kept alive */
+    call_type_t type;        /* CALL_TYPE_RANGE or CALL_TYPE_PUT */
+    grpc_slice head;         /* Whole request (get) or key field (put) */
+    grpc_slice tail;         /* Fields after the value (put only) */
+    result_format_t format;  /* Result format for get */
+    int raw;                 /* Deliver undecoded response bytes */
+} prepared_request_t;
+
+/* One version of a key in a cache's history; value is NULL for a delete */
+typedef struct cache_version {
+    SV *value;
+    int64_t mod_revision;
+    int64_t create_revision;
+    int64_t version;
+} cache_version_t;
+
+/* A key and its recent versions, oldest first */
+typedef struct cache_entry {
+    char *key;
+    size_t key_len;
+    cache_version_t *versions;
+    size_t n_versions;
+} cache_entry_t;
+
+/* Entries sorted by key (bytewise, as etcd orders them) */
+typedef struct cache_index {
+    cache_entry_t **entries;
+    size_t len;
+    size_t cap;
+} cache_index_t;
+
+/* A mapped shared mirror file (see etcd_shm.c) */
+typedef struct etcd_shm {
+    char *map;
+    size_t size;
+    char *path;
+    int writer;              /* Mapped for publishing */
+} etcd_shm_t;
+
+/*
+ * Watch-coherent cache (EV::Etcd::Cache): a prefix loaded with sync() and
+ * kept current by its watch, read synchronously. The watch and the cache
+ * point at each other; whichever goes first clears the other's pointer.
+ */
+typedef struct etcd_cache {
+    ev_etcd_t *client;
+    SV *client_sv;           /* Referent of the client object, kept alive */
+    watch_call_t *wc;        /* Feeding watch, NULL once it has ended */
+    HV *data;                /* key => value at revision */
+    HV *loading;             /* Snapshot being paged in, swapped in when complete */
+    char *prefix;
+    size_t prefix_len;
+    int64_t revision;        /* Revision the contents reflect */
+    int ready;               /* A snapshot has been loaded */
+    UV hits;
+    UV misses;
+    UV loads;                /* Snapshots loaded (1 + reloads after compaction) */
+    ev_tstamp updated;       /* ev_now() of the last message from etcd */
+
+    /* history => N: ordered index with up to N versions per key */
+    size_t history;
+    cache_index_t index;
+    cache_index_t loading_index;
+    int64_t floor;           /* Oldest revision every key's state is known at */
+    size_t tombstones;       /* Entries whose newest version is a delete */
+
+    /* persist => $path: warm-start snapshot file */
+    char *persist_path;
+    int64_t saved_revision;  /* Revision of the last file written or restored */
+    int warm;                /* Restored from the file, watch not yet confirmed */
+
+    /* shared => $path: mirror published for other processes */
+    etcd_shm_t *shm;
+    ev_timer publish_timer;  /* Publishes once per loop iteration after changes */
+    int publish_pending;
+    UV publishes;
+    UV publish_failures;     /* Contents did not fit the mirror */
+} etcd_cache_t;
+
+/* Lease manager timer wheel: 256 slots of 0.25s, 64s per lap */
+#define LEASE_WHEEL_SLOTS 256
+#define LEASE_WHEEL_TICK 0.25
+
+/* A lease renewed by the client's lease manager */
+typedef struct managed_lease {
+    int64_t id;
+    int64_t ttl;             /* TTL from the last renewal, 0 while unknown */
+    double renewed_at;       /* Monotonic time the TTL was last reset */
+    double sent_at;          /* Oldest unanswered renewal, 0 if none */
+    SV *callback;            /* Called once if the lease is lost, may be NULL */
+    int queued;              /* Renewal waiting on the send queue */
+    grpc_status_code lost;   /* Why it was lost, once it was */
+    unsigned slot;           /* Timer wheel slot */
+    unsigned rounds;         /* Laps of the wheel left before it is due */
+    struct managed_lease *prev;
+    struct managed_lease *next;
+} managed_lease_t;
+
+/*
+ * One LeaseKeepAlive stream shared by all managed leases. A stream that
+ * fails is moved to the manager's closed list and freed once its last
+ * batch has completed; the next renewal opens a new one.
+ */
+typedef struct lease_stream {
+    call_base_t base;        /* Must be first: receives */
+    call_base_t send_base;   /* Sends */
+    grpc_call *call;
+    grpc_metadata_array initial_metadata;
+    grpc_byte_buffer *recv_buffer;
+    grpc_byte_buffer *send_buffer;  /* Message being sent, NULL when idle */
+    struct lease_manager *mgr;
+    struct lease_stream *next;      /* On mgr->closed */
+    int closed;              /* Failed, waiting for its batches */
+    int batches;             /* Batches in flight */
+} lease_stream_t;
+
+typedef struct lease_manager {
+    ev_etcd_t *client;
+    HV *leases;              /* packed id => managed_lease_t */
+    HV *known;               /* packed id => lease_note_t, leases seen here */
+    size_t known_sweep;      /* Notes kept before expired ones are swept */
+    managed_lease_t *wheel[LEASE_WHEEL_SLOTS];
+    unsigned wheel_pos;
+    ev_tstamp wheel_time;    /* ev_now() the current slot stands for */
+    ev_timer tick;           /* Runs while any lease is managed */
+    lease_stream_t *stream;
+    lease_stream_t *closed;  /* Failed streams with batches in flight */
+    int64_t *send_ids;       /* Renewals to send, in order */
+    size_t send_head;
+    size_t send_len;
+    size_t send_cap;
+    UV renewals;             /* Renewal responses received */
+    UV streams;              /* Streams opened */
+} lease_manager_t;
+
+/*
+ * Leases granted ahead of use (EV::Etcd::LeasePool). Idle leases sit in a
+ * ring and are renewed by the lease manager; taking one starts a grant to
+ * replace it.
+ */
+typedef struct lease_pool {
+    ev_etcd_t *client;       /* NULL once the client is gone */
+    SV *client_sv;           /* Referent of the client object, kept alive */
+    int64_t ttl;
+    size_t size;
+    int64_t *ids;            /* Idle leases, a ring of size entries */
+    size_t head;
+    size_t len;
+    size_t granting;         /* Grants in flight */
+    ev_timer retry_timer;    /* Refills again after a failed grant */
+    UV taken;
+    UV granted;
+    UV failures;             /* Grants that failed */
+    UV lost;                 /* Idle leases lost before being taken */
+    struct lease_pool *next; /* Client's pools */
+} lease_pool_t;
+
+/*
+ * autobatch: writes queued during one tick, encoded as the success ops of
+ * a TxnRequest without compares, so the request is just their bytes.
+ */
+typedef struct write_batch {
+    SV *ops;                 /* Encoded RequestOps, each as TxnRequest field 2 */
+    AV *callbacks;           /* One per op, in order */
+    HV *keys;                /* Keys written; a txn may touch each only once */
+} write_batch_t;
+
+/* Handle on a unary call (EV::Etcd::Call); pc is NULL once it completed */
+typedef struct call_handle {
+    pending_call_t *pc;
+    int slot;                    /* Caller index in a shared read's callers */
+    struct call_handle *next;    /* Other handles on the same call */
+} call_handle_t;
+
 typedef ev_etcd_t *EV__Etcd;
 typedef watch_call_t *EV__Etcd__Watch;
+typedef prepared_request_t *EV__Etcd__Prepared;
+typedef etcd_cache_t *EV__Etcd__Cache;
+typedef etcd_shm_t *EV__Etcd__Mirror;
+typedef lease_pool_t *EV__Etcd__LeasePool;
+typedef call_handle_t *EV__Etcd__Call;
 
 /* Initialize a call's base structure */
 static inline void init_call_functor(call_base_t *base, call_type_t type) {
@@ -316,9 +598,54 @@ SV* kv_to_hashref(pTHX_ Mvccpb__KeyValue *kv);
 SV* event_to_hashref(pTHX_ Mvccpb__Event *event);
 void add_header_to_hv(pTHX_ HV *result, Etcdserverpb__ResponseHeader *header);
 
+/* Result format helpers */
+result_format_t parse_result_format(pTHX_ SV *sv);
+SV* kvs_to_sv(pTHX_ Mvccpb__KeyValue **kvs, size_t n_kvs, result_format_t format);
+SV* events_to_sv(pTHX_ Mvccpb__Event **events, size_t n_events, result_format_t format);
+void append_events_sv(pTHX_ SV *dst, SV *src);
+
+/*
+ * Stream result delivery. Watch and keepalive results are queued on the
+ * stream during an event pass and handed to the callback at its end, so
+ * a burst of responses for one stream costs one callback frame.
+ */
+void defer_stream_result(pTHX_ AV **deferred, HV *result);
+void deliver_stream_results(pTHX_ SV *callback, AV *results, const int *active,
+                            int multicall);
+
 /* Auth metadata helpers */
 void setup_auth_metadata(ev_etcd_t *client, grpc_op *op, grpc_metadata *auth_md);
 void cleanup_auth_metadata(ev_etcd_t *client, grpc_metadata *auth_md);
+void set_auth_token(ev_etcd_t *client, const char *token, size_t len);
+void wipe_byte_buffer(grpc_byte_buffer *bb);
+grpc_byte_buffer *copy_byte_buffer_bytes(grpc_byte_buffer *bb);
+
+/* Raw passthrough: method lookup and undecoded response delivery */
+const grpc_slice *lookup_unary_method(const char *path, size_t path_len);
+void process_raw_response(pTHX_ pending_call_t *pc);
+
+/* Start a unary call (send one message, receive one response) */
+grpc_call_error start_unary_call(ev_etcd_t *client, pending_call_t *pc,
+                                 grpc_slice method, grpc_byte_buffer *send_buffer);
+
+/* One of several callbacks for one event; *died keeps the first error */
+void call_each_callback(pTHX_ SV *cb, SV *res, SV *err, SV **died);
+
+/* Code ref calling every callback in callers (takes the AV's reference) */
+SV *fanout_callback_new(pTHX_ AV *callers);
+#define FANOUT_CALLER_DETACHED(sv) (SvROK(sv) && SvTYPE(SvRV(sv)) == SVt_PVAV)
+
+/* dedupe: drop a call from client->inflight (also done by FREE_PENDING_CALL) */
+void dedupe_forget(pTHX_ pending_call_t *pc);
+
+/*
+ * Timer callbacks that reach user code pin the client the way
+ * cq_async_callback does. client_unpin returns 0 if DESTROY ran
+ * meanwhile; the struct is then freed (by the outermost pin) and nothing
+ * hanging off it may be touched.
+ */
+int client_pin(ev_etcd_t *client);
+int client_unpin(ev_etcd_t *client, int outer);
 
 /*
  * Cached gRPC method slices - static strings don't need ref counting
@@ -504,16 +831,10 @@ void init_method_slices(void);
     } while (0)
 
 /*
- * Cleanup a pending_call_t on error before it's added to the pending list.
- * Use this when grpc_call_start_batch fails.
- *
- * Usage:
- *   if (err != GRPC_CALL_OK) {
- *       CLEANUP_PENDING_CALL_ON_ERROR(pc);
- *       croak("Failed to start gRPC call: %d", err);
- *   }
+ * Free a pending_call_t and everything it owns. The call must already be
+ * unlinked from (or never added to) the client's pending list.
  */
-#define CLEANUP_PENDING_CALL_ON_ERROR(pc) \
+#define FREE_PENDING_CALL(pc) \
     do { \
         grpc_metadata_array_destroy(&(pc)->initial_metadata); \
         grpc_metadata_array_destroy(&(pc)->trailing_metadata); \
@@ -521,9 +842,26 @@ void init_method_slices(void);
         grpc_slice_unref((pc)->status_details); \
         if ((pc)->call) grpc_call_unref((pc)->call); \
         SvREFCNT_dec((pc)->callback); \
+        if ((pc)->txn_formats) Safefree((pc)->txn_formats); \
+        if ((pc)->request) grpc_byte_buffer_destroy((pc)->request); \
+        if ((pc)->dedupe_key) dedupe_forget(aTHX_ (pc)); \
+        { call_handle_t *_h; \
+          for (_h = (pc)->handle; _h; _h = _h->next) _h->pc = NULL; } \
         Safefree((pc)); \
     } while (0)
 
+/*
+ * Cleanup a pending_call_t on error before it's added to the pending list.
+ * Use this when grpc_call_start_batch fails.
+ *
+ * Usage:
+ *   if (err != GRPC_CALL_OK) {
+ *       CLEANUP_PENDING_CALL_ON_ERROR(pc);
+ *       croak("Failed to start gRPC call: %d", err);
+ *   }
+ */
+#define CLEANUP_PENDING_CALL_ON_ERROR(pc) FREE_PENDING_CALL(pc)
+
 /*
  * Helper macros for streaming call reconnection to reduce code triplication
  * across watch, keepalive, and observe reconnect functions.
@@ -604,4 +942,15 @@ void init_method_slices(void);
         grpc_slice_unref((call_ptr)->status_details); \
     } while (0)
 
+/*
+ * In a forked child: let go of a call inherited from the parent without
+ * touching it. Its gRPC objects belong to the parent's channel and are
+ * leaked on purpose; the rest of the struct is freed as usual.
+ */
+#define FORGET_INHERITED_CALL(call_ptr) \
+    do { \
+        (call_ptr)->call = NULL; \
+        (call_ptr)->recv_buffer = NULL; \
+    } while (0)
+
 #endif /* ETCD_COMMON_H */
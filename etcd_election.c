@@ -10,6 +10,8 @@
 #include "etcd_common.h"
 #include "etcd_election.h"
 
+static int observe_restart_stream(pTHX_ observe_call_t *oc);
+
 /* Helper to convert LeaderKey to hash */
 HV *leader_key_to_hv(pTHX_ V3electionpb__LeaderKey *lk) {
     if (!lk) return NULL;
@@ -205,6 +207,34 @@ int try_reconnect_observe(pTHX_ observe_call_t *oc) {
 
     oc->reconnect_attempt++;
 
+    return observe_restart_stream(aTHX_ oc);
+}
+
+/*
+ * In a forked child, after the client has a channel of its own: observe
+ * the election again, or with restore unset drop the stream without a
+ * callback.
+ */
+void observe_after_fork(pTHX_ observe_call_t *oc, int restore) {
+    FORGET_INHERITED_CALL(oc);
+    oc->reconnect_attempt = 0;
+
+    if (!restore || !oc->active) {
+        oc->active = 0;
+        cleanup_observe(aTHX_ oc);
+        return;
+    }
+
+    if (!observe_restart_stream(aTHX_ oc)) {
+        CALL_SIMPLE_ERROR_CALLBACK(oc->callback, "Observe restart after fork failed");
+        cleanup_observe(aTHX_ oc);
+    }
+}
+
+/* Replace the observe stream with a new one for the same election */
+static int observe_restart_stream(pTHX_ observe_call_t *oc) {
+    ev_etcd_t *client = oc->client;
+
     /* Cleanup and reinitialize streaming state */
     STREAMING_CALL_CLEANUP(oc);
     STREAMING_CALL_REINIT(oc);
@@ -18,6 +18,7 @@ void process_observe_response(pTHX_ observe_call_t *oc);
 void observe_rearm_recv(pTHX_ observe_call_t *oc);
 void cleanup_observe(pTHX_ observe_call_t *oc);
 int try_reconnect_observe(pTHX_ observe_call_t *oc);
+void observe_after_fork(pTHX_ observe_call_t *oc, int restore);
 
 /* Helper to convert LeaderKey to hash */
 HV *leader_key_to_hv(pTHX_ V3electionpb__LeaderKey *lk);
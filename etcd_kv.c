@@ -20,14 +20,7 @@ void process_range_response(pTHX_ pending_call_t *pc) {
     HV *result = newHV();
     add_header_to_hv(aTHX_ result, resp->header);
 
-    AV *kvs = newAV();
-    if (resp->n_kvs > 0) {
-        av_extend(kvs, resp->n_kvs - 1);
-    }
-    for (size_t i = 0; i < resp->n_kvs; i++) {
-        av_push(kvs, kv_to_hashref(aTHX_ resp->kvs[i]));
-    }
-    hv_store(result, "kvs", 3, newRV_noinc((SV *)kvs), 0);
+    hv_store(result, "kvs", 3, kvs_to_sv(aTHX_ resp->kvs, resp->n_kvs, pc->format), 0);
     hv_store(result, "more", 4, newSViv(resp->more), 0);
     hv_store(result, "count", 5, newSViv(resp->count), 0);
 
@@ -36,6 +29,39 @@ void process_range_response(pTHX_ pending_call_t *pc) {
     CALL_SUCCESS_CALLBACK(pc->callback, result);
 }
 
+/*
+ * put() result hash. header is passed separately: a write from a batched
+ * Txn takes the Txn's header.
+ */
+HV *put_result_hv(pTHX_ Etcdserverpb__ResponseHeader *header, Etcdserverpb__PutResponse *resp) {
+    HV *result = newHV();
+    add_header_to_hv(aTHX_ result, header);
+
+    if (resp->prev_kv) {
+        hv_store(result, "prev_kv", 7, kv_to_hashref(aTHX_ resp->prev_kv), 0);
+    }
+    return result;
+}
+
+/* delete() result hash, header as for put_result_hv */
+HV *delete_result_hv(pTHX_ Etcdserverpb__ResponseHeader *header,
+                     Etcdserverpb__DeleteRangeResponse *resp) {
+    HV *result = newHV();
+    add_header_to_hv(aTHX_ result, header);
+
+    hv_store(result, "deleted", 7, newSViv(resp->deleted), 0);
+
+    if (resp->n_prev_kvs > 0) {
+        AV *prev_kvs = newAV();
+        av_extend(prev_kvs, resp->n_prev_kvs - 1);
+        for (size_t i = 0; i < resp->n_prev_kvs; i++) {
+            av_push(prev_kvs, kv_to_hashref(aTHX_ resp->prev_kvs[i]));
+        }
+        hv_store(result, "prev_kvs", 8, newRV_noinc((SV *)prev_kvs), 0);
+    }
+    return result;
+}
+
 /* Process PutResponse and call Perl callback */
 void process_put_response(pTHX_ pending_call_t *pc) {
     BEGIN_RESPONSE_HANDLER(pc, "put");
@@ -43,12 +69,7 @@ void process_put_response(pTHX_ pending_call_t *pc) {
     Etcdserverpb__PutResponse *resp;
     UNPACK_RESPONSE(pc, resp, etcdserverpb__put_response__unpack);
 
-    HV *result = newHV();
-    add_header_to_hv(aTHX_ result, resp->header);
-
-    if (resp->prev_kv) {
-        hv_store(result, "prev_kv", 7, kv_to_hashref(aTHX_ resp->prev_kv), 0);
-    }
+    HV *result = put_result_hv(aTHX_ resp->header, resp);
 
     etcdserverpb__put_response__free_unpacked(resp, NULL);
 
@@ -62,19 +83,7 @@ void process_delete_response(pTHX_ pending_call_t *pc) {
     Etcdserverpb__DeleteRangeResponse *resp;
     UNPACK_RESPONSE(pc, resp, etcdserverpb__delete_range_response__unpack);
 
-    HV *result = newHV();
-    add_header_to_hv(aTHX_ result, resp->header);
-
-    hv_store(result, "deleted", 7, newSViv(resp->deleted), 0);
-
-    if (resp->n_prev_kvs > 0) {
-        AV *prev_kvs = newAV();
-        av_extend(prev_kvs, resp->n_prev_kvs - 1);
-        for (size_t i = 0; i < resp->n_prev_kvs; i++) {
-            av_push(prev_kvs, kv_to_hashref(aTHX_ resp->prev_kvs[i]));
-        }
-        hv_store(result, "prev_kvs", 8, newRV_noinc((SV *)prev_kvs), 0);
-    }
+    HV *result = delete_result_hv(aTHX_ resp->header, resp);
 
     etcdserverpb__delete_range_response__free_unpacked(resp, NULL);
 
@@ -12,4 +12,9 @@ void process_put_response(pTHX_ pending_call_t *pc);
 void process_delete_response(pTHX_ pending_call_t *pc);
 void process_compact_response(pTHX_ pending_call_t *pc);
 
+/* Result hashes of put() and delete(), also built for batched writes */
+HV *put_result_hv(pTHX_ Etcdserverpb__ResponseHeader *header, Etcdserverpb__PutResponse *resp);
+HV *delete_result_hv(pTHX_ Etcdserverpb__ResponseHeader *header,
+                     Etcdserverpb__DeleteRangeResponse *resp);
+
 #endif /* ETCD_KV_H */
@@ -11,6 +11,9 @@
 
 #include "etcd_common.h"
 #include "etcd_lease.h"
+#include "etcd_lease_mgr.h"
+
+static int keepalive_restart_stream(pTHX_ keepalive_call_t *kc);
 
 /* Process LeaseGrantResponse */
 void process_lease_grant_response(pTHX_ pending_call_t *pc) {
@@ -29,6 +32,7 @@ void process_lease_grant_response(pTHX_ pending_call_t *pc) {
     add_header_to_hv(aTHX_ result, resp->header);
     hv_store(result, "id", 2, newSViv(resp->id), 0);
     hv_store(result, "ttl", 3, newSViv(resp->ttl), 0);
+    lease_note(aTHX_ pc->client, resp->id, resp->ttl, pc->sent_at);
     etcdserverpb__lease_grant_response__free_unpacked(resp, NULL);
 
     CALL_SUCCESS_CALLBACK(pc->callback, result);
@@ -60,6 +64,7 @@ void process_lease_time_to_live_response(pTHX_ pending_call_t *pc) {
     hv_store(result, "id", 2, newSViv(resp->id), 0);
     hv_store(result, "ttl", 3, newSViv(resp->ttl), 0);
     hv_store(result, "granted_ttl", 11, newSViv(resp->grantedttl), 0);
+    lease_note(aTHX_ pc->client, resp->id, resp->ttl, pc->sent_at);
 
     if (resp->n_keys > 0) {
         AV *keys_av = newAV();
@@ -123,6 +128,7 @@ void keepalive_rearm_recv(pTHX_ keepalive_call_t *kc) {
     grpc_call_error err = grpc_call_start_batch(kc->call, &op, 1, &kc->base, NULL);
     if (err != GRPC_CALL_OK) {
         kc->active = 0;
+        keepalive_deliver_deferred(aTHX_ kc, 0);
         CALL_SIMPLE_ERROR_CALLBACK(kc->callback, "Keepalive rearm failed");
         cleanup_keepalive(aTHX_ kc);
     }
@@ -132,6 +138,13 @@ void keepalive_rearm_recv(pTHX_ keepalive_call_t *kc) {
 void cleanup_keepalive(pTHX_ keepalive_call_t *kc) {
     ev_etcd_t *client = kc->client;
 
+    /* Deferred results are being delivered; the delivering side frees it */
+    if (kc->delivering) {
+        kc->active = 0;
+        kc->cleanup_pending = 1;
+        return;
+    }
+
     keepalive_call_t **kp = &client->keepalives;
     while (*kp) {
         if (*kp == kc) {
@@ -151,18 +164,41 @@ void cleanup_keepalive(pTHX_ keepalive_call_t *kc) {
         grpc_call_unref(kc->call);
     }
     SvREFCNT_dec(kc->callback);
+    if (kc->deferred) {
+        SvREFCNT_dec((SV *)kc->deferred);
+    }
     Safefree(kc);
 }
 
+/*
+ * Hand results deferred during this pass to the callback. With only_active
+ * delivery stops once the keepalive is cancelled; otherwise everything is
+ * delivered, as needed right before the keepalive's final error callback.
+ */
+void keepalive_deliver_deferred(pTHX_ keepalive_call_t *kc, int only_active) {
+    AV *results = kc->deferred;
+    if (!results) return;
+
+    kc->deferred = NULL;
+    ev_etcd_t *client = kc->client;
+    kc->delivering++;
+    deliver_stream_results(aTHX_ kc->callback, results,
+                           only_active ? &kc->active : NULL, client->multicall);
+    if (!client->active) return;  /* destroyed from the callback, kc with it */
+    kc->delivering--;
+}
+
 /* Process LeaseKeepAliveResponse */
 void process_keepalive_response(pTHX_ keepalive_call_t *kc) {
     if (!kc->recv_buffer) {
+        keepalive_deliver_deferred(aTHX_ kc, 0);
         CALL_SIMPLE_ERROR_CALLBACK(kc->callback, "No keepalive response received");
         return;
     }
 
     grpc_byte_buffer_reader reader;
     if (!grpc_byte_buffer_reader_init(&reader, kc->recv_buffer)) {
+        keepalive_deliver_deferred(aTHX_ kc, 0);
         CALL_SIMPLE_ERROR_CALLBACK(kc->callback, "Failed to read keepalive response buffer");
         return;
     }
@@ -175,14 +211,17 @@ void process_keepalive_response(pTHX_ keepalive_call_t *kc) {
     grpc_slice_unref(slice);
 
     if (!resp) {
+        keepalive_deliver_deferred(aTHX_ kc, 0);
         CALL_SIMPLE_ERROR_CALLBACK(kc->callback, "Failed to parse keepalive response");
         return;
     }
 
     kc->reconnect_attempt = 0;
+    lease_note(aTHX_ kc->client, resp->id, resp->ttl, kc->sent_at);
 
     if (resp->ttl == 0) {
         kc->active = 0;
+        keepalive_deliver_deferred(aTHX_ kc, 0);
         CALL_SIMPLE_ERROR_CALLBACK(kc->callback, "Lease expired");
         etcdserverpb__lease_keep_alive_response__free_unpacked(resp, NULL);
         return;
@@ -194,7 +233,7 @@ void process_keepalive_response(pTHX_ keepalive_call_t *kc) {
     hv_store(result, "ttl", 3, newSViv(resp->ttl), 0);
     etcdserverpb__lease_keep_alive_response__free_unpacked(resp, NULL);
 
-    CALL_SUCCESS_CALLBACK(kc->callback, result);
+    defer_stream_result(aTHX_ &kc->deferred, result);
 }
 
 /* Try to reconnect a keepalive after stream ended */
@@ -211,6 +250,35 @@ int try_reconnect_keepalive(pTHX_ keepalive_call_t *kc) {
 
     kc->reconnect_attempt++;
 
+    return keepalive_restart_stream(aTHX_ kc);
+}
+
+/*
+ * In a forked child, after the client has a channel of its own: keep the
+ * lease alive from this process too, or with restore unset drop the
+ * keepalive without a callback.
+ */
+void keepalive_after_fork(pTHX_ keepalive_call_t *kc, int restore) {
+    FORGET_INHERITED_CALL(kc);
+    kc->reconnect_attempt = 0;
+
+    if (!restore || !kc->active || kc->lease_id <= 0) {
+        kc->active = 0;
+        cleanup_keepalive(aTHX_ kc);
+        return;
+    }
+
+    if (!keepalive_restart_stream(aTHX_ kc)) {
+        keepalive_deliver_deferred(aTHX_ kc, 0);
+        CALL_SIMPLE_ERROR_CALLBACK(kc->callback, "Keepalive restart after fork failed");
+        cleanup_keepalive(aTHX_ kc);
+    }
+}
+
+/* Replace the keepalive's stream with a new one for the same lease */
+static int keepalive_restart_stream(pTHX_ keepalive_call_t *kc) {
+    ev_etcd_t *client = kc->client;
+
     /* Cleanup and reinitialize streaming state */
     STREAMING_CALL_CLEANUP(kc);
     STREAMING_CALL_REINIT(kc);
@@ -243,6 +311,7 @@ int try_reconnect_keepalive(pTHX_ keepalive_call_t *kc) {
     STREAMING_CALL_SETUP_OPS(client, ops, auth_md, send_buffer, kc);
 
     init_call_functor(&kc->base, CALL_TYPE_LEASE_KEEPALIVE);
+    kc->sent_at = lease_clock();
     grpc_call_error err = grpc_call_start_batch(kc->call, ops, 4, &kc->base, NULL);
     cleanup_auth_metadata(client, &auth_md);
     grpc_byte_buffer_destroy(send_buffer);
@@ -0,0 +1,850 @@
+/*
+ * etcd_lease_mgr.c - Lease manager for EV::Etcd
+ *
+ * Leases handed to lease_keep are renewed over one LeaseKeepAlive stream
+ * per client. Each lease sits in a hashed timer wheel and comes due at a
+ * third of its TTL (with jitter), or at its local expiry deadline when
+ * renewals go unanswered. Renewals due together are queued and written
+ * back to back, buffered into as few writes as the transport allows.
+ *
+ * Expiry callbacks are only run after the manager's own state has been
+ * updated, since they may release leases or destroy the client.
+ *
+ * The manager also notes the TTL of every lease this client granted or
+ * renewed, stamped with the time its request went out. The server starts
+ * counting no earlier than that, so lease_remaining can answer locally
+ * without ever overestimating what is left.
+ */
+#define PERL_NO_GET_CONTEXT
+#include "EXTERN.h"
+#include "perl.h"
+#include "XSUB.h"
+#include "ppport.h"
+
+#include <EV/EVAPI.h>
+
+#include <math.h>
+#include <time.h>
+
+#include "etcd_common.h"
+#include "etcd_lease_mgr.h"
+
+/* Renewal interval while the TTL is unknown or the stream is down */
+#define LEASE_MGR_RETRY 1.0
+
+/* Notes kept before expired ones are swept out */
+#define LEASE_NOTES_MIN 64
+
+/* TTL of a lease as last seen by this client */
+typedef struct lease_note {
+    int64_t ttl;
+    double at;               /* Monotonic time the TTL was (re)started */
+} lease_note_t;
+
+static void lease_stream_send_next(pTHX_ lease_manager_t *mgr);
+static void lease_stream_close(lease_manager_t *mgr);
+
+/* Monotonic clock for TTL bookkeeping */
+double lease_clock(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* === Timer wheel === */
+
+static void wheel_unlink(lease_manager_t *mgr, managed_lease_t *ml) {
+    if (ml->prev) {
+        ml->prev->next = ml->next;
+    } else if (mgr->wheel[ml->slot] == ml) {
+        mgr->wheel[ml->slot] = ml->next;
+    }
+    if (ml->next) {
+        ml->next->prev = ml->prev;
+    }
+    ml->prev = ml->next = NULL;
+}
+
+static void wheel_link(lease_manager_t *mgr, managed_lease_t *ml, unsigned slot) {
+    ml->slot = slot;
+    ml->prev = NULL;
+    ml->next = mgr->wheel[slot];
+    if (ml->next) {
+        ml->next->prev = ml;
+    }
+    mgr->wheel[slot] = ml;
+}
+
+/* Make the lease due delay seconds from now */
+static void wheel_insert(lease_manager_t *mgr, managed_lease_t *ml, double delay) {
+    double ahead = ev_now(EV_DEFAULT) + delay - mgr->wheel_time;
+    double ticks_f = ceil(ahead / LEASE_WHEEL_TICK);
+    unsigned ticks = ticks_f < 1 ? 1 : ticks_f > (double)UINT_MAX ? UINT_MAX : (unsigned)ticks_f;
+
+    ml->rounds = (ticks - 1) / LEASE_WHEEL_SLOTS;
+    wheel_link(mgr, ml, (mgr->wheel_pos + ticks) % LEASE_WHEEL_SLOTS);
+}
+
+/* Next renewal: a third of the TTL, +-10%, never past the deadline */
+static double renewal_delay(managed_lease_t *ml, double now) {
+    if (ml->ttl <= 0) return LEASE_MGR_RETRY;
+
+    double delay = ml->ttl / 3.0 * (0.9 + 0.2 * ((double)rand() / RAND_MAX));
+    double left = ml->renewed_at + ml->ttl - now;
+    return delay < left ? delay : left;
+}
+
+/* === Lease table === */
+
+managed_lease_t *lease_mgr_find(pTHX_ lease_manager_t *mgr, int64_t id) {
+    SV **svp = hv_fetch(mgr->leases, (const char *)&id, sizeof(id), 0);
+    return svp ? INT2PTR(managed_lease_t *, SvIV(*svp)) : NULL;
+}
+
+static void lease_free(pTHX_ managed_lease_t *ml) {
+    if (ml->callback) {
+        SvREFCNT_dec(ml->callback);
+    }
+    Safefree(ml);
+}
+
+/* Take the lease out of the table and the wheel; the caller frees it */
+static void lease_detach(pTHX_ lease_manager_t *mgr, managed_lease_t *ml) {
+    wheel_unlink(mgr, ml);
+    (void)hv_delete(mgr->leases, (const char *)&ml->id, sizeof(ml->id), G_DISCARD);
+    if (HvUSEDKEYS(mgr->leases) == 0) {
+        ev_timer_stop(EV_DEFAULT, &mgr->tick);
+    }
+}
+
+/* Tell the owners of lost leases (chained through next), then free them */
+static void lease_report_lost(pTHX_ managed_lease_t *lost) {
+    while (lost) {
+        managed_lease_t *ml = lost;
+        lost = ml->next;
+        if (ml->callback) {
+            int server = ml->lost == GRPC_STATUS_NOT_FOUND;
+            dSP;
+            ENTER;
+            SAVETMPS;
+            PUSHMARK(SP);
+            EXTEND(SP, 2);
+            PUSHs(&PL_sv_undef);
+            PUSHs(sv_2mortal(server
+                ? create_error_hv(aTHX_ ml->lost, "Lease expired", 13, "lease")
+                : create_error_hv(aTHX_ ml->lost, "Lease expired without renewal", 29, "lease")));
+            PUTBACK;
+            call_sv(ml->callback, G_DISCARD);
+            FREETMPS;
+            LEAVE;
+        }
+        lease_free(aTHX_ ml);
+    }
+}
+
+static void lease_mark_lost(pTHX_ lease_manager_t *mgr, managed_lease_t *ml,
+                            grpc_status_code why, managed_lease_t **lost) {
+    lease_detach(aTHX_ mgr, ml);
+    lease_forget(aTHX_ mgr->client, ml->id);
+    ml->lost = why;
+    ml->next = *lost;
+    *lost = ml;
+}
+
+static void send_queue_push(lease_manager_t *mgr, managed_lease_t *ml) {
+    if (ml->queued) return;
+    if (mgr->send_head + mgr->send_len == mgr->send_cap) {
+        if (mgr->send_head > 0) {
+            Move(mgr->send_ids + mgr->send_head, mgr->send_ids, mgr->send_len, int64_t);
+            mgr->send_head = 0;
+        } else {
+            mgr->send_cap = mgr->send_cap ? mgr->send_cap * 2 : 16;
+            Renew(mgr->send_ids, mgr->send_cap, int64_t);
+        }
+    }
+    mgr->send_ids[mgr->send_head + mgr->send_len++] = ml->id;
+    ml->queued = 1;
+}
+
+/* A lease came due: renew it, or give it up once its deadline passed */
+static void lease_due(pTHX_ lease_manager_t *mgr, managed_lease_t *ml, double now,
+                      managed_lease_t **lost) {
+    if (ml->ttl > 0 && now >= ml->renewed_at + ml->ttl) {
+        lease_mark_lost(aTHX_ mgr, ml, GRPC_STATUS_UNAVAILABLE, lost);
+        return;
+    }
+    send_queue_push(mgr, ml);
+    wheel_insert(mgr, ml, renewal_delay(ml, now));
+}
+
+static void lease_mgr_tick_cb(struct ev_loop *loop, ev_timer *w, int revents) {
+    dTHX;
+    (void)loop;
+    (void)revents;
+
+    lease_manager_t *mgr = (lease_manager_t *)((char *)w - offsetof(lease_manager_t, tick));
+    ev_tstamp now = ev_now(EV_DEFAULT);
+    double mono = lease_clock();
+    managed_lease_t *lost = NULL;
+
+    /* Catch up on slots missed while the loop was busy */
+    while (mgr->wheel_time + LEASE_WHEEL_TICK <= now) {
+        mgr->wheel_time += LEASE_WHEEL_TICK;
+        mgr->wheel_pos = (mgr->wheel_pos + 1) % LEASE_WHEEL_SLOTS;
+
+        managed_lease_t *ml = mgr->wheel[mgr->wheel_pos];
+        mgr->wheel[mgr->wheel_pos] = NULL;
+        while (ml) {
+            managed_lease_t *next = ml->next;
+            ml->prev = ml->next = NULL;
+            if (ml->rounds > 0) {
+                ml->rounds--;
+                wheel_link(mgr, ml, mgr->wheel_pos);
+            } else {
+                lease_due(aTHX_ mgr, ml, mono, &lost);
+            }
+            ml = next;
+        }
+    }
+
+    lease_stream_send_next(aTHX_ mgr);
+
+    ev_etcd_t *client = mgr->client;
+    int outer = client_pin(client);
+    lease_report_lost(aTHX_ lost);
+    (void)client_unpin(client, outer);
+}
+
+lease_manager_t *lease_mgr_new(pTHX_ ev_etcd_t *client) {
+    lease_manager_t *mgr;
+    Newxz(mgr, 1, lease_manager_t);
+    mgr->client = client;
+    mgr->leases = newHV();
+    mgr->known = newHV();
+    mgr->known_sweep = LEASE_NOTES_MIN;
+    ev_timer_init(&mgr->tick, lease_mgr_tick_cb, LEASE_WHEEL_TICK, LEASE_WHEEL_TICK);
+    return mgr;
+}
+
+/* The client's manager, created on first use */
+lease_manager_t *lease_mgr_get(pTHX_ ev_etcd_t *client) {
+    if (!client->lease_mgr) {
+        client->lease_mgr = lease_mgr_new(aTHX_ client);
+    }
+    return client->lease_mgr;
+}
+
+/* === Local TTL estimates === */
+
+static lease_note_t *lease_note_find(pTHX_ lease_manager_t *mgr, int64_t id) {
+    SV **svp = hv_fetch(mgr->known, (const char *)&id, sizeof(id), 0);
+    return svp ? (lease_note_t *)SvPVX(*svp) : NULL;
+}
+
+/* Drop the notes of leases that have run out */
+static void lease_note_sweep(pTHX_ lease_manager_t *mgr, double now) {
+    HE *he;
+    hv_iterinit(mgr->known);
+    while ((he = hv_iternext(mgr->known))) {
+        lease_note_t *note = (lease_note_t *)SvPVX(HeVAL(he));
+        if (note->at + note->ttl <= now) {
+            (void)hv_delete(mgr->known, HeKEY(he), HeKLEN(he), G_DISCARD);
+        }
+    }
+    mgr->known_sweep = HvUSEDKEYS(mgr->known) * 2;
+    if (mgr->known_sweep < LEASE_NOTES_MIN) {
+        mgr->known_sweep = LEASE_NOTES_MIN;
+    }
+}
+
+/*
+ * The server reported ttl seconds left on a lease, in answer to a request
+ * sent at monotonic time at. A ttl of 0 or less means the lease is gone.
+ */
+void lease_note(pTHX_ ev_etcd_t *client, int64_t id, int64_t ttl, double at) {
+    if (ttl <= 0) {
+        lease_forget(aTHX_ client, id);
+        return;
+    }
+
+    lease_manager_t *mgr = lease_mgr_get(aTHX_ client);
+    lease_note_t *note = lease_note_find(aTHX_ mgr, id);
+    if (!note) {
+        lease_note_t fresh;
+        if (HvUSEDKEYS(mgr->known) >= mgr->known_sweep) {
+            lease_note_sweep(aTHX_ mgr, lease_clock());
+        }
+        fresh.ttl = ttl;
+        fresh.at = at;
+        (void)hv_store(mgr->known, (const char *)&id, sizeof(id),
+                       newSVpvn((const char *)&fresh, sizeof(fresh)), 0);
+        return;
+    }
+    /* Answers to requests sent earlier than the one noted tell nothing new */
+    if (at >= note->at) {
+        note->ttl = ttl;
+        note->at = at;
+    }
+}
+
+void lease_forget(pTHX_ ev_etcd_t *client, int64_t id) {
+    if (client->lease_mgr) {
+        (void)hv_delete(client->lease_mgr->known, (const char *)&id, sizeof(id), G_DISCARD);
+    }
+}
+
+/* Seconds left on a lease this client granted or renewed, -1 if unknown */
+double lease_estimate(pTHX_ ev_etcd_t *client, int64_t id) {
+    lease_manager_t *mgr = client->lease_mgr;
+    if (!mgr) return -1;
+
+    managed_lease_t *ml = lease_mgr_find(aTHX_ mgr, id);
+    if (ml && ml->ttl > 0) {
+        return lease_mgr_remaining(ml);
+    }
+
+    lease_note_t *note = lease_note_find(aTHX_ mgr, id);
+    if (!note) return -1;
+
+    double left = note->at + note->ttl - lease_clock();
+    return left > 0 ? left : 0;
+}
+
+/*
+ * Manage a lease. With the TTL known, the first renewal is a third of it
+ * away; otherwise it is sent right away and its response supplies the TTL.
+ * Managing a lease again replaces its callback.
+ */
+void lease_mgr_add(pTHX_ lease_manager_t *mgr, int64_t id, int64_t ttl, SV *callback) {
+    managed_lease_t *ml = lease_mgr_find(aTHX_ mgr, id);
+    double now = lease_clock();
+
+    if (ml) {
+        if (ml->callback) {
+            SvREFCNT_dec(ml->callback);
+        }
+        ml->callback = callback ? newSVsv(callback) : NULL;
+        return;
+    }
+
+    if (!ev_is_active(&mgr->tick)) {
+        mgr->wheel_time = ev_now(EV_DEFAULT);
+        ev_timer_set(&mgr->tick, LEASE_WHEEL_TICK, LEASE_WHEEL_TICK);
+        ev_timer_start(EV_DEFAULT, &mgr->tick);
+    }
+
+    Newxz(ml, 1, managed_lease_t);
+    ml->id = id;
+    ml->ttl = ttl > 0 ? ttl : 0;
+    ml->renewed_at = now;
+
+    /* A lease granted or renewed here already has a known deadline */
+    lease_note_t *note = lease_note_find(aTHX_ mgr, id);
+    if (note && note->at + note->ttl > now) {
+        if (ml->ttl == 0) {
+            ml->ttl = note->ttl;
+        }
+        ml->renewed_at = note->at;
+    }
+    ml->callback = callback ? newSVsv(callback) : NULL;
+    (void)hv_store(mgr->leases, (const char *)&id, sizeof(id), newSViv(PTR2IV(ml)), 0);
+
+    if (ml->ttl > 0) {
+        wheel_insert(mgr, ml, renewal_delay(ml, now));
+    } else {
+        send_queue_push(mgr, ml);
+        wheel_insert(mgr, ml, LEASE_MGR_RETRY);
+        lease_stream_send_next(aTHX_ mgr);
+    }
+}
+
+/* Stop renewing a lease; returns 0 if it was not managed */
+int lease_mgr_remove(pTHX_ lease_manager_t *mgr, int64_t id) {
+    managed_lease_t *ml = lease_mgr_find(aTHX_ mgr, id);
+    if (!ml) return 0;
+
+    /* It runs out from its last renewal; keep estimating that */
+    if (ml->ttl > 0) {
+        lease_note(aTHX_ mgr->client, id, ml->ttl, ml->renewed_at);
+    }
+    lease_detach(aTHX_ mgr, ml);
+    lease_free(aTHX_ ml);
+    return 1;
+}
+
+/* Seconds left on a managed lease, or -1 while its TTL is unknown */
+double lease_mgr_remaining(managed_lease_t *ml) {
+    if (ml->ttl <= 0) return -1;
+
+    double left = ml->renewed_at + ml->ttl - lease_clock();
+    return left > 0 ? left : 0;
+}
+
+/* === Keepalive stream === */
+
+static void lease_stream_free(lease_stream_t *s) {
+    if (s->call) {
+        grpc_call_unref(s->call);
+    }
+    grpc_metadata_array_destroy(&s->initial_metadata);
+    if (s->recv_buffer) {
+        grpc_byte_buffer_destroy(s->recv_buffer);
+    }
+    if (s->send_buffer) {
+        grpc_byte_buffer_destroy(s->send_buffer);
+    }
+    Safefree(s);
+}
+
+/* Detach a failed stream; it is freed once its batches complete */
+static void lease_stream_close(lease_manager_t *mgr) {
+    lease_stream_t *s = mgr->stream;
+    if (!s) return;
+
+    mgr->stream = NULL;
+    if (s->call) {
+        grpc_call_cancel(s->call, NULL);
+    }
+    if (s->batches == 0) {
+        lease_stream_free(s);
+        return;
+    }
+    s->closed = 1;
+    s->next = mgr->closed;
+    mgr->closed = s;
+}
+
+/* A closed stream's last batch completed */
+static void lease_stream_reap(lease_manager_t *mgr, lease_stream_t *s) {
+    lease_stream_t **sp = &mgr->closed;
+    while (*sp) {
+        if (*sp == s) {
+            *sp = s->next;
+            break;
+        }
+        sp = &(*sp)->next;
+    }
+    lease_stream_free(s);
+}
+
+static int lease_stream_recv(lease_stream_t *s) {
+    grpc_op op;
+    memset(&op, 0, sizeof(op));
+    op.op = GRPC_OP_RECV_MESSAGE;
+    op.data.recv_message.recv_message = &s->recv_buffer;
+
+    if (grpc_call_start_batch(s->call, &op, 1, &s->base, NULL) != GRPC_CALL_OK) {
+        return 0;
+    }
+    s->batches++;
+    return 1;
+}
+
+static lease_stream_t *lease_stream_open(lease_manager_t *mgr) {
+    ev_etcd_t *client = mgr->client;
+    lease_stream_t *s;
+
+    Newxz(s, 1, lease_stream_t);
+    init_call_functor(&s->base, CALL_TYPE_LEASE_STREAM_RECV);
+    init_call_functor(&s->send_base, CALL_TYPE_LEASE_STREAM_SEND);
+    grpc_metadata_array_init(&s->initial_metadata);
+
+    s->call = grpc_channel_create_call(
+        client->channel, NULL, GRPC_PROPAGATE_DEFAULTS,
+        client->cq, METHOD_LEASE_KEEPALIVE, NULL,
+        gpr_inf_future(GPR_CLOCK_REALTIME), NULL);
+    if (!s->call) {
+        lease_stream_free(s);
+        return NULL;
+    }
+
+    /* Headers out, then receive for as long as the stream lives */
+    grpc_op ops[3] = {0};
+    grpc_metadata auth_md;
+    ops[0].op = GRPC_OP_SEND_INITIAL_METADATA;
+    setup_auth_metadata(client, &ops[0], &auth_md);
+    ops[1].op = GRPC_OP_RECV_INITIAL_METADATA;
+    ops[1].data.recv_initial_metadata.recv_initial_metadata = &s->initial_metadata;
+    ops[2].op = GRPC_OP_RECV_MESSAGE;
+    ops[2].data.recv_message.recv_message = &s->recv_buffer;
+
+    grpc_call_error err = grpc_call_start_batch(s->call, ops, 3, &s->base, NULL);
+    cleanup_auth_metadata(client, &auth_md);
+    if (err != GRPC_CALL_OK) {
+        lease_stream_free(s);
+        return NULL;
+    }
+
+    s->batches = 1;
+    s->mgr = mgr;
+    mgr->stream = s;
+    mgr->streams++;
+    return s;
+}
+
+/* Send the next queued renewal, unless one is already on its way */
+static void lease_stream_send_next(pTHX_ lease_manager_t *mgr) {
+    lease_stream_t *s = mgr->stream;
+
+    while (mgr->send_len > 0) {
+        if (s && s->send_buffer) return;
+
+        int64_t id = mgr->send_ids[mgr->send_head];
+        managed_lease_t *ml = lease_mgr_find(aTHX_ mgr, id);
+        if (!ml) {
+            /* Released while queued */
+            mgr->send_head++;
+            mgr->send_len--;
+            continue;
+        }
+        if (!s && !(s = lease_stream_open(mgr))) {
+            return;  /* Retried on the next tick */
+        }
+        mgr->send_head++;
+        mgr->send_len--;
+        ml->queued = 0;
+        /* The oldest unanswered send: its answer may be the one to come */
+        if (ml->sent_at == 0) {
+            ml->sent_at = lease_clock();
+        }
+
+        Etcdserverpb__LeaseKeepAliveRequest req = ETCDSERVERPB__LEASE_KEEP_ALIVE_REQUEST__INIT;
+        req.id = id;
+        grpc_slice req_slice;
+        SERIALIZE_PROTOBUF_TO_SLICE(req_slice,
+            etcdserverpb__lease_keep_alive_request__get_packed_size,
+            etcdserverpb__lease_keep_alive_request__pack, &req);
+        s->send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
+        grpc_slice_unref(req_slice);
+
+        grpc_op op;
+        memset(&op, 0, sizeof(op));
+        op.op = GRPC_OP_SEND_MESSAGE;
+        op.data.send_message.send_message = s->send_buffer;
+        /* More renewals follow: let the transport coalesce the writes */
+        if (mgr->send_len > 0) {
+            op.flags = GRPC_WRITE_BUFFER_HINT;
+        }
+
+        if (grpc_call_start_batch(s->call, &op, 1, &s->send_base, NULL) != GRPC_CALL_OK) {
+            grpc_byte_buffer_destroy(s->send_buffer);
+            s->send_buffer = NULL;
+            lease_stream_close(mgr);
+            return;
+        }
+        s->batches++;
+        return;
+    }
+
+    if (mgr->send_len == 0) {
+        mgr->send_head = 0;
+    }
+}
+
+/* Apply one LeaseKeepAliveResponse */
+static void lease_stream_response(pTHX_ lease_manager_t *mgr, grpc_byte_buffer *buffer,
+                                  managed_lease_t **lost) {
+    grpc_byte_buffer_reader reader;
+    if (!grpc_byte_buffer_reader_init(&reader, buffer)) return;
+    grpc_slice slice = grpc_byte_buffer_reader_readall(&reader);
+    grpc_byte_buffer_reader_destroy(&reader);
+
+    Etcdserverpb__LeaseKeepAliveResponse *resp = etcdserverpb__lease_keep_alive_response__unpack(
+        NULL, GRPC_SLICE_LENGTH(slice), GRPC_SLICE_START_PTR(slice));
+    grpc_slice_unref(slice);
+    if (!resp) return;
+
+    managed_lease_t *ml = lease_mgr_find(aTHX_ mgr, resp->id);
+    if (ml) {
+        if (resp->ttl <= 0) {
+            lease_mark_lost(aTHX_ mgr, ml, GRPC_STATUS_NOT_FOUND, lost);
+        } else {
+            double now = lease_clock();
+            ml->ttl = resp->ttl;
+            ml->renewed_at = ml->sent_at > 0 ? ml->sent_at : now;
+            ml->sent_at = 0;
+            mgr->renewals++;
+            wheel_unlink(mgr, ml);
+            wheel_insert(mgr, ml, renewal_delay(ml, now));
+        }
+    }
+    etcdserverpb__lease_keep_alive_response__free_unpacked(resp, NULL);
+}
+
+/* Completion of a batch on a lease manager stream */
+void lease_mgr_process_event(pTHX_ call_base_t *base, int success) {
+    int is_send = base->type == CALL_TYPE_LEASE_STREAM_SEND;
+    lease_stream_t *s = is_send
+        ? (lease_stream_t *)((char *)base - offsetof(lease_stream_t, send_base))
+        : (lease_stream_t *)base;
+    lease_manager_t *mgr = s->mgr;
+    managed_lease_t *lost = NULL;
+
+    s->batches--;
+    if (s->closed) {
+        if (s->batches == 0) {
+            lease_stream_reap(mgr, s);
+        }
+        return;
+    }
+
+    if (is_send) {
+        grpc_byte_buffer_destroy(s->send_buffer);
+        s->send_buffer = NULL;
+        if (!success) {
+            lease_stream_close(mgr);
+            return;
+        }
+        lease_stream_send_next(aTHX_ mgr);
+        return;
+    }
+
+    /* A receive without a message is the end of the stream */
+    if (!success || !s->recv_buffer) {
+        lease_stream_close(mgr);
+        return;
+    }
+
+    lease_stream_response(aTHX_ mgr, s->recv_buffer, &lost);
+    grpc_byte_buffer_destroy(s->recv_buffer);
+    s->recv_buffer = NULL;
+    if (!lease_stream_recv(s)) {
+        lease_stream_close(mgr);
+    }
+
+    lease_report_lost(aTHX_ lost);
+}
+
+/* Client going away: cancel the stream so its batches complete */
+void lease_mgr_cancel(lease_manager_t *mgr) {
+    if (mgr->stream && mgr->stream->call) {
+        grpc_call_cancel(mgr->stream->call, NULL);
+    }
+    /* Closed streams were cancelled when they were closed */
+}
+
+/*
+ * In a forked child: the stream is the parent's and is left untouched.
+ * With restore the leases stay managed and the next renewal opens a new
+ * stream; otherwise they are dropped without a callback.
+ */
+void lease_mgr_after_fork(pTHX_ lease_manager_t *mgr, int restore) {
+    mgr->stream = NULL;
+    mgr->closed = NULL;
+
+    if (restore) return;
+
+    HE *he;
+    hv_iterinit(mgr->leases);
+    while ((he = hv_iternext(mgr->leases))) {
+        lease_free(aTHX_ INT2PTR(managed_lease_t *, SvIV(HeVAL(he))));
+    }
+    hv_clear(mgr->leases);
+    Zero(mgr->wheel, LEASE_WHEEL_SLOTS, managed_lease_t *);
+    mgr->send_head = mgr->send_len = 0;
+    ev_timer_stop(EV_DEFAULT, &mgr->tick);
+}
+
+/* Free everything; the completion queue is already drained or abandoned */
+void lease_mgr_free(pTHX_ lease_manager_t *mgr) {
+    ev_timer_stop(EV_DEFAULT, &mgr->tick);
+    if (mgr->stream) {
+        lease_stream_free(mgr->stream);
+    }
+    while (mgr->closed) {
+        lease_stream_t *next = mgr->closed->next;
+        lease_stream_free(mgr->closed);
+        mgr->closed = next;
+    }
+
+    HE *he;
+    hv_iterinit(mgr->leases);
+    while ((he = hv_iternext(mgr->leases))) {
+        lease_free(aTHX_ INT2PTR(managed_lease_t *, SvIV(HeVAL(he))));
+    }
+    SvREFCNT_dec((SV *)mgr->leases);
+    SvREFCNT_dec((SV *)mgr->known);
+    if (mgr->send_ids) {
+        Safefree(mgr->send_ids);
+    }
+    Safefree(mgr);
+}
+
+/* === Lease pool === */
+
+/* Seconds before refilling again after a failed grant */
+#define LEASE_POOL_RETRY 1.0
+
+static void lease_pool_retry_cb(struct ev_loop *loop, ev_timer *w, int revents) {
+    dTHX;
+    (void)loop;
+    (void)revents;
+
+    lease_pool_t *pool = (lease_pool_t *)((char *)w - offsetof(lease_pool_t, retry_timer));
+    ev_etcd_t *client = pool->client;
+    int outer = client_pin(client);
+    lease_pool_refill(aTHX_ pool);
+    (void)client_unpin(client, outer);
+}
+
+lease_pool_t *lease_pool_new(pTHX_ ev_etcd_t *client, SV *client_sv, int64_t ttl, size_t size) {
+    lease_pool_t *pool;
+    Newxz(pool, 1, lease_pool_t);
+    pool->client = client;
+    pool->client_sv = SvREFCNT_inc_simple_NN(client_sv);
+    pool->ttl = ttl;
+    pool->size = size;
+    Newx(pool->ids, size, int64_t);
+    ev_timer_init(&pool->retry_timer, lease_pool_retry_cb, LEASE_POOL_RETRY, 0.);
+
+    (void)lease_mgr_get(aTHX_ client);
+    pool->next = client->lease_pools;
+    client->lease_pools = pool;
+
+    lease_pool_refill(aTHX_ pool);
+    return pool;
+}
+
+/* Grant leases until idle plus in-flight reaches the pool size */
+void lease_pool_refill(pTHX_ lease_pool_t *pool) {
+    ev_etcd_t *client = pool->client;
+    if (!client || ev_is_active(&pool->retry_timer)) return;
+
+    while (pool->len + pool->granting < pool->size) {
+        Etcdserverpb__LeaseGrantRequest req = ETCDSERVERPB__LEASE_GRANT_REQUEST__INIT;
+        req.ttl = pool->ttl;
+
+        grpc_slice req_slice;
+        SERIALIZE_PROTOBUF_TO_SLICE(req_slice,
+            etcdserverpb__lease_grant_request__get_packed_size,
+            etcdserverpb__lease_grant_request__pack, &req);
+        grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
+        grpc_slice_unref(req_slice);
+
+        pending_call_t *pc;
+        INIT_PENDING_CALL(pc, CALL_TYPE_LEASE_POOL_GRANT, &PL_sv_undef, client);
+        pc->pool = pool;
+        pc->sent_at = lease_clock();
+
+        if (start_unary_call(client, pc, METHOD_LEASE_GRANT, send_buffer) != GRPC_CALL_OK) {
+            CLEANUP_PENDING_CALL_ON_ERROR(pc);
+            pool->failures++;
+            ev_timer_start(EV_DEFAULT, &pool->retry_timer);
+            return;
+        }
+        pool->granting++;
+    }
+}
+
+/* Completion of a refill grant */
+void lease_pool_grant_done(pTHX_ pending_call_t *pc, int success) {
+    lease_pool_t *pool = pc->pool;
+    int64_t id = 0;
+    int64_t ttl = 0;
+
+    if (success && pc->status == GRPC_STATUS_OK && pc->recv_buffer) {
+        grpc_byte_buffer_reader reader;
+        if (grpc_byte_buffer_reader_init(&reader, pc->recv_buffer)) {
+            grpc_slice slice = grpc_byte_buffer_reader_readall(&reader);
+            grpc_byte_buffer_reader_destroy(&reader);
+            Etcdserverpb__LeaseGrantResponse *resp = etcdserverpb__lease_grant_response__unpack(
+                NULL, GRPC_SLICE_LENGTH(slice), GRPC_SLICE_START_PTR(slice));
+            grpc_slice_unref(slice);
+            if (resp) {
+                if (!resp->error || !*resp->error) {
+                    id = resp->id;
+                    ttl = resp->ttl;
+                }
+                etcdserverpb__lease_grant_response__free_unpacked(resp, NULL);
+            }
+        }
+    }
+
+    /* Pool destroyed meanwhile: the unmanaged lease simply expires */
+    if (!pool) return;
+
+    pool->granting--;
+    if (id <= 0) {
+        pool->failures++;
+        if (!ev_is_active(&pool->retry_timer)) {
+            ev_timer_start(EV_DEFAULT, &pool->retry_timer);
+        }
+        return;
+    }
+
+    pool->granted++;
+    pool->ids[(pool->head + pool->len) % pool->size] = id;
+    pool->len++;
+    lease_note(aTHX_ pool->client, id, ttl, pc->sent_at);
+    lease_mgr_add(aTHX_ pool->client->lease_mgr, id, ttl, NULL);
+}
+
+/*
+ * Hand out an idle lease, 0 if none is left, and grant a replacement.
+ * The lease stays managed; it belongs to the caller from here on.
+ */
+int64_t lease_pool_take(pTHX_ lease_pool_t *pool) {
+    int64_t id = 0;
+
+    while (pool->len > 0) {
+        int64_t candidate = pool->ids[pool->head];
+        pool->head = (pool->head + 1) % pool->size;
+        pool->len--;
+        if (pool->client && lease_mgr_find(aTHX_ pool->client->lease_mgr, candidate)) {
+            id = candidate;
+            pool->taken++;
+            break;
+        }
+        pool->lost++;
+    }
+
+    lease_pool_refill(aTHX_ pool);
+    return id;
+}
+
+/* Let go of the idle leases (they expire) and of grants in flight */
+static void lease_pool_drop(pTHX_ lease_pool_t *pool) {
+    ev_etcd_t *client = pool->client;
+
+    while (pool->len > 0) {
+        (void)lease_mgr_remove(aTHX_ client->lease_mgr, pool->ids[pool->head]);
+        pool->head = (pool->head + 1) % pool->size;
+        pool->len--;
+    }
+    pool->head = 0;
+
+    pending_call_t *pc;
+    for (pc = client->pending_calls; pc; pc = pc->next) {
+        if (pc->pool == pool) {
+            pc->pool = NULL;
+        }
+    }
+    pool->granting = 0;
+    ev_timer_stop(EV_DEFAULT, &pool->retry_timer);
+}
+
+/* In a forked child: the idle leases are the parent's, grant our own */
+void lease_pool_after_fork(pTHX_ lease_pool_t *pool) {
+    lease_pool_drop(aTHX_ pool);
+    lease_pool_refill(aTHX_ pool);
+}
+
+void lease_pool_free(pTHX_ lease_pool_t *pool) {
+    ev_etcd_t *client = pool->client;
+
+    if (client) {
+        lease_pool_drop(aTHX_ pool);
+        lease_pool_t **pp = &client->lease_pools;
+        while (*pp) {
+            if (*pp == pool) {
+                *pp = pool->next;
+                break;
+            }
+            pp = &(*pp)->next;
+        }
+    }
+    ev_timer_stop(EV_DEFAULT, &pool->retry_timer);
+    Safefree(pool->ids);
+    SvREFCNT_dec(pool->client_sv);
+    Safefree(pool);
+}
@@ -0,0 +1,39 @@
+/*
+ * etcd_lease_mgr.h - Lease manager for EV::Etcd
+ */
+#ifndef ETCD_LEASE_MGR_H
+#define ETCD_LEASE_MGR_H
+
+#include "etcd_common.h"
+
+double lease_clock(void);
+
+lease_manager_t *lease_mgr_new(pTHX_ ev_etcd_t *client);
+lease_manager_t *lease_mgr_get(pTHX_ ev_etcd_t *client);
+void lease_mgr_add(pTHX_ lease_manager_t *mgr, int64_t id, int64_t ttl, SV *callback);
+int lease_mgr_remove(pTHX_ lease_manager_t *mgr, int64_t id);
+managed_lease_t *lease_mgr_find(pTHX_ lease_manager_t *mgr, int64_t id);
+double lease_mgr_remaining(managed_lease_t *ml);
+
+/* Local TTL estimates for leases granted or renewed by this client */
+void lease_note(pTHX_ ev_etcd_t *client, int64_t id, int64_t ttl, double at);
+void lease_forget(pTHX_ ev_etcd_t *client, int64_t id);
+double lease_estimate(pTHX_ ev_etcd_t *client, int64_t id);
+
+/* Stream events, from process_grpc_event */
+void lease_mgr_process_event(pTHX_ call_base_t *base, int success);
+
+/* Client teardown and fork */
+void lease_mgr_cancel(lease_manager_t *mgr);
+void lease_mgr_after_fork(pTHX_ lease_manager_t *mgr, int restore);
+void lease_mgr_free(pTHX_ lease_manager_t *mgr);
+
+/* Lease pool (EV::Etcd::LeasePool) */
+lease_pool_t *lease_pool_new(pTHX_ ev_etcd_t *client, SV *client_sv, int64_t ttl, size_t size);
+void lease_pool_refill(pTHX_ lease_pool_t *pool);
+void lease_pool_grant_done(pTHX_ pending_call_t *pc, int success);
+int64_t lease_pool_take(pTHX_ lease_pool_t *pool);
+void lease_pool_after_fork(pTHX_ lease_pool_t *pool);
+void lease_pool_free(pTHX_ lease_pool_t *pool);
+
+#endif /* ETCD_LEASE_MGR_H */
@@ -0,0 +1,382 @@
+/*
+ * etcd_shm.c - Shared-memory mirror of a cache for EV::Etcd
+ *
+ * One process (a cache created with shared => $path) publishes the cached
+ * prefix into a file-backed shared mapping; any number of processes read
+ * it through EV::Etcd::Mirror without a client, channel or watch.
+ *
+ * The file holds a header and two regions. Each region is a complete
+ * image: an open-addressed table (linear probing, FNV-1a hashes) over a
+ * data area of key/value records. The publisher rebuilds the region that
+ * is not current and then bumps the generation counter, whose low bit
+ * names the current region. A reader notes the generation, reads, and
+ * retries if it changed meanwhile (a seqlock over a double buffer), so it
+ * never sees a half-written image. Every offset is bounds checked so a
+ * torn read can only cause a retry.
+ *
+ * Native byte order; the file is meant for processes on one host.
+ */
+#define PERL_NO_GET_CONTEXT
+#include "EXTERN.h"
+#include "perl.h"
+#include "XSUB.h"
+#include "ppport.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "etcd_common.h"
+#include "etcd_shm.h"
+
+#define SHM_MAGIC "EVETCDM1"
+#define SHM_HEADER_SIZE 64
+
+/* Give up on a read that keeps overlapping publishes */
+#define SHM_MAX_READ_RETRIES 1000
+
+typedef struct {
+    char magic[8];
+    uint64_t size;
+    uint64_t region_size;
+    volatile uint64_t generation;  /* 0: nothing published yet */
+} shm_header_t;
+
+typedef struct {
+    int64_t revision;
+    uint64_t n_keys;
+    uint64_t n_slots;              /* Power of two */
+    uint64_t data_len;
+} shm_region_t;
+
+typedef struct {
+    uint64_t hash;                 /* 0: empty slot */
+    uint64_t offset;               /* Record offset in the data area */
+} shm_slot_t;
+
+typedef struct {
+    uint32_t key_len;
+    uint32_t value_len;
+} shm_record_t;
+
+static uint64_t shm_hash(const char *key, size_t len) {
+    uint64_t h = 14695981039346656037ULL;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)key[i];
+        h *= 1099511628211ULL;
+    }
+    return h ? h : 1;
+}
+
+static shm_header_t *shm_header(etcd_shm_t *shm) {
+    return (shm_header_t *)shm->map;
+}
+
+static char *shm_region_base(etcd_shm_t *shm, uint64_t generation) {
+    return shm->map + SHM_HEADER_SIZE + (generation & 1) * shm_header(shm)->region_size;
+}
+
+static uint64_t shm_load_generation(etcd_shm_t *shm) {
+    uint64_t g = shm_header(shm)->generation;
+    __sync_synchronize();
+    return g;
+}
+
+static etcd_shm_t *shm_map(const char *path, int fd, size_t size, int writer) {
+    char *map = mmap(NULL, size, writer ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) return NULL;
+
+    etcd_shm_t *shm;
+    Newxz(shm, 1, etcd_shm_t);
+    shm->map = map;
+    shm->size = size;
+    shm->writer = writer;
+    size_t path_len = strlen(path);
+    Newx(shm->path, path_len + 1, char);
+    Copy(path, shm->path, path_len + 1, char);
+    return shm;
+}
+
+static int shm_header_valid(const char *map, size_t size) {
+    const shm_header_t *h = (const shm_header_t *)map;
+    return memcmp(h->magic, SHM_MAGIC, 8) == 0
+        && h->size == size
+        && h->region_size >= sizeof(shm_region_t)
+        && SHM_HEADER_SIZE + 2 * h->region_size <= size;
+}
+
+/*
+ * Open the mirror file for publishing. A valid file of the same size is
+ * reused, so readers that have it mapped keep following it; anything
+ * else is replaced by a fresh file renamed into place.
+ */
+etcd_shm_t *shm_create(const char *path, size_t size) {
+    int fd = open(path, O_RDWR);
+    if (fd >= 0) {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && (size_t)st.st_size == size) {
+            etcd_shm_t *shm = shm_map(path, fd, size, 1);
+            close(fd);
+            if (shm && shm_header_valid(shm->map, size)) {
+                return shm;
+            }
+            if (shm) shm_close(shm);
+        } else {
+            close(fd);
+        }
+    }
+
+    size_t path_len = strlen(path);
+    char *tmp;
+    Newx(tmp, path_len + 32, char);
+    snprintf(tmp, path_len + 32, "%s.%ld.tmp", path, (long)getpid());
+    fd = open(tmp, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        Safefree(tmp);
+        return NULL;
+    }
+    if (ftruncate(fd, (off_t)size) != 0) {
+        close(fd);
+        unlink(tmp);
+        Safefree(tmp);
+        return NULL;
+    }
+
+    etcd_shm_t *shm = shm_map(path, fd, size, 1);
+    close(fd);
+    if (shm) {
+        shm_header_t *h = shm_header(shm);
+        h->size = size;
+        h->region_size = ((size - SHM_HEADER_SIZE) / 2) & ~(uint64_t)7;
+        h->generation = 0;
+        __sync_synchronize();
+        memcpy(h->magic, SHM_MAGIC, 8);
+        if (rename(tmp, path) != 0) {
+            shm_close(shm);
+            shm = NULL;
+            unlink(tmp);
+        }
+    } else {
+        unlink(tmp);
+    }
+    Safefree(tmp);
+    return shm;
+}
+
+/*
+ * Write the cache contents into the region that is not current and make
+ * it current. Returns 0, publishing nothing, if it does not fit.
+ */
+int shm_publish(pTHX_ etcd_shm_t *shm, HV *data, int64_t revision) {
+    shm_header_t *h = shm_header(shm);
+    uint64_t next = h->generation + 1;
+    char *base = shm_region_base(shm, next);
+
+    uint64_t n_keys = HvUSEDKEYS(data);
+    uint64_t n_slots = 8;
+    while (n_slots < n_keys * 2) n_slots <<= 1;
+
+    size_t table_len = sizeof(shm_region_t) + n_slots * sizeof(shm_slot_t);
+    if (table_len > h->region_size) return 0;
+
+    shm_region_t *region = (shm_region_t *)base;
+    shm_slot_t *slots = (shm_slot_t *)(base + sizeof(shm_region_t));
+    char *area = base + table_len;
+    size_t area_cap = h->region_size - table_len;
+    size_t used = 0;
+
+    Zero(slots, n_slots, shm_slot_t);
+
+    HE *he;
+    hv_iterinit(data);
+    while ((he = hv_iternext(data))) {
+        I32 key_len;
+        char *key = hv_iterkey(he, &key_len);
+        STRLEN value_len;
+        const char *value = SvPV(hv_iterval(data, he), value_len);
+
+        size_t rec_len = (sizeof(shm_record_t) + (size_t)key_len + value_len + 7) & ~(size_t)7;
+        if (used + rec_len > area_cap) {
+            return 0;
+        }
+        shm_record_t rec;
+        rec.key_len = (uint32_t)key_len;
+        rec.value_len = (uint32_t)value_len;
+        memcpy(area + used, &rec, sizeof(rec));
+        memcpy(area + used + sizeof(rec), key, key_len);
+        memcpy(area + used + sizeof(rec) + key_len, value, value_len);
+
+        uint64_t hash = shm_hash(key, key_len);
+        uint64_t i = hash & (n_slots - 1);
+        while (slots[i].hash) i = (i + 1) & (n_slots - 1);
+        slots[i].hash = hash;
+        slots[i].offset = used;
+        used += rec_len;
+    }
+
+    region->revision = revision;
+    region->n_keys = n_keys;
+    region->n_slots = n_slots;
+    region->data_len = used;
+
+    /* The image must be complete before readers can pick it */
+    __sync_synchronize();
+    h->generation = next;
+    __sync_synchronize();
+    return 1;
+}
+
+etcd_shm_t *shm_open_reader(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < SHM_HEADER_SIZE + 2 * sizeof(shm_region_t)) {
+        close(fd);
+        return NULL;
+    }
+    etcd_shm_t *shm = shm_map(path, fd, (size_t)st.st_size, 0);
+    close(fd);
+    if (shm && !shm_header_valid(shm->map, shm->size)) {
+        shm_close(shm);
+        return NULL;
+    }
+    return shm;
+}
+
+/* Current region's table, or NULL if it is inconsistent (being rewritten) */
+static shm_region_t *shm_region(etcd_shm_t *shm, uint64_t generation,
+                                shm_slot_t **slots, const char **area, size_t *area_len) {
+    uint64_t region_size = shm_header(shm)->region_size;
+    char *base = shm_region_base(shm, generation);
+    shm_region_t *region = (shm_region_t *)base;
+    uint64_t n_slots = region->n_slots;
+
+    if (!n_slots || (n_slots & (n_slots - 1))
+        || n_slots > (region_size - sizeof(shm_region_t)) / sizeof(shm_slot_t)) {
+        return NULL;
+    }
+    size_t table_len = sizeof(shm_region_t) + n_slots * sizeof(shm_slot_t);
+    *slots = (shm_slot_t *)(base + sizeof(shm_region_t));
+    *area = base + table_len;
+    *area_len = region_size - table_len;
+    return region;
+}
+
+/* Bounds-checked record at offset */
+static int shm_record(const char *area, size_t area_len, uint64_t offset,
+                      const char **key, size_t *key_len, const char **value, size_t *value_len) {
+    shm_record_t rec;
+    if (offset > area_len || area_len - offset < sizeof(rec)) return 0;
+    memcpy(&rec, area + offset, sizeof(rec));
+    if (area_len - offset - sizeof(rec) < (size_t)rec.key_len + rec.value_len) return 0;
+    *key = area + offset + sizeof(rec);
+    *key_len = rec.key_len;
+    *value = *key + rec.key_len;
+    *value_len = rec.value_len;
+    return 1;
+}
+
+/* Copy of the value of key, or NULL if absent */
+SV *shm_get(pTHX_ etcd_shm_t *shm, const char *key, size_t key_len) {
+    uint64_t hash = shm_hash(key, key_len);
+
+    for (int attempt = 0; attempt < SHM_MAX_READ_RETRIES; attempt++) {
+        uint64_t g = shm_load_generation(shm);
+        if (!g) return NULL;
+
+        shm_slot_t *slots;
+        const char *area;
+        size_t area_len;
+        shm_region_t *region = shm_region(shm, g, &slots, &area, &area_len);
+        SV *result = NULL;
+        int consistent = region != NULL;
+
+        if (consistent) {
+            uint64_t mask = region->n_slots - 1;
+            for (uint64_t n = 0, i = hash & mask; n <= mask; n++, i = (i + 1) & mask) {
+                uint64_t h = slots[i].hash;
+                if (!h) break;
+                if (h != hash) continue;
+                const char *k, *v;
+                size_t klen, vlen;
+                if (!shm_record(area, area_len, slots[i].offset, &k, &klen, &v, &vlen)) {
+                    consistent = 0;
+                    break;
+                }
+                if (klen == key_len && memcmp(k, key, key_len) == 0) {
+                    result = newSVpvn(v, vlen);
+                    break;
+                }
+            }
+        }
+
+        /* The reads above must complete before the generation re-check */
+        __sync_synchronize();
+        if (consistent && shm_load_generation(shm) == g) {
+            return result;
+        }
+        if (result) SvREFCNT_dec(result);
+    }
+    croak("shared mirror is being rewritten too often to read");
+}
+
+/* key => value for every key under prefix */
+HV *shm_get_prefix(pTHX_ etcd_shm_t *shm, const char *prefix, size_t prefix_len) {
+    for (int attempt = 0; attempt < SHM_MAX_READ_RETRIES; attempt++) {
+        HV *result = newHV();
+        uint64_t g = shm_load_generation(shm);
+        if (!g) return result;
+
+        shm_slot_t *slots;
+        const char *area;
+        size_t area_len;
+        shm_region_t *region = shm_region(shm, g, &slots, &area, &area_len);
+        int consistent = region != NULL;
+        uint64_t n_slots = region ? region->n_slots : 0;
+
+        for (uint64_t i = 0; consistent && i < n_slots; i++) {
+            if (!slots[i].hash) continue;
+            const char *k, *v;
+            size_t klen, vlen;
+            if (!shm_record(area, area_len, slots[i].offset, &k, &klen, &v, &vlen)) {
+                consistent = 0;
+                break;
+            }
+            if (klen >= prefix_len && memcmp(k, prefix, prefix_len) == 0) {
+                hv_store(result, k, (I32)klen, newSVpvn(v, vlen), 0);
+            }
+        }
+
+        /* The reads above must complete before the generation re-check */
+        __sync_synchronize();
+        if (consistent && shm_load_generation(shm) == g) {
+            return result;
+        }
+        SvREFCNT_dec((SV *)result);
+    }
+    croak("shared mirror is being rewritten too often to read");
+}
+
+int64_t shm_revision(etcd_shm_t *shm) {
+    for (int attempt = 0; attempt < SHM_MAX_READ_RETRIES; attempt++) {
+        uint64_t g = shm_load_generation(shm);
+        if (!g) return 0;
+        int64_t revision = ((shm_region_t *)shm_region_base(shm, g))->revision;
+        __sync_synchronize();
+        if (shm_load_generation(shm) == g) return revision;
+    }
+    return 0;
+}
+
+uint64_t shm_generation(etcd_shm_t *shm) {
+    return shm_load_generation(shm);
+}
+
+void shm_close(etcd_shm_t *shm) {
+    munmap(shm->map, shm->size);
+    Safefree(shm->path);
+    Safefree(shm);
+}
@@ -0,0 +1,25 @@
+/*
+ * etcd_shm.h - Shared-memory mirror of a cache for EV::Etcd
+ */
+#ifndef ETCD_SHM_H
+#define ETCD_SHM_H
+
+#include "etcd_common.h"
+
+/* Default size of a mirror file, split between its two regions */
+#define SHM_DEFAULT_SIZE (16 * 1024 * 1024)
+
+/* Publisher side (a cache with the shared option) */
+etcd_shm_t *shm_create(const char *path, size_t size);
+int shm_publish(pTHX_ etcd_shm_t *shm, HV *data, int64_t revision);
+
+/* Reader side (EV::Etcd::Mirror) */
+etcd_shm_t *shm_open_reader(const char *path);
+SV *shm_get(pTHX_ etcd_shm_t *shm, const char *key, size_t key_len);
+HV *shm_get_prefix(pTHX_ etcd_shm_t *shm, const char *prefix, size_t prefix_len);
+int64_t shm_revision(etcd_shm_t *shm);
+uint64_t shm_generation(etcd_shm_t *shm);
+
+void shm_close(etcd_shm_t *shm);
+
+#endif /* ETCD_SHM_H */
@@ -11,11 +11,16 @@
 
 #include "etcd_common.h"
 #include "etcd_watch.h"
+#include "etcd_cache.h"
 
-/* Re-arm watch to receive next message */
-void watch_rearm_recv(pTHX_ watch_call_t *wc) {
-    if (!wc->active) return;
+static void watch_coalesce_close(pTHX_ watch_call_t *wc);
+static int watch_restart_stream(pTHX_ watch_call_t *wc);
+
+/* Keys per Range page when resyncing after compaction */
+#define WATCH_RESYNC_PAGE 1000
 
+/* Start the next RECV_MESSAGE on the watch stream */
+static grpc_call_error watch_start_recv(watch_call_t *wc) {
     if (wc->recv_buffer) {
         grpc_byte_buffer_destroy(wc->recv_buffer);
         wc->recv_buffer = NULL;
@@ -28,18 +33,60 @@ void watch_rearm_recv(pTHX_ watch_call_t *wc) {
     op.op = GRPC_OP_RECV_MESSAGE;
     op.data.recv_message.recv_message = &wc->recv_buffer;
 
-    grpc_call_error err = grpc_call_start_batch(wc->call, &op, 1, &wc->base, NULL);
+    return grpc_call_start_batch(wc->call, &op, 1, &wc->base, NULL);
+}
+
+/* Events held client-side and not yet delivered */
+static size_t watch_held_events(pTHX_ watch_call_t *wc) {
+    return wc->held_events + (wc->coalesced ? HvUSEDKEYS(wc->coalesced) : 0);
+}
+
+/*
+ * Re-arm watch to receive next message. A paused watch, or one holding
+ * max_pending_events undelivered events, leaves the receive unarmed
+ * (parked) so HTTP/2 flow control pushes back on the server.
+ */
+void watch_rearm_recv(pTHX_ watch_call_t *wc) {
+    if (!wc->active || wc->resyncing) return;
+
+    if (wc->paused || (wc->max_pending_events
+                       && watch_held_events(aTHX_ wc) >= wc->max_pending_events)) {
+        wc->recv_parked = 1;
+        return;
+    }
+
+    wc->recv_parked = 0;
+    grpc_call_error err = watch_start_recv(wc);
     if (err != GRPC_CALL_OK) {
         wc->active = 0;
+        watch_deliver_deferred(aTHX_ wc, 0);
         CALL_SIMPLE_ERROR_CALLBACK(wc->callback, "Watch rearm failed");
         cleanup_watch(aTHX_ wc);
     }
 }
 
+/*
+ * Arm a parked receive for a cancelled watch, so the stream's remaining
+ * messages drain and its completion cleans the watch up as usual.
+ */
+void watch_unpark_cancelled(watch_call_t *wc) {
+    if (!wc->recv_parked) return;
+
+    wc->recv_parked = 0;
+    (void)watch_start_recv(wc);
+}
+
 /* Cleanup watch and remove from client list */
 void cleanup_watch(pTHX_ watch_call_t *wc) {
     ev_etcd_t *client = wc->client;
 
+    /* Deferred results are being delivered; the delivering side frees it */
+    if (wc->delivering) {
+        wc->active = 0;
+        wc->cleanup_pending = 1;
+        return;
+    }
+
     watch_call_t **wp = &client->watches;
     while (*wp) {
         if (*wp == wc) {
@@ -48,6 +95,9 @@ void cleanup_watch(pTHX_ watch_call_t *wc) {
         }
         wp = &(*wp)->next;
     }
+    if (wc->cache) {
+        wc->cache->wc = NULL;
+    }
 
     grpc_metadata_array_destroy(&wc->initial_metadata);
     grpc_metadata_array_destroy(&wc->trailing_metadata);
@@ -59,6 +109,28 @@ void cleanup_watch(pTHX_ watch_call_t *wc) {
         grpc_call_unref(wc->call);
     }
     SvREFCNT_dec(wc->callback);
+    if (wc->deferred) {
+        SvREFCNT_dec((SV *)wc->deferred);
+    }
+    ev_timer_stop(EV_DEFAULT, &wc->coalesce_timer);
+    if (wc->coalesced) {
+        SvREFCNT_dec((SV *)wc->coalesced);
+    }
+    if (wc->coalesce_result) {
+        SvREFCNT_dec((SV *)wc->coalesce_result);
+    }
+    if (wc->known) {
+        SvREFCNT_dec((SV *)wc->known);
+    }
+    if (wc->resync_seen) {
+        SvREFCNT_dec((SV *)wc->resync_seen);
+    }
+    if (wc->resync_events) {
+        SvREFCNT_dec(wc->resync_events);
+    }
+    if (wc->sync_callback) {
+        SvREFCNT_dec(wc->sync_callback);
+    }
 
     if (wc->params.key) {
         Safefree(wc->params.key);
@@ -70,15 +142,536 @@ void cleanup_watch(pTHX_ watch_call_t *wc) {
     Safefree(wc);
 }
 
-/* Process WatchResponse and call Perl callback */
+/*
+ * Hand results deferred during this pass to the callback. With only_active
+ * delivery stops once the watch is cancelled; otherwise everything is
+ * delivered, including an open coalescing window, as needed right before
+ * the watch's final error callback.
+ */
+void watch_deliver_deferred(pTHX_ watch_call_t *wc, int only_active) {
+    if (!only_active) {
+        watch_coalesce_close(aTHX_ wc);
+    }
+
+    AV *results = wc->deferred;
+    if (!results) return;
+
+    wc->deferred = NULL;
+    wc->batch_hv = NULL;
+    wc->batch_count = 0;
+    wc->held_events = 0;
+    ev_etcd_t *client = wc->client;
+    wc->delivering++;
+    deliver_stream_results(aTHX_ wc->callback, results,
+                           only_active ? &wc->active : NULL, client->multicall);
+    if (!client->active) return;  /* destroyed from the callback, wc with it */
+    wc->delivering--;
+
+    /* Room again below max_pending_events: pick up a parked receive */
+    if (only_active && wc->recv_parked) {
+        watch_rearm_recv(aTHX_ wc);
+    }
+}
+
+/* Order coalesced events by revision */
+static int cmp_event_revision(const void *a, const void *b) {
+    const Mvccpb__Event *ea = *(Mvccpb__Event * const *)a;
+    const Mvccpb__Event *eb = *(Mvccpb__Event * const *)b;
+    int64_t ra = ea->kv ? ea->kv->mod_revision : 0;
+    int64_t rb = eb->kv ? eb->kv->mod_revision : 0;
+    return (ra > rb) - (ra < rb);
+}
+
+/* Coalescing window expired: deliver the compacted batch */
+static void watch_coalesce_timer_cb(struct ev_loop *loop, ev_timer *w, int revents) {
+    dTHX;
+    (void)loop;
+    (void)revents;
+
+    watch_call_t *wc = (watch_call_t *)((char *)w - offsetof(watch_call_t, coalesce_timer));
+    ev_etcd_t *client = wc->client;
+    int outer = client_pin(client);
+
+    watch_coalesce_close(aTHX_ wc);
+    wc->delivering++;
+    watch_deliver_deferred(aTHX_ wc, 1);
+    /* DESTROY from the callback has freed the watch with the client */
+    if (client->active && --wc->delivering == 0 && wc->cleanup_pending) {
+        cleanup_watch(aTHX_ wc);
+    }
+    (void)client_unpin(client, outer);
+}
+
+/*
+ * coalesce: keep only the newest event per key, packed, until the window
+ * closes. Repacking into the existing SV means memory tracks the number
+ * of distinct keys rather than the number of writes.
+ */
+static void watch_coalesce_add(pTHX_ watch_call_t *wc, Etcdserverpb__WatchResponse *resp) {
+    HV *result = wc->coalesce_result;
+
+    if (!result) {
+        result = wc->coalesce_result = newHV();
+        hv_store(result, "watch_id", 8, newSViv(resp->watch_id), 0);
+        hv_store(result, "created", 7, newSViv(0), 0);
+        hv_store(result, "canceled", 8, newSViv(0), 0);
+        if (!wc->coalesced) {
+            wc->coalesced = newHV();
+        }
+        ev_timer_init(&wc->coalesce_timer, watch_coalesce_timer_cb, wc->params.coalesce, 0.);
+        ev_timer_start(EV_DEFAULT, &wc->coalesce_timer);
+    }
+
+    add_header_to_hv(aTHX_ result, resp->header);
+    hv_store(result, "compact_revision", 16, newSViv(resp->compact_revision), 0);
+
+    for (size_t i = 0; i < resp->n_events; i++) {
+        Mvccpb__Event *event = resp->events[i];
+        if (!event->kv) continue;
+
+        const char *key = event->kv->key.data ? (const char *)event->kv->key.data : "";
+        SV **svp = hv_fetch(wc->coalesced, key, (I32)event->kv->key.len, 1);
+        size_t len = mvccpb__event__get_packed_size(event);
+        char *buf = SvGROW(*svp, len + 1);
+        mvccpb__event__pack(event, (uint8_t *)buf);
+        SvCUR_set(*svp, len);
+        SvPOK_only(*svp);
+    }
+}
+
+/* Turn an open coalescing window into one result, in revision order */
+static void watch_coalesce_close(pTHX_ watch_call_t *wc) {
+    HV *result = wc->coalesce_result;
+    if (!result) return;
+
+    ev_timer_stop(EV_DEFAULT, &wc->coalesce_timer);
+    wc->coalesce_result = NULL;
+
+    size_t n = 0, n_keys = HvUSEDKEYS(wc->coalesced);
+    Mvccpb__Event **events;
+    Newx(events, n_keys ? n_keys : 1, Mvccpb__Event *);
+
+    HE *he;
+    hv_iterinit(wc->coalesced);
+    while ((he = hv_iternext(wc->coalesced)) && n < n_keys) {
+        STRLEN len;
+        const char *buf = SvPV(HeVAL(he), len);
+        Mvccpb__Event *event = mvccpb__event__unpack(NULL, len, (const uint8_t *)buf);
+        if (event) {
+            events[n++] = event;
+        }
+    }
+    hv_clear(wc->coalesced);
+
+    qsort(events, n, sizeof(*events), cmp_event_revision);
+    hv_store(result, "events", 6, events_to_sv(aTHX_ events, n, wc->params.format), 0);
+    for (size_t i = 0; i < n; i++) {
+        mvccpb__event__free_unpacked(events[i], NULL);
+    }
+    Safefree(events);
+
+    defer_stream_result(aTHX_ &wc->deferred, result);
+    wc->held_events += n;
+    wc->batch_hv = NULL;
+    wc->batch_count = 0;
+}
+
+/*
+ * recover_compaction: remember which keys the watch has reported, so a
+ * resync can tell the callback about keys that vanished meanwhile.
+ */
+static void watch_track_events(pTHX_ watch_call_t *wc, Etcdserverpb__WatchResponse *resp) {
+    if (!wc->known) {
+        wc->known = newHV();
+    }
+
+    for (size_t i = 0; i < resp->n_events; i++) {
+        Mvccpb__KeyValue *kv = resp->events[i]->kv;
+        if (!kv) continue;
+
+        const char *key = kv->key.data ? (const char *)kv->key.data : "";
+        if (resp->events[i]->type == MVCCPB__EVENT__EVENT_TYPE__DELETE) {
+            (void)hv_delete(wc->known, key, (I32)kv->key.len, G_DISCARD);
+        } else {
+            hv_store(wc->known, key, (I32)kv->key.len, newSViv(kv->mod_revision), 0);
+        }
+    }
+}
+
+/*
+ * The resync or sync snapshot failed: deliver what is pending, then the
+ * error. The watch is left inactive; the caller cleans it up.
+ */
+static void watch_resync_error(pTHX_ watch_call_t *wc, grpc_status_code code,
+                               const char *message, size_t message_len) {
+    /* A sync() snapshot reports to the chunk callback */
+    SV *callback = wc->resync_phase == 2 ? wc->sync_callback : wc->callback;
+
+    wc->resyncing = 0;
+    wc->active = 0;
+    watch_deliver_deferred(aTHX_ wc, 0);
+
+    dSP;
+    ENTER; SAVETMPS; PUSHMARK(SP); EXTEND(SP, 2);
+    PUSHs(&PL_sv_undef);
+    PUSHs(sv_2mortal(create_error_hv(aTHX_ code, message, message_len, "watch")));
+    PUTBACK; call_sv(callback, G_DISCARD); FREETMPS; LEAVE;
+}
+
+/* Request one page of the watched range, starting at from (resync and sync) */
+static int watch_resync_request(pTHX_ watch_call_t *wc, const char *from, size_t from_len) {
+    ev_etcd_t *client = wc->client;
+
+    Etcdserverpb__RangeRequest req = ETCDSERVERPB__RANGE_REQUEST__INIT;
+    req.key.data = (uint8_t *)from;
+    req.key.len = from_len;
+    if (wc->params.range_end && wc->params.range_end_len > 0) {
+        req.range_end.data = (uint8_t *)wc->params.range_end;
+        req.range_end.len = wc->params.range_end_len;
+    }
+    req.limit = wc->page_size ? (int64_t)wc->page_size : WATCH_RESYNC_PAGE;
+    req.revision = wc->resync_revision;  /* 0 on the first page: current */
+    if (wc->resync_phase == 0) {
+        req.keys_only = 1;
+    } else if (wc->resync_phase == 1) {
+        req.min_mod_revision = wc->resync_since + 1;
+    }
+
+    grpc_slice req_slice;
+    SERIALIZE_PROTOBUF_TO_SLICE(req_slice,
+        etcdserverpb__range_request__get_packed_size,
+        etcdserverpb__range_request__pack, &req);
+    grpc_byte_buffer *send_buffer = grpc_raw_byte_buffer_create(&req_slice, 1);
+    grpc_slice_unref(req_slice);
+
+    pending_call_t *pc;
+    INIT_PENDING_CALL(pc, CALL_TYPE_WATCH_RESYNC, wc->callback, client);
+    pc->watch = wc;
+
+    grpc_call_error err = start_unary_call(client, pc, METHOD_KV_RANGE, send_buffer);
+    if (err != GRPC_CALL_OK) {
+        CLEANUP_PENDING_CALL_ON_ERROR(pc);
+        return 0;
+    }
+    return 1;
+}
+
+/*
+ * The server cancelled the watch because the revision it had to resume
+ * from is compacted. Instead of failing, page through the range at the
+ * current revision: first keys only, to find keys that vanished, then
+ * the values of keys modified since the last revision seen.
+ */
+static void watch_resync_start(pTHX_ watch_call_t *wc, int64_t since, int64_t compact_revision) {
+    wc->resyncing = 1;
+    wc->resync_phase = 0;
+    wc->resync_since = since;
+    wc->resync_revision = 0;
+    wc->resync_compact = compact_revision;
+    if (!wc->resync_seen) {
+        wc->resync_seen = newHV();
+    }
+
+    /* The server already dropped this watch; stop the stream until restart */
+    if (wc->call) {
+        grpc_call_cancel(wc->call, NULL);
+    }
+
+    if (!watch_resync_request(aTHX_ wc, wc->params.key, wc->params.key_len)) {
+        watch_resync_error(aTHX_ wc, GRPC_STATUS_INTERNAL, "Watch resync failed", 19);
+    }
+}
+
+/* Append events of one type built from kvs to the resync result */
+static void watch_resync_add_events(pTHX_ watch_call_t *wc, Mvccpb__KeyValue **kvs, size_t n,
+                                    Mvccpb__Event__EventType type) {
+    Mvccpb__Event *events, **ptrs;
+    Newx(events, n ? n : 1, Mvccpb__Event);
+    Newx(ptrs, n ? n : 1, Mvccpb__Event *);
+    for (size_t i = 0; i < n; i++) {
+        mvccpb__event__init(&events[i]);
+        events[i].type = type;
+        events[i].kv = kvs[i];
+        ptrs[i] = &events[i];
+    }
+
+    SV *sv = events_to_sv(aTHX_ ptrs, n, wc->params.format);
+    if (wc->resync_events) {
+        append_events_sv(aTHX_ wc->resync_events, sv);
+        SvREFCNT_dec(sv);
+    } else {
+        wc->resync_events = sv;
+    }
+
+    Safefree(ptrs);
+    Safefree(events);
+}
+
+/* Keys reported before the compaction that no longer exist become DELETEs */
+static void watch_resync_add_deletes(pTHX_ watch_call_t *wc) {
+    size_t n = 0, max = wc->known ? HvUSEDKEYS(wc->known) : 0;
+    if (!max) return;
+
+    Mvccpb__KeyValue *kvs, **ptrs;
+    Newx(kvs, max, Mvccpb__KeyValue);
+    Newx(ptrs, max, Mvccpb__KeyValue *);
+
+    HE *he;
+    hv_iterinit(wc->known);
+    while ((he = hv_iternext(wc->known)) && n < max) {
+        I32 klen;
+        char *key = hv_iterkey(he, &klen);
+        if (hv_exists(wc->resync_seen, key, klen)) continue;
+
+        mvccpb__key_value__init(&kvs[n]);
+        kvs[n].key.data = (uint8_t *)key;
+        kvs[n].key.len = klen;
+        kvs[n].mod_revision = wc->resync_revision;
+        ptrs[n] = &kvs[n];
+        n++;
+    }
+
+    if (n) {
+        watch_resync_add_events(aTHX_ wc, ptrs, n, MVCCPB__EVENT__EVENT_TYPE__DELETE);
+    }
+    Safefree(ptrs);
+    Safefree(kvs);
+}
+
+/*
+ * sync(): hand one snapshot page to the chunk callback. Returns 0 if the
+ * watch was cancelled from the callback.
+ */
+static int watch_sync_chunk(pTHX_ watch_call_t *wc, Etcdserverpb__RangeResponse *resp) {
+    if (wc->cache) {
+        cache_load_kvs(aTHX_ wc->cache, resp->kvs, resp->n_kvs);
+        return wc->active;
+    }
+
+    /* recover_compaction needs the snapshot's keys to detect deletions */
+    if (wc->params.recover_compaction) {
+        for (size_t i = 0; i < resp->n_kvs; i++) {
+            Mvccpb__KeyValue *kv = resp->kvs[i];
+            hv_store(wc->resync_seen, kv->key.data ? (const char *)kv->key.data : "",
+                     (I32)kv->key.len, newSViv(kv->mod_revision), 0);
+        }
+    }
+
+    HV *chunk = newHV();
+    add_header_to_hv(aTHX_ chunk, resp->header);
+    hv_store(chunk, "kvs", 3, kvs_to_sv(aTHX_ resp->kvs, resp->n_kvs, wc->params.format), 0);
+    hv_store(chunk, "more", 4, newSViv(resp->more && resp->n_kvs > 0), 0);
+    hv_store(chunk, "revision", 8, newSViv(wc->resync_revision), 0);
+
+    SvREFCNT_inc_simple_void_NN(wc->sync_callback);
+    CALL_SUCCESS_CALLBACK(wc->sync_callback, chunk);
+    SvREFCNT_dec(wc->sync_callback);
+
+    return wc->active;
+}
+
+/* sync(): snapshot complete, start watching right after its revision */
+static void watch_sync_finish(pTHX_ watch_call_t *wc) {
+    if (wc->params.recover_compaction) {
+        if (wc->known) {
+            SvREFCNT_dec((SV *)wc->known);
+        }
+        wc->known = wc->resync_seen;
+        wc->resync_seen = NULL;
+    }
+
+    wc->last_revision = wc->resync_revision;
+    wc->resyncing = 0;
+    wc->resync_phase = 0;
+    if (!watch_restart_stream(aTHX_ wc)) {
+        watch_resync_error(aTHX_ wc, GRPC_STATUS_UNAVAILABLE, "Watch start failed", 18);
+        cleanup_watch(aTHX_ wc);
+        return;
+    }
+
+    /* cache(): swap the snapshot in and report it; the callback may drop the cache */
+    if (wc->cache) {
+        etcd_cache_t *cache = wc->cache;
+        cache_loaded(aTHX_ cache, wc->last_revision);
+        HV *result = newHV();
+        hv_store(result, "revision", 8, newSViv(cache->revision), 0);
+        hv_store(result, "keys", 4, newSVuv(HvUSEDKEYS(cache->data)), 0);
+        SvREFCNT_inc_simple_void_NN(wc->sync_callback);
+        SV *callback = wc->sync_callback;
+        CALL_SUCCESS_CALLBACK(callback, result);
+        SvREFCNT_dec(callback);
+    }
+}
+
+/* cache(): warm start, watch from the revision after a restored snapshot */
+int watch_resume_at(pTHX_ watch_call_t *wc, int64_t revision) {
+    wc->last_revision = revision;
+    return watch_restart_stream(aTHX_ wc);
+}
+
+/*
+ * sync(): page through the range at one pinned revision, then watch from
+ * the revision after it. The watch must already be on the client's list.
+ * A cache() watch also comes back here to reload after a compaction.
+ */
+int watch_sync_start(pTHX_ watch_call_t *wc) {
+    wc->resyncing = 1;
+    wc->resync_phase = 2;
+    wc->resync_revision = 0;
+    if (wc->cache) {
+        cache_load_discard(aTHX_ wc->cache);
+    }
+    if (wc->params.recover_compaction && !wc->resync_seen) {
+        wc->resync_seen = newHV();
+    }
+
+    /* Reloading a cache: the server already dropped this watch */
+    if (wc->call) {
+        grpc_call_cancel(wc->call, NULL);
+    }
+    return watch_resync_request(aTHX_ wc, wc->params.key, wc->params.key_len);
+}
+
+/* Process one page of a compaction resync or sync() snapshot */
+void process_watch_resync_response(pTHX_ pending_call_t *pc, int success) {
+    watch_call_t *wc = pc->watch;
+
+    /* Cancelled by the user while resyncing: nothing else will free it */
+    if (!wc->active) {
+        wc->resyncing = 0;
+        cleanup_watch(aTHX_ wc);
+        return;
+    }
+
+    if (!success) {
+        watch_resync_error(aTHX_ wc, GRPC_STATUS_UNAVAILABLE, "Watch resync failed", 19);
+        cleanup_watch(aTHX_ wc);
+        return;
+    }
+    if (pc->status != GRPC_STATUS_OK) {
+        watch_resync_error(aTHX_ wc, pc->status,
+            (const char *)GRPC_SLICE_START_PTR(pc->status_details),
+            GRPC_SLICE_LENGTH(pc->status_details));
+        cleanup_watch(aTHX_ wc);
+        return;
+    }
+
+    Etcdserverpb__RangeResponse *resp = NULL;
+    grpc_byte_buffer_reader reader;
+    if (pc->recv_buffer && grpc_byte_buffer_reader_init(&reader, pc->recv_buffer)) {
+        grpc_slice slice = grpc_byte_buffer_reader_readall(&reader);
+        grpc_byte_buffer_reader_destroy(&reader);
+        resp = etcdserverpb__range_response__unpack(
+            NULL, GRPC_SLICE_LENGTH(slice), GRPC_SLICE_START_PTR(slice));
+        grpc_slice_unref(slice);
+    }
+    if (!resp) {
+        watch_resync_error(aTHX_ wc, GRPC_STATUS_INTERNAL, "Failed to parse watch resync response", 37);
+        cleanup_watch(aTHX_ wc);
+        return;
+    }
+
+    /* Pin every page to the revision of the first one */
+    if (wc->resync_revision == 0 && resp->header) {
+        wc->resync_revision = resp->header->revision;
+    }
+
+    if (wc->resync_phase == 2) {
+        if (!watch_sync_chunk(aTHX_ wc, resp)) {
+            /* Cancelled from the chunk callback */
+            etcdserverpb__range_response__free_unpacked(resp, NULL);
+            cleanup_watch(aTHX_ wc);
+            return;
+        }
+        if (!(resp->more && resp->n_kvs > 0)) {
+            etcdserverpb__range_response__free_unpacked(resp, NULL);
+            watch_sync_finish(aTHX_ wc);
+            return;
+        }
+    } else if (wc->resync_phase == 0) {
+        for (size_t i = 0; i < resp->n_kvs; i++) {
+            Mvccpb__KeyValue *kv = resp->kvs[i];
+            hv_store(wc->resync_seen, kv->key.data ? (const char *)kv->key.data : "",
+                     (I32)kv->key.len, newSViv(kv->mod_revision), 0);
+        }
+    } else if (resp->n_kvs > 0) {
+        watch_resync_add_events(aTHX_ wc, resp->kvs, resp->n_kvs, MVCCPB__EVENT__EVENT_TYPE__PUT);
+    }
+
+    /* Next page starts right after the last key */
+    int more = resp->more && resp->n_kvs > 0;
+    int ok = 1;
+    if (more || wc->resync_phase == 0) {
+        char *from = wc->params.key;
+        size_t from_len = wc->params.key_len;
+        char *next = NULL;
+        if (more) {
+            Mvccpb__KeyValue *last = resp->kvs[resp->n_kvs - 1];
+            from_len = last->key.len + 1;
+            Newxz(next, from_len, char);
+            if (last->key.len) Copy(last->key.data, next, last->key.len, char);
+            from = next;
+        } else {
+            wc->resync_phase = 1;
+        }
+        ok = watch_resync_request(aTHX_ wc, from, from_len);
+        if (next) Safefree(next);
+        etcdserverpb__range_response__free_unpacked(resp, NULL);
+        if (!ok) {
+            watch_resync_error(aTHX_ wc, GRPC_STATUS_INTERNAL, "Watch resync failed", 19);
+            cleanup_watch(aTHX_ wc);
+        }
+        return;
+    }
+
+    /* Done: deliver the diff as one synthetic response, then resume */
+    watch_resync_add_deletes(aTHX_ wc);
+
+    HV *result = newHV();
+    add_header_to_hv(aTHX_ result, resp->header);
+    etcdserverpb__range_response__free_unpacked(resp, NULL);
+    hv_store(result, "watch_id", 8, newSViv(wc->watch_id), 0);
+    hv_store(result, "created", 7, newSViv(0), 0);
+    hv_store(result, "canceled", 8, newSViv(0), 0);
+    hv_store(result, "compact_revision", 16, newSViv(wc->resync_compact), 0);
+    hv_store(result, "resync", 6, newSViv(1), 0);
+    hv_store(result, "events", 6, wc->resync_events
+        ? wc->resync_events : events_to_sv(aTHX_ NULL, 0, wc->params.format), 0);
+    wc->resync_events = NULL;
+
+    if (wc->known) {
+        SvREFCNT_dec((SV *)wc->known);
+    }
+    wc->known = wc->resync_seen;
+    wc->resync_seen = NULL;
+
+    defer_stream_result(aTHX_ &wc->deferred, result);
+    wc->batch_hv = NULL;
+    wc->batch_count = 0;
+
+    wc->last_revision = wc->resync_revision;
+    wc->reconnect_attempt = 0;
+    wc->resyncing = 0;
+    if (!watch_restart_stream(aTHX_ wc)) {
+        watch_resync_error(aTHX_ wc, GRPC_STATUS_UNAVAILABLE, "Watch restart failed", 20);
+        cleanup_watch(aTHX_ wc);
+    }
+}
+
+/*
+ * Process WatchResponse and call Perl callback. The caller pins the watch
+ * (delivering) and cleans it up if it comes back inactive.
+ */
 void process_watch_response(pTHX_ watch_call_t *wc) {
     if (!wc->recv_buffer) {
+        watch_deliver_deferred(aTHX_ wc, 0);
         CALL_SIMPLE_ERROR_CALLBACK(wc->callback, "No watch response received");
         return;
     }
 
     grpc_byte_buffer_reader reader;
     if (!grpc_byte_buffer_reader_init(&reader, wc->recv_buffer)) {
+        watch_deliver_deferred(aTHX_ wc, 0);
         CALL_SIMPLE_ERROR_CALLBACK(wc->callback, "Failed to read watch response buffer");
         return;
     }
@@ -91,6 +684,7 @@ void process_watch_response(pTHX_ watch_call_t *wc) {
     grpc_slice_unref(slice);
 
     if (!resp) {
+        watch_deliver_deferred(aTHX_ wc, 0);
         CALL_SIMPLE_ERROR_CALLBACK(wc->callback, "Failed to parse watch response");
         return;
     }
@@ -100,26 +694,108 @@ void process_watch_response(pTHX_ watch_call_t *wc) {
         wc->reconnect_attempt = 0;
     }
 
+    int64_t seen_revision = wc->last_revision;
+
     if (resp->header && resp->header->revision > wc->last_revision) {
         wc->last_revision = resp->header->revision;
         wc->reconnect_attempt = 0;
     }
 
+    /* A cache cannot tell what it missed; load the prefix again */
+    if (resp->canceled && resp->compact_revision > 0 && wc->cache) {
+        etcdserverpb__watch_response__free_unpacked(resp, NULL);
+        wc->cache->warm = 0;
+        if (!watch_sync_start(aTHX_ wc)) {
+            watch_resync_error(aTHX_ wc, GRPC_STATUS_INTERNAL, "Cache reload failed", 19);
+            cleanup_watch(aTHX_ wc);  /* deferred: the caller holds the watch */
+        }
+        return;
+    }
+
+    if (resp->canceled && resp->compact_revision > 0 && wc->params.recover_compaction) {
+        /* Never saw a revision: everything since start_revision is news */
+        if (seen_revision <= 0 && wc->params.start_revision > 0) {
+            seen_revision = wc->params.start_revision - 1;
+        }
+        watch_resync_start(aTHX_ wc, seen_revision, resp->compact_revision);
+        etcdserverpb__watch_response__free_unpacked(resp, NULL);
+        return;
+    }
+
     if (resp->canceled) {
         wc->active = 0;
         const char *reason = (resp->cancel_reason && strlen(resp->cancel_reason) > 0)
             ? resp->cancel_reason : "Watch cancelled";
         size_t reason_len = strlen(reason);
+        watch_deliver_deferred(aTHX_ wc, 0);
         dSP;
-        ENTER; SAVETMPS; PUSHMARK(SP); EXTEND(SP, 2);
+        ENTER; SAVETMPS;
+        SV *err = sv_2mortal(create_error_hv(aTHX_ GRPC_STATUS_CANCELLED,
+            reason, reason_len, "watch"));
+        /* Compacted past the start: the caller may re-read and watch again */
+        if (resp->compact_revision > 0) {
+            hv_store((HV *)SvRV(err), "compact_revision", 16,
+                newSViv(resp->compact_revision), 0);
+        }
+        PUSHMARK(SP); EXTEND(SP, 2);
         PUSHs(&PL_sv_undef);
-        PUSHs(sv_2mortal(create_error_hv(aTHX_ GRPC_STATUS_CANCELLED,
-            reason, reason_len, "watch")));
+        PUSHs(err);
         PUTBACK; call_sv(wc->callback, G_DISCARD); FREETMPS; LEAVE;
         etcdserverpb__watch_response__free_unpacked(resp, NULL);
         return;
     }
 
+    if (wc->cache) {
+        etcd_cache_t *cache = wc->cache;
+        int confirmed = resp->created && cache->warm;
+        cache_apply_response(aTHX_ cache, resp);
+        etcdserverpb__watch_response__free_unpacked(resp, NULL);
+
+        /* Warm start: the watch resumed from the restored revision */
+        if (confirmed) {
+            cache->warm = 0;
+            HV *result = newHV();
+            hv_store(result, "revision", 8, newSViv(cache->revision), 0);
+            hv_store(result, "keys", 4, newSVuv(HvUSEDKEYS(cache->data)), 0);
+            hv_store(result, "warm", 4, newSViv(1), 0);
+            SV *callback = wc->sync_callback;
+            SvREFCNT_inc_simple_void_NN(callback);
+            CALL_SUCCESS_CALLBACK(callback, result);
+            SvREFCNT_dec(callback);
+        }
+        return;
+    }
+
+    if (wc->params.recover_compaction) {
+        watch_track_events(aTHX_ wc, resp);
+    }
+
+    if (wc->params.coalesce > 0) {
+        if (resp->n_events > 0 && !resp->created) {
+            watch_coalesce_add(aTHX_ wc, resp);
+            etcdserverpb__watch_response__free_unpacked(resp, NULL);
+            return;
+        }
+        /* Anything else (e.g. a progress notification) must not overtake it */
+        watch_coalesce_close(aTHX_ wc);
+    }
+
+    /* batch: fold event responses into the open batch of this pass */
+    int batchable = wc->params.batch && resp->n_events > 0 && !resp->created;
+    if (batchable && wc->batch_hv
+        && (!wc->params.max_batch || wc->batch_count + resp->n_events <= wc->params.max_batch)) {
+        SV **evp = hv_fetchs(wc->batch_hv, "events", 0);
+        SV *events = events_to_sv(aTHX_ resp->events, resp->n_events, wc->params.format);
+        append_events_sv(aTHX_ *evp, events);
+        SvREFCNT_dec(events);
+        add_header_to_hv(aTHX_ wc->batch_hv, resp->header);
+        hv_store(wc->batch_hv, "compact_revision", 16, newSViv(resp->compact_revision), 0);
+        wc->batch_count += resp->n_events;
+        wc->held_events += resp->n_events;
+        etcdserverpb__watch_response__free_unpacked(resp, NULL);
+        return;
+    }
+
     HV *result = newHV();
     add_header_to_hv(aTHX_ result, resp->header);
 
@@ -128,18 +804,64 @@ void process_watch_response(pTHX_ watch_call_t *wc) {
     hv_store(result, "canceled", 8, newSViv(resp->canceled), 0);
     hv_store(result, "compact_revision", 16, newSViv(resp->compact_revision), 0);
 
-    AV *events = newAV();
-    if (resp->n_events > 0) {
-        av_extend(events, resp->n_events - 1);
-    }
-    for (size_t i = 0; i < resp->n_events; i++) {
-        av_push(events, event_to_hashref(aTHX_ resp->events[i]));
-    }
-    hv_store(result, "events", 6, newRV_noinc((SV *)events), 0);
+    hv_store(result, "events", 6,
+             events_to_sv(aTHX_ resp->events, resp->n_events, wc->params.format), 0);
 
+    size_t resp_n_events = resp->n_events;
     etcdserverpb__watch_response__free_unpacked(resp, NULL);
 
-    CALL_SUCCESS_CALLBACK(wc->callback, result);
+    defer_stream_result(aTHX_ &wc->deferred, result);
+    wc->held_events += resp_n_events;
+
+    /* Only event responses open a batch; anything else closes it */
+    wc->batch_hv = batchable ? result : NULL;
+    wc->batch_count = batchable ? resp_n_events : 0;
+}
+
+/*
+ * In a forked child, after the client has a channel of its own: start
+ * the watch again where the parent's stream left off, or with restore
+ * unset drop it without a callback. A resync or snapshot that was in
+ * flight is read again from its first page.
+ */
+void watch_after_fork(pTHX_ watch_call_t *wc, int restore) {
+    FORGET_INHERITED_CALL(wc);
+    wc->recv_parked = 0;
+    wc->reconnect_attempt = 0;
+
+    if (!restore || !wc->active) {
+        wc->active = 0;
+        cleanup_watch(aTHX_ wc);
+        return;
+    }
+
+    if (!wc->resyncing) {
+        if (!watch_restart_stream(aTHX_ wc)) {
+            watch_deliver_deferred(aTHX_ wc, 0);
+            CALL_SIMPLE_ERROR_CALLBACK(wc->callback, "Watch restart after fork failed");
+            cleanup_watch(aTHX_ wc);
+        }
+        return;
+    }
+
+    if (wc->resync_seen) {
+        SvREFCNT_dec((SV *)wc->resync_seen);
+        wc->resync_seen = NULL;
+    }
+    if (wc->resync_events) {
+        SvREFCNT_dec(wc->resync_events);
+        wc->resync_events = NULL;
+    }
+    if (wc->resync_phase == 2) {
+        if (!watch_sync_start(aTHX_ wc)) {
+            watch_resync_error(aTHX_ wc, GRPC_STATUS_UNAVAILABLE, "Watch sync failed", 17);
+        }
+    } else {
+        watch_resync_start(aTHX_ wc, wc->resync_since, wc->resync_compact);
+    }
+    if (!wc->active) {
+        cleanup_watch(aTHX_ wc);
+    }
 }
 
 /* Try to reconnect a watch after stream ended */
@@ -156,6 +878,13 @@ int try_reconnect_watch(pTHX_ watch_call_t *wc) {
 
     wc->reconnect_attempt++;
 
+    return watch_restart_stream(aTHX_ wc);
+}
+
+/* Replace the watch's stream with a new one resuming after last_revision */
+static int watch_restart_stream(pTHX_ watch_call_t *wc) {
+    ev_etcd_t *client = wc->client;
+
     /* Cleanup and reinitialize streaming state */
     STREAMING_CALL_CLEANUP(wc);
     STREAMING_CALL_REINIT(wc);
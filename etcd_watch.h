@@ -9,7 +9,13 @@
 /* Watch operation handlers */
 void process_watch_response(pTHX_ watch_call_t *wc);
 void watch_rearm_recv(pTHX_ watch_call_t *wc);
+void watch_unpark_cancelled(watch_call_t *wc);
 void cleanup_watch(pTHX_ watch_call_t *wc);
+void watch_deliver_deferred(pTHX_ watch_call_t *wc, int only_active);
 int try_reconnect_watch(pTHX_ watch_call_t *wc);
+void process_watch_resync_response(pTHX_ pending_call_t *pc, int success);
+int watch_sync_start(pTHX_ watch_call_t *wc);
+int watch_resume_at(pTHX_ watch_call_t *wc, int64_t revision);
+void watch_after_fork(pTHX_ watch_call_t *wc, int restore);
 
 #endif /* ETCD_WATCH_H */
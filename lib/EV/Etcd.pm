@@ -1,6 +1,7 @@
 package EV::Etcd;
 use strict;
 use warnings;
+use Carp ();
 
 our $VERSION = '0.02';
 
@@ -15,8 +16,8 @@ no warnings 'redefine';
 *txn = sub {
     my $self = shift;
 
-    # If called with positional args (4 args: compare, success, failure, callback), pass through
-    if (@_ == 4 && ref($_[0]) eq 'ARRAY') {
+    # If called with positional args (compare, success, failure, [opts,] callback), pass through
+    if ((@_ == 4 || @_ == 5) && ref($_[0]) eq 'ARRAY') {
         return $_xs_txn->($self, @_);
     }
 
@@ -34,10 +35,415 @@ no warnings 'redefine';
     my $success = $args{success} // [];
     my $failure = $args{failure} // [];
 
+    if (defined $args{timeout}) {
+        return $_xs_txn->($self, $compare, $success, $failure,
+                          { timeout => $args{timeout} }, $callback);
+    }
     return $_xs_txn->($self, $compare, $success, $failure, $callback);
 };
 use warnings 'redefine';
 
+# fork() with the atfork hooks run around it
+sub fork {
+    my ($class, %opts) = @_;
+
+    $class->atfork_prepare;
+    my $pid = CORE::fork();
+    if (!defined $pid || $pid) {
+        $class->atfork_parent;
+    } else {
+        $class->atfork_child(%opts);
+    }
+    return $pid;
+}
+
+# Lock keys follow the server's Lock: "$name/<lease in hex>", oldest wins
+sub _lock_txn {
+    my ($self, $name, $lease, $callback) = @_;
+    my $key = "$name/" . sprintf('%x', $lease);
+    my $owner = { request_range => {
+        key         => "$name/",
+        range_end   => "${name}0",
+        sort_target => 'create',
+        sort_order  => 'ascend',
+        limit       => 1,
+    } };
+
+    $self->txn(
+        [ { key => $key, target => 'create', create_revision => 0 } ],
+        [ { request_put => { key => $key, value => '', lease => $lease } }, $owner ],
+        [ { request_range => { key => $key } }, $owner ],
+        sub {
+            my ($resp, $err) = @_;
+            return $callback->(undef, $err) if $err;
+            my $mine = $resp->{succeeded}
+                ? $resp->{header}{revision}
+                : $resp->{responses}[0]{response_range}{kvs}[0]{create_revision};
+            my $first = $resp->{responses}[1]{response_range}{kvs}[0];
+            $callback->({
+                key      => $key,
+                revision => $mine,
+                created  => $resp->{succeeded},
+                owner    => $first ? $first->{key} : $key,
+                acquired => !$first || $first->{create_revision} == $mine ? 1 : 0,
+                header   => $resp->{header},
+            });
+        },
+    );
+}
+
+sub try_lock {
+    my ($self, $name, $lease, $callback) = @_;
+    Carp::croak('Usage: $client->try_lock($name, $lease_id, $callback)')
+        unless ref $callback eq 'CODE';
+
+    $self->_lock_txn($name, $lease, sub {
+        my ($state, $err) = @_;
+        return $callback->(undef, $err) if $err;
+
+        my %result = (acquired => $state->{acquired}, header => $state->{header});
+        return $callback->({ %result, key => $state->{key} }) if $state->{acquired};
+
+        $result{owner} = $state->{owner};
+        return $callback->(\%result) unless $state->{created};
+
+        # Not ours: take the key we queued with back out
+        $self->delete($state->{key}, sub {
+            my (undef, $err) = @_;
+            $err ? $callback->(undef, $err) : $callback->(\%result);
+        });
+    });
+}
+
+sub lock_wait {
+    my ($self, $name, $lease, $callback) = @_;
+    Carp::croak('Usage: $client->lock_wait($name, $lease_id, $callback)')
+        unless ref $callback eq 'CODE';
+
+    $self->_lock_txn($name, $lease, sub {
+        my ($state, $err) = @_;
+        return $callback->(undef, $err) if $err;
+        return $callback->({ key => $state->{key}, header => $state->{header} })
+            if $state->{acquired};
+        $self->_lock_wait_predecessor($name, $state, $callback);
+    });
+}
+
+use constant LOCK_RECHECK => 0.1;
+
+# Wait for the newest key queued ahead of ours to go, then look again
+sub _lock_wait_predecessor {
+    my ($self, $name, $state, $callback) = @_;
+    my $fail = sub {
+        my ($err) = @_;
+        $self->delete($state->{key}, sub { $callback->(undef, $err) });
+    };
+
+    $self->get("$name/", {
+        range_end           => "${name}0",
+        sort_target         => 'create',
+        sort_order          => 'descend',
+        limit               => 1,
+        max_create_revision => $state->{revision} - 1,
+    }, sub {
+        my ($resp, $err) = @_;
+        return $fail->($err) if $err;
+
+        my $ahead = $resp->{kvs}[0];
+        return $callback->({ key => $state->{key}, header => $resp->{header} }) unless $ahead;
+
+        my $watch;
+        $watch = $self->watch($ahead->{key}, {
+            start_revision => $resp->{header}{revision} + 1,
+        }, sub {
+            my ($wresp, $werr) = @_;
+            return unless $werr || grep { $_->{type} eq 'DELETE' } @{ $wresp->{events} || [] };
+
+            $watch->cancel(sub {}) if $watch;
+            undef $watch;
+            return $self->_lock_wait_predecessor($name, $state, $callback) unless $werr;
+            return $fail->($werr) unless $werr->{compact_revision};
+
+            # Compacted before the watch started: look again shortly
+            my $timer;
+            $timer = EV::timer(LOCK_RECHECK, 0, sub {
+                undef $timer;
+                $self->_lock_wait_predecessor($name, $state, $callback);
+            });
+        });
+    });
+}
+
+sub session {
+    my ($self, %opts) = @_;
+    return EV::Etcd::Session->_new($self, %opts);
+}
+
+# One lease shared by locks, campaigns and ephemeral keys; see SESSIONS
+package EV::Etcd::Session;
+use strict;
+use warnings;
+use Carp ();
+use EV ();
+use Scalar::Util ();
+
+# Seconds between grant attempts while the session has no lease
+use constant GRANT_RETRY => 1;
+
+sub _new {
+    my ($class, $client, %opts) = @_;
+
+    my $ttl = $opts{ttl} // 60;
+    Carp::croak('session: ttl must be a positive integer')
+        unless $ttl =~ /\A[0-9]+\z/ && $ttl > 0;
+    for my $name (qw(on_ready on_lost)) {
+        Carp::croak("session: $name must be a code reference")
+            if defined $opts{$name} && ref $opts{$name} ne 'CODE';
+    }
+
+    my $self = bless {
+        client   => $client,
+        ttl      => $ttl,
+        on_ready => $opts{on_ready},
+        on_lost  => $opts{on_lost},
+        pid      => $$,
+        lease    => undef,  # Current lease, undef while (re)establishing
+        epoch    => 0,      # Bumped on every loss; older results are stale
+        queue    => [],     # Work waiting for a lease
+        held     => {},     # Locks and leaderships under the current lease
+        keys     => {},     # Ephemeral key => [value, opts, callback]
+        timer    => undef,  # Grant retry
+        grants   => 0,
+        losses   => 0,
+    }, $class;
+    $self->_grant;
+    return $self;
+}
+
+sub _error {
+    my ($message) = @_;
+    return {
+        code      => 1,
+        status    => 'CANCELLED',
+        message   => $message,
+        source    => 'session',
+        retryable => 0,
+    };
+}
+
+sub _weak {
+    my ($self) = @_;
+    Scalar::Util::weaken($self);
+    return \$self;
+}
+
+sub _grant {
+    my ($self) = @_;
+    my $weak = _weak($self);
+    my $epoch = $self->{epoch};
+    my $client = $self->{client};
+
+    $client->lease_grant($self->{ttl}, sub {
+        my ($resp, $err) = @_;
+        my $self = $$weak;
+        if (!$self || $self->{closed} || $self->{epoch} != $epoch) {
+            # Nobody wants this lease any more
+            $client->lease_revoke($resp->{id}, sub {}) unless $err;
+            return;
+        }
+
+        if ($err) {
+            # Waiting work fails now; the session keeps trying
+            my $queue = $self->{queue};
+            $self->{queue} = [];
+            $self->{timer} = EV::timer(GRANT_RETRY, 0, sub { $$weak->_grant if $$weak });
+            $_->(undef, $err) for @$queue;
+            return;
+        }
+        $self->_ready($resp->{id});
+    });
+}
+
+sub _ready {
+    my ($self, $lease) = @_;
+    my $weak = _weak($self);
+    my $epoch = $self->{epoch};
+
+    $self->{lease} = $lease;
+    $self->{grants}++;
+    $self->{client}->lease_keep($lease, sub {
+        my $self = $$weak;
+        $self->_lost($_[1]) if $self && !$self->{closed} && $self->{epoch} == $epoch;
+    });
+
+    # Ephemeral keys come back under the new lease
+    $self->_put_key($_) for sort keys %{ $self->{keys} };
+
+    my $queue = $self->{queue};
+    $self->{queue} = [];
+    $self->{on_ready}->($lease) if $self->{on_ready};
+    $_->($lease) for @$queue;
+}
+
+# The lease is gone: one new grant for everything, then tell everyone
+sub _lost {
+    my ($self, $err) = @_;
+
+    $self->{lease} = undef;
+    $self->{epoch}++;
+    $self->{losses}++;
+    $self->{lost_error} = $err;
+    my $held = $self->{held};
+    $self->{held} = {};
+    $self->_grant;
+
+    $self->{on_lost}->($err) if $self->{on_lost};
+    $held->{$_}->(undef, $err) for sort keys %$held;
+}
+
+# Run $code with the lease, now (returning what it returns) or once there is one
+sub _with_lease {
+    my ($self, $callback, $code) = @_;
+    Carp::croak('session is closed') if $self->{closed};
+
+    return $code->($self->{lease}) if defined $self->{lease};
+    push @{ $self->{queue} }, sub {
+        my ($lease, $err) = @_;
+        defined $lease ? $code->($lease) : $callback->(undef, $err);
+    };
+    return;
+}
+
+# Result for a call made under $epoch; a lease lost meanwhile voids it
+sub _stale {
+    my ($weak, $epoch) = @_;
+    my $self = $$weak;
+    return _error('Session closed') if !$self || $self->{closed};
+    return $self->{epoch} != $epoch ? $self->{lost_error} : undef;
+}
+
+sub lease { $_[0]{lease} }
+
+sub lock {
+    my ($self, $name, @args) = @_;
+    my $callback = pop @args;
+    Carp::croak('Usage: $session->lock($name, [\%opts,] $callback)')
+        unless ref $callback eq 'CODE' && @args <= 1;
+    my $weak = _weak($self);
+
+    return $self->_with_lease($callback, sub {
+        my ($lease) = @_;
+        my $epoch = $$weak->{epoch};
+        $$weak->{client}->lock($name, $lease, @args, sub {
+            my ($resp, $err) = @_;
+            return $callback->(undef, $err) if $err;
+            if (my $stale = _stale($weak, $epoch)) {
+                return $callback->(undef, $stale);
+            }
+            $$weak->{held}{"lock\0$resp->{key}"} = $callback;
+            $callback->($resp);
+        });
+    });
+}
+
+sub unlock {
+    my ($self, $key, $callback) = @_;
+    delete $self->{held}{"lock\0$key"};
+    $self->{client}->unlock($key, $callback);
+}
+
+sub campaign {
+    my ($self, $name, $value, @args) = @_;
+    my $callback = pop @args;
+    Carp::croak('Usage: $session->campaign($name, $value, [\%opts,] $callback)')
+        unless ref $callback eq 'CODE' && @args <= 1;
+    my $weak = _weak($self);
+
+    return $self->_with_lease($callback, sub {
+        my ($lease) = @_;
+        my $epoch = $$weak->{epoch};
+        $$weak->{client}->election_campaign($name, $lease, $value, @args, sub {
+            my ($resp, $err) = @_;
+            return $callback->(undef, $err) if $err;
+            if (my $stale = _stale($weak, $epoch)) {
+                return $callback->(undef, $stale);
+            }
+            $$weak->{held}{"leader\0$resp->{leader}{key}"} = $callback;
+            $callback->($resp);
+        });
+    });
+}
+
+sub resign {
+    my ($self, $leader, $callback) = @_;
+    delete $self->{held}{"leader\0$leader->{key}"};
+    $self->{client}->election_resign($leader, $callback);
+}
+
+sub put {
+    my $self = shift;
+    my $callback = ref $_[-1] eq 'CODE' ? pop : undef;
+    my ($key, $value, $opts) = @_;
+    Carp::croak('Usage: $session->put($key, $value, [\%opts,] [$callback])')
+        if !defined $value || (defined $opts && ref $opts ne 'HASH');
+    Carp::croak('session is closed') if $self->{closed};
+
+    $self->{keys}{$key} = [$value, $opts // {}, $callback];
+    $self->_put_key($key) if defined $self->{lease};
+}
+
+sub _put_key {
+    my ($self, $key) = @_;
+    my ($value, $opts, $callback) = @{ $self->{keys}{$key} };
+
+    $self->{client}->put($key, $value, { %$opts, lease => $self->{lease} }, sub {
+        $callback->(@_) if $callback;
+    });
+}
+
+sub delete {
+    my ($self, $key, $callback) = @_;
+    delete $self->{keys}{$key};
+    $self->{client}->delete($key, $callback);
+}
+
+sub stats {
+    my ($self) = @_;
+    my @held = keys %{ $self->{held} };
+    return {
+        grants  => $self->{grants},
+        losses  => $self->{losses},
+        locks   => scalar(grep { /\Alock\0/ } @held),
+        leaders => scalar(grep { /\Aleader\0/ } @held),
+        keys    => scalar(keys %{ $self->{keys} }),
+    };
+}
+
+# Revoke the lease: locks, leaderships and ephemeral keys go with it
+sub close {
+    my ($self, $callback) = @_;
+    return if $self->{closed};
+
+    $self->{closed} = 1;
+    $self->{timer} = undef;
+    $self->{held} = {};
+    $self->{keys} = {};
+    my $queue = $self->{queue};
+    $self->{queue} = [];
+    my $lease = delete $self->{lease};
+
+    $self->{client}->lease_revoke($lease, $callback // sub {}) if defined $lease;
+    $_->(undef, _error('Session closed')) for @$queue;
+}
+
+sub DESTROY {
+    my ($self) = @_;
+    return if $self->{closed} || $$ != $self->{pid} || ${^GLOBAL_PHASE} eq 'DESTRUCT';
+    $self->close;
+}
+
+package EV::Etcd;
+
 1;
 
 __END__
@@ -100,7 +506,28 @@ ArrayRef of etcd endpoints (host:port).
 
 =item timeout
 
-RPC timeout in seconds. Default is 30 seconds. Minimum value is 1 second.
+RPC timeout in seconds, fractions allowed. Default is 30 seconds. Minimum
+value is 1 millisecond; 0 or less means 1 second. Deadlines run on the
+monotonic clock, so wall clock adjustments do not cut calls short or
+stretch them.
+
+=item timeouts
+
+Per-method default timeouts, keyed by method name, overriding C<timeout>
+for those methods. 0 means no deadline. Unknown method names croak.
+
+    my $client = EV::Etcd->new(
+        timeout  => 5,
+        timeouts => { get => 0.05, put => 0.2, defragment => 600 },
+    );
+
+C<get> also covers the reads a watch makes to resync after compaction,
+C<lease_grant> the grants of L</lease_pool> and C<authenticate> the
+re-authentication of C<auto_reauth>. Methods that take an options hash
+(get, put, delete, txn, lease_grant, lease_time_to_live, compact,
+member_add, alarm, lock, election_campaign) also accept a per-call
+C<timeout> option, which wins over both. Streaming calls have no
+deadline.
 
 =item max_retries
 
@@ -139,6 +566,79 @@ token from a previous session.
         auth_token => $saved_token,
     );
 
+=item auto_reauth
+
+If true, the credentials of the last successful authenticate() are kept
+in memory, and unary calls that fail with UNAUTHENTICATED (typically an
+expired token) are parked instead of failing. A single Authenticate
+request is sent; once the new token arrives every parked call is replayed
+in order. If re-authentication fails, each parked call gets its original
+error. A call is replayed at most once. Default is false.
+
+Streaming calls (watch, lease_keepalive, election_observe) are not
+replayed; they pick up the new token when they reconnect.
+
+=item multicall
+
+Watch and keepalive responses are delivered at the end of each event
+processing pass, after the unary callbacks of that pass. When a stream
+has several responses waiting and its callback is a plain Perl sub, the
+sub is entered once and re-run for each response (the C<MULTICALL>
+interface used by L<List::Util>), which is much cheaper than a full call
+per event. Set to false to use a regular call per response, e.g. for
+callbacks that leave through C<goto &sub>. Default is true.
+
+=item lease_margin
+
+Seconds subtracted from every L</lease_remaining> estimate, to allow for
+clock drift between client and server or for work that must finish
+before the lease runs out. Default is 0.
+
+=item dedupe
+
+If true, a L</get> whose request matches one already in flight (same
+key, options, C<format> and C<raw>) sends nothing and waits for that
+call instead. The response is decoded once and every caller gets the same
+result hash, so callbacks should treat it as read-only. A joining caller
+also shares the first call's deadline; a get with its own C<timeout>
+option is never shared, in either direction. Cancelling a joined call's
+L<handle|/EV::Etcd::Call> detaches only that caller; the RPC is
+cancelled when no caller is left. Default is false. The C<dedupe> option
+of L</get> overrides it per call.
+
+=item autobatch
+
+Combine writes into transactions. Single-key L</put> and L</delete> calls
+are queued instead of sent, and the queue goes out as one L</txn> without
+compares. Each callback still gets the result its own call would have
+produced, with the transaction's header. If the transaction fails, every
+write in it fails with the same error.
+
+    my $client = EV::Etcd->new(autobatch => { max_ops => 128, max_delay => 0.001 });
+
+C<max_ops> (default 128, etcd's default C<--max-txn-ops>) caps the writes
+per transaction. C<max_delay> (default 0) is how long the first queued
+write waits for company, in seconds; with 0 the batch is sent on the next
+event loop iteration. C<< autobatch => 1 >> takes both defaults.
+
+A batch is also sent early if it would exceed 1 MiB, or before a write
+it cannot hold: a second write to a key already in the batch, a range or
+prefix delete, a write with the C<raw> or C<timeout> option, or a put
+with C<lease>, C<ignore_value> or C<ignore_lease>, which could fail the
+whole transaction for reasons of its own. Those writes are sent on their
+own right after the batch. The other calls that write (L</txn>,
+L</lease_revoke>, L</raw_call>, a prepared put's C<run>, and the lock
+and election calls) also send the queued batch before themselves. The
+batch and the call after it are separate requests, and etcd may apply
+them in either order; to order two writes, issue the second from the
+first one's callback. Reads do not flush the batch, so a L</get> may be
+answered without a write queued before it. Batched writes return no
+L<handle|/EV::Etcd::Call>. They use the C<txn> entry of C<timeouts>. A
+batch that cannot be sent fails its writes on the next event loop
+iteration, never from inside the call that sent it. Writes still queued
+when the client is destroyed are dropped without their callbacks
+running.
+
 =back
 
 =head1 ERROR HANDLING
@@ -153,6 +653,9 @@ Errors are returned as hash references with the following structure:
         retryable => 1,               # Whether the error is retryable
     }
 
+A watch that etcd cancels because its start revision was compacted
+also carries the server's C<compact_revision>.
+
 Retryable status codes include: UNAVAILABLE, RESOURCE_EXHAUSTED, ABORTED,
 INTERNAL, and DEADLINE_EXCEEDED. The client will automatically retry
 operations with these status codes according to the retry configuration.
@@ -184,6 +687,15 @@ If true, updates the lease without changing the value.
 
 If true, updates the value without changing the lease.
 
+=item raw
+
+If true, the callback receives the undecoded PutResponse protobuf bytes
+instead of a hashref. See L</raw_call>.
+
+=item timeout
+
+Deadline for this call in seconds; see C<timeouts> in L</new>.
+
 =back
 
 =head2 get
@@ -241,6 +753,41 @@ Filter keys by modification revision.
 
 Filter keys by creation revision.
 
+=item raw
+
+If true, the callback receives the undecoded RangeResponse protobuf bytes
+instead of a hashref; C<format> is ignored. See L</raw_call>.
+
+=item timeout
+
+Deadline for this call in seconds; see C<timeouts> in L</new>.
+
+=item dedupe
+
+Join an identical get already in flight instead of sending a new one,
+or with a false value never join; defaults to C<dedupe> of L</new>.
+Ignored when C<timeout> is given.
+
+=item format
+
+Shape of the C<kvs> entry in the response. The compact formats are built
+straight from the decoded protobuf and skip the per-key hashes, which
+matters for large prefix reads:
+
+    full     [ { key, value, create_revision, ... }, ... ]  (default)
+    map      { $key => $value, ... }
+    pairs    [ $key, $value, $key, $value, ... ]
+    columns  { keys => [...], values => [...], mod_revisions => [...] }
+
+With C<keys_only> the values are empty strings. C<map> loses ordering;
+use C<pairs> or C<columns> when C<sort_order> matters. An unknown format
+croaks.
+
+    $client->get('/config/', { prefix => 1, format => 'map' }, sub {
+        my ($resp, $err) = @_;
+        my $config = $resp->{kvs};   # { '/config/a' => ..., ... }
+    });
+
 =back
 
 =head2 delete
@@ -266,8 +813,58 @@ End of the key range to delete.
 
 If true, returns the deleted key-value pairs in the response.
 
+=item raw
+
+If true, the callback receives the undecoded DeleteRangeResponse protobuf
+bytes instead of a hashref. See L</raw_call>.
+
+=item timeout
+
+Deadline for this call in seconds; see C<timeouts> in L</new>.
+
 =back
 
+=head2 raw_call
+
+    $client->raw_call($method, $request_bytes, $callback);
+
+Send pre-encoded protobuf bytes to any unary etcd method and receive the
+undecoded response bytes, for proxies and caches that forward messages
+without looking inside them. C<$method> is the gRPC path, with or without
+the leading slash:
+
+    $client->raw_call('/etcdserverpb.KV/Range', $range_request, sub {
+        my ($bytes, $err) = @_;
+        $upstream->push_write($bytes) unless $err;
+    });
+
+The callback gets C<($bytes, undef)> on success and C<(undef, $error)> on
+failure, with the usual error hashref. Streaming methods (Watch,
+LeaseKeepAlive, Observe) and unknown paths croak. No decoding or hash
+building happens on either side; the response is copied once into the
+result scalar.
+
+=head2 prepare
+
+    my $req = $client->prepare(get => $key, \%opts);
+    $req->run($callback);
+
+    my $req = $client->prepare(put => $key, \%opts);
+    $req->run($value, $callback);
+
+Parse the options and serialize the request once, returning an
+EV::Etcd::Prepared object that can be run any number of times. Running a
+prepared request skips option parsing, prefix computation and protobuf
+packing; for C<put> only the value bytes are spliced into the cached
+request. C<get> takes the same options as L</get> (including C<format>),
+C<put> the same as L</put>. Callbacks receive the same responses as the
+plain methods.
+
+    my $poll = $client->prepare(get => '/jobs/', { prefix => 1, serializable => 1 });
+    my $t = EV::timer(0, 0.01, sub { $poll->run(\&handle_jobs) });
+
+The prepared object keeps the client alive until it is destroyed.
+
 =head2 watch
 
     my $watch = $client->watch($key, $callback);
@@ -278,6 +875,13 @@ Create a watch on a key or key range. Returns an EV::Etcd::Watch object.
 The callback is called with C<($response, $error)> for each watch event.
 The response contains an C<events> array with the watch events.
 
+Watch responses are held until the end of the event processing pass
+that received them, so within one pass the callbacks of unary calls
+(get, put, ...) run first even if a watch response arrived before their
+replies. A put's callback can therefore run before the callback for the
+watch event that put caused. Ordering within one watch is unchanged.
+See C<multicall> in L</new>.
+
 Options:
 
 =over 4
@@ -310,6 +914,71 @@ current revision.
 
 Optional explicit watch ID. If not specified, the server assigns one.
 
+=item format
+
+Shape of the C<events> entry, as for L</get>: C<full> (default), C<map>,
+C<pairs> or C<columns>. In the compact formats a DELETE event is a key
+with an undef value; C<columns> also carries a C<types> array of C<PUT>
+or C<DELETE>. C<prev_kv> is only available in the C<full> format.
+
+=item batch
+
+If true, event responses that arrive within one event processing pass
+are merged, so the callback runs once with all their C<events> (in
+revision order) and the C<header> and C<compact_revision> of the last
+response. With C<map> format a key changed several times keeps its latest
+value. Responses without events, such as the creation notice and progress
+notifications, are delivered on their own. Under bursty write load this
+turns many callbacks into a few.
+
+=item max_batch
+
+Implies C<batch>, and caps the number of events merged into one callback.
+A single response is never split, so a callback may still carry more
+than C<max_batch> events if the server sent them together.
+
+=item coalesce
+
+A window in seconds (fractions allowed). The first event opens the window;
+until it closes only the newest event of each key is kept (a DELETE
+replaces an earlier PUT and vice versa), and then the callback runs once
+with those events in revision order and the latest C<header>. Meant for
+consumers that only need the current state of each key: memory and
+callbacks follow the number of distinct keys, not the number of writes.
+A response without events closes the window early so it is never
+overtaken, and a pending window is delivered before the watch's final
+error. Takes precedence over C<batch>.
+
+    my $watch = $client->watch('/config/', {
+        prefix   => 1,
+        coalesce => 0.2,
+        format   => 'map',
+    }, sub {
+        my ($resp, $err) = @_;
+        apply_config($resp->{events}) unless $err;   # key => latest value
+    });
+
+=item recover_compaction
+
+If etcd cancels the watch because the revision it must resume from has
+been compacted (typically after a long disconnect, or a C<start_revision>
+that is too old), re-read the watched range instead of failing. The range
+is paged at the current revision: keys only, to find keys the watch
+reported earlier that no longer exist, then the values of keys modified
+since the last revision seen. The callback receives one synthetic
+response with C<< resync => 1 >>, the server's C<compact_revision>, PUT
+events for changed keys and DELETE events for vanished ones, after which
+the watch resumes from that revision. Deletions are only detected for
+keys this watch has reported; the set is kept in memory while the option
+is on.
+
+=item max_pending_events
+
+Pause the watch automatically while this many events are held
+undelivered (in a C<batch> pass or a C<coalesce> window); receiving
+resumes once they have been delivered. Bounds the memory a burst can
+take. See L</pause>.
+
 =item auto_reconnect
 
 If true, the watch will automatically reconnect after a connection failure,
@@ -330,6 +999,102 @@ long-running watches that should survive network interruptions.
 
 =back
 
+=head2 sync
+
+    my $watch = $client->sync($prefix, [\%options,] $on_chunk, $on_event);
+
+Load every key under C<$prefix> and then watch it, without a gap between
+the two. The range is read in pages of C<page_size> keys, all pinned to
+the revision of the first page, and each page is passed to
+C<$on_chunk> as it arrives:
+
+    {
+        kvs      => [ ... ],   # in the requested format
+        more     => 1,         # 0 on the last page
+        revision => 1234,      # snapshot revision
+        header   => { ... },
+    }
+
+After the last page the watch starts at the snapshot revision plus one
+on the same channel and C<$on_event> receives watch responses exactly as
+with L</watch>. An empty C<$prefix> covers the whole keyspace. Returns an
+EV::Etcd::Watch; cancelling it during the snapshot stops the paging.
+
+An error while loading is passed to C<$on_chunk> as C<(undef, $error)>
+and ends the sync; errors after the watch started go to C<$on_event>.
+
+Options are C<page_size> (default 1000), C<format>, and the delivery
+options of L</watch>: C<prev_kv>, C<progress_notify>, C<auto_reconnect>,
+C<batch>, C<max_batch>, C<coalesce>, C<max_pending_events> and
+C<recover_compaction>. With C<recover_compaction> the snapshot also
+seeds the set of keys the watch knows about.
+
+    my %config;
+    my $watch = $client->sync('/config/', { format => 'map' }, sub {
+        my ($chunk, $err) = @_;
+        die $err->{message} if $err;
+        %config = (%config, %{ $chunk->{kvs} });
+        start_service(\%config) unless $chunk->{more};
+    }, sub {
+        my ($resp, $err) = @_;
+        apply_events(\%config, $resp->{events}) unless $err;
+    });
+
+=head2 cache
+
+    my $cache = $client->cache($prefix, [\%options,] $callback);
+
+Keep a local copy of every key under C<$prefix> and read it
+synchronously. The prefix is loaded as with L</sync> and kept current by
+one watch; events are applied to a C-level hash table straight from the
+protobuf messages, with no callback per event. C<$callback> receives
+C<< { revision => $rev, keys => $n } >> each time a snapshot has been
+loaded, and C<(undef, $error)> if the watch fails for good (the cache
+then keeps serving its last contents; see C<watching> in L</stats>).
+
+If the watch falls behind a compaction the prefix is loaded again in the
+background and swapped in when complete. The cache holds a reference to
+the client; dropping the last reference to the cache stops its watch.
+
+Options: C<page_size> (default 1000), C<auto_reconnect> (default true)
+and C<progress_notify> (default true, so that C<age> also advances on a
+quiet prefix).
+
+With C<< history => $n >> the cache becomes a local replica: keys are
+also kept in key order, each with its last C<$n> versions (deletes
+included), which enables L</range> for ordered, sorted and historical
+reads. The oldest revision the replica can answer for is its L</floor>:
+the snapshot revision at first, rising as old versions of frequently
+written keys are dropped. Use a larger C<$n> to read further back.
+
+With C<< persist => $path >> the contents and their revision are saved
+to C<$path> after each full load, by L</save> and when the cache is
+destroyed. A cache created later with the same path and prefix maps the
+file, is L</ready> on return, and watches from the saved revision plus
+one, so startup fetches only what changed while the process was down.
+The callback then receives C<< { revision, keys, warm => 1 } >> once the
+watch has resumed. If the saved revision has been compacted the prefix
+is loaded in full as usual. The file is a local cache in native byte
+order; a missing or unreadable file just means a full load. Without
+C<history> only keys and values are saved, not their revisions, so a
+cache with C<history> ignores such a file and loads in full.
+
+With C<< shared => $path >> the cache also publishes its contents to a
+shared memory file (put it on a tmpfs such as F</dev/shm>) for other
+processes, which read it with L</EV::Etcd::Mirror> and need no client,
+connection or watch of their own. One process per host keeps the
+prefix current; the rest of a preforked pool just maps the file.
+Changes are published at most once per event loop iteration. The file is
+C<shared_size> bytes (default 16 MiB), half of which holds one complete
+copy of the prefix; if the contents do not fit, the previous copy stays
+and C<publish_failures> in L</stats> goes up. Use one publisher per file.
+
+    my $cache = $client->cache('/config/', sub {
+        my ($resp, $err) = @_;
+        die $err->{message} if $err;
+        start_server() if $resp->{keys};
+    });
+
 =head2 EV::Etcd::Watch Methods
 
 =head3 cancel
@@ -348,11 +1113,172 @@ cancellation is complete. The response is an empty hash reference on success.
         }
     });
 
+=head3 pause
+
+    $watch->pause;
+
+Stop receiving watch responses. The response already being received is
+still delivered, after which the next receive is not armed, so HTTP/2
+flow control throttles the server instead of events piling up in the
+process. Events are not lost; they arrive after L</resume>.
+
+=head3 resume
+
+    $watch->resume;
+
+Undo L</pause> and pick up where the watch left off.
+
+=head3 paused
+
+    if ($watch->paused) { ... }
+
+True between C<pause> and C<resume>.
+
+    # Hand events to a worker pool without letting them pile up
+    my $watch; $watch = $client->watch('/jobs/', { prefix => 1 }, sub {
+        my ($resp, $err) = @_;
+        return if $err;
+        $watch->pause if $queue->push(@{$resp->{events}}) > 1000;
+    });
+    $queue->on_drain(sub { $watch->resume });
+
+=head2 EV::Etcd::Cache Methods
+
+=head3 get
+
+    my $value = $cache->get($key);
+
+The cached value of C<$key>, or undef if the key does not exist or the
+first snapshot has not finished loading (see L</ready>). C<$key> must lie
+under the cached prefix. The value is shared with the cache and
+read-only. A hash lookup; no I/O.
+
+=head3 get_prefix
+
+    my $kvs = $cache->get_prefix($sub_prefix);   # { key => value, ... }
+
+All cached keys under C<$sub_prefix>, which must lie under the cached
+prefix. This scans the table, so it costs time in proportion to the size
+of the cache, not of the result.
+
+=head3 range
+
+    my $kvs = $cache->range($key, \%options);
+
+Read keys from a cache created with C<history>, answered locally. Like
+L</get>, a single key unless C<range_end> or C<prefix> is given, and the
+result is an array reference of C<{ key, value, create_revision,
+mod_revision, version }> hashes. Options:
+
+=over 4
+
+=item revision
+
+Read the keys as they were at this revision, which must lie between
+L</floor> and L</revision>; croaks otherwise. Default: the current
+revision.
+
+=item range_end, prefix
+
+As for L</get>.
+
+=item sort_target, sort_order
+
+C<key> (default), C<mod> or C<create>; C<ascend> (default) or
+C<descend>.
+
+=item limit
+
+Maximum number of keys returned, applied after sorting.
+
+=back
+
+    # What did the config look like before the last deploy?
+    my $old = $cache->range('/config/', { prefix => 1, revision => $rev });
+
+    # Ten most recently modified keys
+    my $recent = $cache->range('/config/', {
+        prefix => 1, sort_target => 'mod', sort_order => 'descend', limit => 10,
+    });
+
+=head3 save
+
+    $cache->save or warn "cache not saved: $!";
+
+Write the persist file now (caches created with C<persist> only).
+Returns false and sets C<$!> on failure. Saving goes through a temporary
+file renamed into place, so readers never see a partial file.
+
+=head3 floor
+
+The oldest revision L</range> can read at (0 without C<history>).
+
+=head3 revision
+
+The etcd revision the contents reflect.
+
+=head3 ready
+
+True once the first snapshot has been loaded.
+
+=head3 stats
+
+    my $s = $cache->stats;
+
+Returns a hash reference with C<hits> and C<misses> (reads answered from
+the table, and lookups of absent keys or before L</ready>), C<keys>,
+C<revision>, C<floor> (with C<history>), C<saved_revision> (with
+C<persist>), C<publishes> and C<publish_failures> (with C<shared>),
+C<loads> (1 plus reloads after compaction), C<watching>
+(false once the watch has ended) and C<age>: seconds since etcd last
+sent anything for the prefix, a bound on how stale the contents may be
+while C<watching> is true.
+
+=head2 EV::Etcd::Mirror
+
+    my $mirror = EV::Etcd::Mirror->new('/dev/shm/myapp-config');
+    my $value  = $mirror->get('/config/db/host');
+    my $all    = $mirror->get_prefix('/config/db/');
+
+Read-only view of a prefix published by a cache created with C<shared>,
+typically from preforked workers while the parent or a sidecar process
+runs the cache. Croaks if the file is missing or is not a mirror. Reads
+never block the publisher: the file holds two copies, the publisher
+rewrites the one readers are not directed to and then switches, and a
+read that overlaps a switch is simply repeated.
+
+=head3 get
+
+    my $value = $mirror->get($key);
+
+Value of C<$key>, or undef. A hash probe in shared memory.
+
+=head3 get_prefix
+
+    my $kvs = $mirror->get_prefix($prefix);
+
+Hash reference of every key under C<$prefix> (scans the table).
+
+=head3 revision
+
+The etcd revision of the published contents, 0 before the first publish.
+
+=head3 generation
+
+Number of publishes so far; cheap to poll to notice changes.
+
+=head3 ready
+
+True once something has been published.
+
 =head2 lease_grant
 
     $client->lease_grant($ttl, $callback);
+    $client->lease_grant($ttl, { timeout => 2 }, $callback);
 
-Grant a lease with the specified TTL (time-to-live) in seconds.
+Grant a lease with the specified TTL (time-to-live) in seconds. The
+optional C<timeout> is the deadline for this call in seconds; see
+C<timeouts> in L</new>.
 
 The callback receives C<($response, $error)> where response contains:
 
@@ -379,6 +1305,108 @@ Revoke a lease. All keys attached to the lease will be deleted.
     $client->lease_keepalive($lease_id, $callback);
 
 Keep a lease alive. Call this periodically to prevent the lease from expiring.
+L</lease_keep> does the periodic renewal for you. Like watch responses,
+keepalive responses are delivered at the end of the event processing
+pass, after that pass's unary callbacks.
+
+=head2 lease_keep
+
+    $client->lease_grant(10, sub {
+        my ($resp, $err) = @_;
+        $client->lease_keep($resp->{id}, { ttl => $resp->{ttl} }, sub {
+            my (undef, $err) = @_;
+            warn "lost lease: $err->{message}";
+        });
+    });
+
+    $client->lease_keep($lease_id, [\%opts,] [$on_expire]);
+
+Hand a lease to the client's lease manager, which renews it until it is
+released, revoked or lost. All managed leases share one keepalive stream
+per client. Each is renewed at a third of its TTL, with 10% jitter so
+leases granted together spread out, and renewals that fall due together
+are written back to back.
+
+C<$on_expire> is called once, as C<(undef, $error)>, if the lease is lost:
+the server reports it gone (code C<NOT_FOUND>, "Lease expired"), or its
+TTL ran out locally without a successful renewal (code C<UNAVAILABLE>).
+The lease is no longer managed by then. Managing a lease again only
+replaces the callback.
+
+Options:
+
+=over 4
+
+=item ttl
+
+The TTL the lease was just granted or renewed with. The first renewal
+then waits a third of it. Without it, the TTL this client last saw for
+the lease (see L</lease_remaining>) is used; failing that a renewal is
+sent right away and its response supplies the TTL.
+
+=back
+
+=head2 lease_release
+
+    my $was_managed = $client->lease_release($lease_id);
+
+Stop renewing a lease without revoking it; it expires after its TTL.
+L</lease_revoke> releases the lease as well.
+
+=head2 lease_remaining
+
+    my $seconds = $client->lease_remaining($lease_id);
+    my $seconds = $client->lease_remaining($lease_id, $margin);
+
+Seconds left on a lease, estimated locally without a round-trip. The
+client remembers the TTL of every lease it granted (L</lease_grant>,
+L</lease_pool>), renewed (L</lease_keep>, L</lease_keepalive>) or
+looked up (L</lease_time_to_live>), together with the monotonic time the
+request went out. The server starts counting no earlier than that, so
+the estimate errs on the short side.
+
+C<$margin> (default: the C<lease_margin> given to L</new>) is subtracted
+from the estimate, which never goes below 0. Undef if the client has no
+record of the lease; only then is L</lease_time_to_live> needed. Revoked
+leases and leases the server reported gone are forgotten.
+
+=head2 lease_pool
+
+    my $pool = $client->lease_pool(ttl => 30, size => 16);
+
+    # later, per request: one round-trip instead of two
+    my $lease = $pool->take // return defer_until_refilled();
+    $client->put("/locks/req-$id", $owner, { lease => $lease }, sub { ... });
+
+Keep C<size> leases (default 8) granted ahead of use, renewed by the
+lease manager (see L</lease_keep>) while they sit idle. Taking one is
+O(1) and starts a grant to replace it in the background, so creating an
+ephemeral key costs a single put. Croaks on a non-positive C<ttl> or a
+C<size> outside 1..100000.
+
+A taken lease stays managed and belongs to the caller: attach a loss
+callback with C<lease_keep($lease, $cb)>, and end it with
+C<lease_revoke>. When the pool object is destroyed its idle leases are
+released and expire after their TTL.
+
+=head2 EV::Etcd::LeasePool Methods
+
+=head3 take
+
+    my $lease_id = $pool->take;
+
+An idle lease, or undef when the pool has run dry (refills are in
+flight). Idle leases that were lost meanwhile are skipped.
+
+=head3 available
+
+Number of idle leases.
+
+=head3 stats
+
+Hash reference with C<available>, C<granting> (grants in flight),
+C<size>, C<ttl>, C<taken>, C<granted>, C<failures> (failed grants,
+retried after a second) and C<lost> (idle leases lost before use).
 
 =head2 lease_time_to_live
 
@@ -417,6 +1445,10 @@ Options:
 
 If true, also return the list of keys attached to this lease.
 
+=item timeout
+
+Deadline for this call in seconds; see C<timeouts> in L</new>.
+
 =back
 
 =head2 lease_leases
@@ -464,6 +1496,10 @@ If true, the RPC will wait until the compaction is physically applied
 to the local database such that compacted entries are totally removed
 from the backend database. Default is false.
 
+=item timeout
+
+Deadline for this call in seconds; see C<timeouts> in L</new>.
+
 =back
 
 =head2 status
@@ -515,6 +1551,191 @@ Array of any errors on this member (if any).
 
 =back
 
+=head1 FORKING
+
+    BEGIN { $ENV{GRPC_ENABLE_FORK_SUPPORT} = 1 }   # before EV::Etcd loads
+    use EV::Etcd;
+
+    my $client = EV::Etcd->new(endpoints => \@endpoints);
+    my $cache  = $client->cache('/config/', sub { ... });
+    EV::run until $cache->ready;
+
+    for (1 .. $workers) {
+        my $pid = EV::Etcd->fork;      # or atfork_* around your own fork
+        next if $pid;
+        # child: same $client and $cache, on its own connection
+        serve();
+    }
+
+gRPC state does not survive C<fork>: the completion queue thread is not
+copied into the child and the channel's connections would be shared with
+the parent. Clients built before a fork are usable in the child once the
+hooks below have run, so a preforking server can create the client, fill
+its caches in the master and fork warm workers.
+
+gRPC's own fork handling must be enabled by setting
+C<GRPC_ENABLE_FORK_SUPPORT=1> in the environment before EV::Etcd is
+loaded; C<atfork_prepare> croaks otherwise. A child that never calls
+C<atfork_child> must not use its inherited clients, but destroying them
+is safe and leaves the parent's connections alone.
+
+=head2 atfork_prepare
+
+    EV::Etcd->atfork_prepare;
+
+Call in the parent right before C<fork>. Stops the completion queue
+thread of every client (waiting up to 100ms for them to notice). Croaks
+when called from inside an EV::Etcd callback; defer the fork to the
+next loop iteration instead.
+
+=head2 atfork_parent
+
+    EV::Etcd->atfork_parent;
+
+Call in the parent after C<fork>, also when it failed. Restarts the
+threads; replies that arrived meanwhile are delivered as usual.
+
+=head2 atfork_child
+
+    EV::Etcd->atfork_child(watches => 1, keepalives => 0);
+
+Call in the child right after C<fork>. Runs C<loop_fork> on the default
+EV loop, then gives every client a new channel to its current endpoint,
+a new completion queue and a new thread. The inherited gRPC objects are
+abandoned without being touched.
+
+Requests still in flight belong to the parent: their callbacks never run
+in the child. Streams are handled per option:
+
+=over 4
+
+=item watches
+
+Default 1. Watches (including those behind C<sync> and C<cache>) and
+election observers are started again on the new channel, resuming after
+the last revision they delivered. A snapshot or compaction resync that
+was in progress is read again from the start. With 0 they are dropped
+without a callback.
+
+=item keepalives
+
+Default 0. The parent keeps its leases alive; pass 1 for the child to
+send keepalives for them as well, both from C<lease_keepalive> streams
+and for leases given to C<lease_keep>. Otherwise they are dropped without
+a callback.
+
+=back
+
+A cache's C<shared> mirror keeps a single writer, the parent; the child's
+copy of the cache stops publishing to it.
+
+=head2 fork
+
+    my $pid = EV::Etcd->fork(%atfork_child_opts);
+
+C<fork> wrapped in the three hooks above. Returns what C<fork> returns.
+
+=head1 SESSIONS
+
+    my $session = $client->session(
+        ttl      => 10,
+        on_lost  => sub { my ($err) = @_; warn "session lost: $err->{message}" },
+        on_ready => sub { my ($lease_id) = @_; ... },
+    );
+
+    $session->lock('jobs', sub {
+        my ($resp, $err) = @_;
+        # called again as (undef, $err) if the session is lost while held
+    });
+    $session->put("/members/$host", $addr);   # back after every re-grant
+
+A session owns one lease, renewed by the lease manager (see
+L</lease_keep>), and binds locks, leaderships and ephemeral keys to it.
+Work started before the lease is granted waits for it.
+
+When the lease is lost, the session grants a single new one for all of
+them. C<on_lost> is called once, then the callback of every lock and
+leadership held under the old lease gets C<(undef, $error)>. They are not
+reacquired. Ephemeral keys are put again under the new lease, and their
+callbacks run again with the new put response. C<on_ready> is called
+with the lease id each time a lease has been granted. If a grant fails,
+the work waiting for it fails with the grant error and the session
+retries every second.
+
+The session is closed (its lease revoked) when it is destroyed, except
+in a forked child.
+
+=head2 session
+
+    my $session = $client->session(%options);
+
+Options:
+
+=over 4
+
+=item ttl
+
+TTL of the session's lease in seconds. Default is 60.
+
+=item on_ready
+
+Called with C<($lease_id)> whenever a lease has been granted.
+
+=item on_lost
+
+Called with C<($error)> once per lost lease, before the dependents.
+
+=back
+
+=head2 EV::Etcd::Session Methods
+
+=over 4
+
+=item lease
+
+The current lease id, undef while one is being granted.
+
+=item lock($name, [\%opts,] $callback)
+
+L</lock> under the session's lease; C<%opts> as for L</lock>. Returns
+the call's L<handle|/EV::Etcd::Call> in non-void context, or undef while
+the lock waits for a lease.
+
+=item unlock($key, $callback)
+
+Release a lock taken through the session.
+
+=item campaign($name, $value, [\%opts,] $callback)
+
+L</election_campaign> under the session's lease. Returns a handle like
+C<lock>.
+
+=item resign($leader, $callback)
+
+Give up a leadership won through the session.
+
+=item put($key, $value, [\%opts,] [$callback])
+
+Put a key attached to the session's lease, and put it again after every
+re-grant. C<%opts> are passed to L</put>.
+
+=item delete($key, $callback)
+
+Delete an ephemeral key and stop restoring it.
+
+=item close([$callback])
+
+Revoke the lease, which releases every lock, leadership and ephemeral key
+at once. Work still waiting for a lease fails with C<CANCELLED>
+(source C<session>); the dependents' callbacks are not called.
+
+=item stats
+
+Hash reference with C<grants>, C<losses>, and the number of C<locks>,
+C<leaders> and ephemeral C<keys> currently held.
+
+=back
+
 =head1 LOCK SERVICE
 
 EV::Etcd provides distributed locking through the etcd Lock service.
@@ -524,6 +1745,8 @@ is automatically released.
 =head2 lock
 
     $client->lock($name, $lease_id, $callback);
+    $client->lock($name, $lease_id, \%opts, $callback);
+    my $call = $client->lock($name, $lease_id, { timeout => 0 }, $callback);
 
 Acquire a distributed lock.
 
@@ -593,6 +1816,54 @@ Example:
         });
     });
 
+Options:
+
+=over 4
+
+=item timeout
+
+Deadline for this call in seconds (fractions allowed), instead of the
+client's C<timeout>. 0 waits for as long as it takes. Waiting on a
+contended lock then needs neither a short deadline nor a large client
+timeout that would also slow down failure detection for other calls.
+
+=back
+
+Called in non-void context, C<lock> returns an L</EV::Etcd::Call> handle
+that can give up the wait.
+
+=head2 EV::Etcd::Call
+
+    my $call = $client->lock($name, $lease_id, { timeout => 0 }, $cb);
+    ...
+    $call->cancel;   # $cb gets (undef, $error) with status CANCELLED
+
+Handle on a call in flight. Every unary method (get, put, delete, txn,
+the lease, auth, cluster and maintenance calls, L</raw_call>, prepared
+C<run>, L</lock> and L</election_campaign>) returns one when called in
+non-void context; in void context none is built. Dropping the handle does
+not cancel the call.
+
+    my $call = $client->get($key, sub { ... });
+    $call->cancel if $upstream_gone;
+
+=over 4
+
+=item cancel
+
+Cancel the call. The callback still runs once, with an error of code
+C<CANCELLED>. A response that arrived before the cancel took effect is
+discarded without being decoded, except for L</lock> and
+L</election_campaign>, which deliver the key they obtained so it can be
+released. The request itself may still have been applied by the server.
+Returns true if the call was still in flight.
+
+=item active
+
+True until the callback has run.
+
+=back
+
 =head2 unlock
 
     $client->unlock($key, $callback);
@@ -628,6 +1899,42 @@ B<Note>: You can also release a lock by revoking its associated lease with
 C<lease_revoke>. This is useful if you want to release all resources
 associated with a lease at once.
 
+=head2 try_lock
+
+    $client->try_lock($name, $lease_id, sub {
+        my ($resp, $err) = @_;
+        if ($resp && $resp->{acquired}) {
+            # ... protected work, then $client->unlock($resp->{key}, ...)
+        } elsif ($resp) {
+            warn "busy, held through $resp->{owner}";
+        }
+    });
+
+Take a lock only if it is free, without waiting. One transaction creates
+the lock key (C<< "$name/<lease id in hex>" >>, as L</lock> does) if it
+does not exist yet, and reads the oldest key under the name, which is
+the owner's. No server-side waiter is left behind. If someone else owns
+the lock, the key is deleted again.
+
+The response contains C<acquired> (1 or 0) and C<header>, plus C<key>
+(for L</unlock>) when acquired or C<owner> (the owner's key) when not.
+Locks taken with C<try_lock>, L</lock_wait> and L</lock> exclude each
+other. A lease that already holds the lock acquires it again.
+
+=head2 lock_wait
+
+    $client->lock_wait($name, $lease_id, $callback);
+
+Like L</lock>, but the waiting is done by this client. The caller queues
+its key as L</try_lock> does, then watches only the key queued right
+before its own and looks again once that key is deleted. No call stays
+open on the server while the lock is busy. Waiters are served in order,
+and a release wakes only the next waiter. The callback gets
+C<($response, $error)> once the lock is held. The response has the same
+C<key> and C<header> as from L</lock>. A watch that etcd cancels because
+its start was compacted is retried after a short pause; any other error
+is passed to the callback, and the queued key is deleted.
+
 =head1 AUTHENTICATION SERVICE
 
 EV::Etcd provides full support for etcd's authentication and authorization
@@ -1075,6 +2382,10 @@ specific member. Use 0 for all members.
 The alarm type. Can be "NOSPACE" (storage quota exceeded) or "CORRUPT"
 (data corruption detected). Default is "NONE" which means all alarms.
 
+=item timeout
+
+Deadline for this call in seconds; see C<timeouts> in L</new>.
+
 =back
 
 The response contains:
@@ -1294,11 +2605,14 @@ when a leader fails.
 =head2 election_campaign
 
     $client->election_campaign($name, $lease_id, $value, $callback);
+    my $call = $client->election_campaign($name, $lease_id, $value, \%opts, $callback);
 
 Campaign for leadership of an election.
 
 This call blocks until the caller is elected as leader. Once elected, the
 caller should periodically keep the lease alive to maintain leadership.
+It takes the same C<timeout> option as L</lock> and, in non-void context,
+returns an L</EV::Etcd::Call> handle to withdraw from the campaign.
 
 Arguments:
 
@@ -1627,6 +2941,10 @@ Options:
 
 If true, add the member as a non-voting learner.
 
+=item timeout
+
+Deadline for this call in seconds; see C<timeouts> in L</new>.
+
 =back
 
 =head2 member_remove
@@ -1657,15 +2975,17 @@ EV::Etcd supports atomic transactions with compare-and-swap semantics.
         compare => \@compare_ops,
         success => \@success_ops,
         failure => \@failure_ops,
+        timeout => 2,               # optional
         callback => $callback,
     );
 
     # Or positional form:
-    $client->txn(\@compare, \@success, \@failure, $callback);
+    $client->txn(\@compare, \@success, \@failure, [\%opts,] $callback);
 
 Execute an atomic transaction. If all compare operations succeed, the
 success operations are executed; otherwise, the failure operations are
-executed.
+executed. C<timeout> is the deadline for this call in seconds; see
+C<timeouts> in L</new>.
 
 Compare operations:
 
@@ -1684,6 +3004,11 @@ Request operations (for success/failure):
     { request_delete_range => { key => $key } }
     { request_range => { key => $key } }
 
+A C<request_range> op accepts the same C<format> option as L</get>, which
+applies to the C<kvs> of its C<response_range>, as well as C<limit>,
+C<revision>, C<sort_order>, C<sort_target>, C<keys_only>,
+C<count_only>, C<serializable> and the C<min_>/C<max_> revision bounds.
+
 Example:
 
     $client->txn(
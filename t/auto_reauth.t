@@ -0,0 +1,153 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use lib 'blib/lib', 'blib/arch';
+use Test::More;
+
+# auto_reauth: calls failing with an invalidated token are replayed after
+# a transparent re-authentication. Tokens are invalidated by disabling and
+# re-enabling auth, so this is DESTRUCTIVE like t/auth_enable_disable.t.
+#
+# To run these tests:
+#   ETCD_TEST_AUTH_ENABLE_DISABLE=1 prove -lv t/auto_reauth.t
+
+BEGIN {
+    unless ($ENV{ETCD_TEST_AUTH_ENABLE_DISABLE}) {
+        plan skip_all => 'Set ETCD_TEST_AUTH_ENABLE_DISABLE=1 to run auto_reauth tests (destructive)';
+    }
+    eval { require EV };
+    plan skip_all => 'EV required' if $@;
+}
+
+use EV;
+use EV::Etcd;
+
+
+# Check if etcd is available
+my $etcd_available = 0;
+eval {
+    my $client = EV::Etcd->new(
+        endpoints => ['127.0.0.1:2379'],
+        timeout => 2,
+    );
+    $client->status(sub {
+        my ($resp, $err) = @_;
+        $etcd_available = 1 if !$err;
+        EV::break;
+    });
+    my $t = EV::timer(3, 0, sub { EV::break });
+    EV::run;
+};
+
+plan skip_all => 'etcd not available on 127.0.0.1:2379' unless $etcd_available;
+
+# Check if auth is already enabled
+my $auth_enabled = 0;
+{
+    my $client = EV::Etcd->new(endpoints => ['127.0.0.1:2379']);
+    $client->auth_status(sub {
+        my ($resp, $err) = @_;
+        $auth_enabled = $resp->{enabled} if !$err && $resp;
+        EV::break;
+    });
+    my $t = EV::timer(3, 0, sub { EV::break });
+    EV::run;
+}
+
+if ($auth_enabled) {
+    plan skip_all => 'Auth already enabled - cannot run enable/disable tests';
+}
+
+my $client = EV::Etcd->new(endpoints => ['127.0.0.1:2379']);
+my $root_password = "root-reauth-pwd-$$-" . time();
+my $key = "/test-reauth-$$-" . time();
+my $old_token;
+my $reauth;
+my $auth_on = 0;
+
+sub run_with_timeout {
+    my $t = EV::timer(5, 0, sub { fail('timeout'); EV::break });
+    EV::run;
+}
+
+# Best effort: leave the cluster with auth disabled
+END {
+    if ($reauth && $auth_on) {
+        $reauth->auth_disable(sub { EV::break });
+        my $t = EV::timer(5, 0, sub { EV::break });
+        EV::run;
+    }
+}
+
+$client->user_add('root', $root_password, sub {
+    ok(!$_[1], 'root user created');
+    $client->user_grant_role('root', 'root', sub {
+        ok(!$_[1], 'root role granted');
+        $client->auth_enable(sub {
+            ok(!$_[1], 'auth enabled');
+            $auth_on = 1 unless $_[1];
+            EV::break;
+        });
+    });
+});
+run_with_timeout();
+
+$reauth = EV::Etcd->new(endpoints => ['127.0.0.1:2379'], auto_reauth => 1);
+$reauth->authenticate('root', $root_password, sub {
+    my ($resp, $err) = @_;
+    ok(!$err, 'authenticated');
+    $old_token = $resp->{token} if $resp;
+    $reauth->put($key, 'before', sub {
+        ok(!$_[1], 'put with initial token');
+        EV::break;
+    });
+});
+run_with_timeout();
+
+# Invalidate every token: disable (needs root) and re-enable (auth is off)
+$reauth->auth_disable(sub {
+    ok(!$_[1], 'auth disabled');
+    $client->auth_enable(sub {
+        ok(!$_[1], 'auth re-enabled');
+        EV::break;
+    });
+});
+run_with_timeout();
+
+# Without auto_reauth the stale token is rejected
+my $stale = EV::Etcd->new(endpoints => ['127.0.0.1:2379'], auth_token => $old_token);
+$stale->get($key, sub {
+    my ($resp, $err) = @_;
+    ok($err, 'stale token rejected without auto_reauth');
+    is($err->{code}, 16, 'error is UNAUTHENTICATED') if $err;
+    EV::break;
+});
+run_with_timeout();
+
+# Several calls in flight: all replayed after a single re-authentication
+my $done = 0;
+for my $i (1..3) {
+    $reauth->get($key, sub {
+        my ($resp, $err) = @_;
+        ok(!$err, "call $i replayed after re-authentication");
+        is($resp->{kvs}[0]{value}, 'before', "call $i sees the data") if $resp;
+        EV::break if ++$done == 3;
+    });
+}
+run_with_timeout();
+
+# Cleanup
+$reauth->delete($key, sub {
+    ok(!$_[1], 'key deleted');
+    $reauth->auth_disable(sub {
+        ok(!$_[1], 'auth disabled');
+        $auth_on = 0 unless $_[1];
+        $client->user_delete('root', sub {
+            ok(!$_[1], 'root user deleted');
+            EV::break;
+        });
+    });
+});
+run_with_timeout();
+
+done_testing();
@@ -0,0 +1,134 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use lib 'blib/lib', 'blib/arch';
+use Test::More;
+
+BEGIN {
+    eval { require EV };
+    plan skip_all => 'EV required' if $@;
+}
+
+use EV;
+use EV::Etcd;
+
+# Check if etcd is available
+my $etcd_available = 0;
+eval {
+    my $client = EV::Etcd->new(
+        endpoints => ['127.0.0.1:2379'],
+        timeout => 2,
+    );
+    $client->status(sub {
+        my ($resp, $err) = @_;
+        $etcd_available = 1 if !$err;
+        EV::break;
+    });
+    my $t = EV::timer(3, 0, sub { EV::break });
+    EV::run;
+};
+plan skip_all => 'etcd not available on 127.0.0.1:2379' unless $etcd_available;
+
+my $client = EV::Etcd->new(
+    endpoints => ['127.0.0.1:2379'],
+);
+
+my $prefix = "/test-autobatch-$$-" . time();
+
+sub run_with_timeout {
+    my $t = EV::timer(5, 0, sub { fail('timeout'); EV::break });
+    EV::run;
+}
+
+eval { EV::Etcd->new(autobatch => { max_ops => 0 }) };
+like($@, qr/max_ops must be at least 1/, 'max_ops validated');
+eval { EV::Etcd->new(autobatch => { max_delay => -1 }) };
+like($@, qr/max_delay must not be negative/, 'max_delay validated');
+
+my $batched = EV::Etcd->new(endpoints => ['127.0.0.1:2379'], autobatch => 1);
+
+# Writes of one tick share a transaction, each with its own result
+my @results;
+my $handle = $batched->put("$prefix/k0", 'v0', sub { push @results, [@_] });
+$batched->put("$prefix/k$_", "v$_", sub { push @results, [@_]; EV::break if @results == 20 })
+    for 1 .. 19;
+ok(!defined $handle, 'batched write returns no handle');
+run_with_timeout();
+is(scalar @results, 20, 'every write answered');
+ok(!grep({ $_->[1] } @results), 'no errors');
+my %revs = map { $_->[0]{header}{revision} => 1 } @results;
+is(scalar keys %revs, 1, 'one transaction, one revision');
+
+my $resp;
+$client->get("$prefix/k", { prefix => 1, count_only => 1 }, sub { $resp = $_[0]; EV::break });
+run_with_timeout();
+is($resp->{count}, 20, 'all keys written');
+
+# Per-write options and deletes
+my ($put, $del);
+$batched->put("$prefix/k1", 'new', { prev_kv => 1 }, sub { $put = $_[0] });
+$batched->delete("$prefix/k2", sub { $del = $_[0]; EV::break });
+run_with_timeout();
+is($put->{prev_kv}{value}, 'v1', 'prev_kv of a batched put');
+is($del->{deleted}, 1, 'batched delete');
+is($put->{header}{revision}, $del->{header}{revision}, 'put and delete in one transaction');
+
+# A key written twice splits the batch
+my @twice;
+$batched->put("$prefix/dup", 'first', sub { push @twice, $_[0]; EV::break if @twice == 2 });
+$batched->put("$prefix/dup", 'second', sub { push @twice, $_[0]; EV::break if @twice == 2 });
+run_with_timeout();
+is(scalar @twice, 2, 'both writes answered');
+isnt($twice[0]{header}{revision}, $twice[1]{header}{revision}, 'in separate transactions');
+
+# max_ops caps the transaction size
+my $small = EV::Etcd->new(endpoints => ['127.0.0.1:2379'], autobatch => { max_ops => 3 });
+@results = ();
+$small->put("$prefix/s$_", $_, sub { push @results, $_[0]; EV::break if @results == 7 })
+    for 1 .. 7;
+run_with_timeout();
+%revs = ();
+$revs{ $_->{header}{revision} }++ for @results;
+is_deeply([sort { $a <=> $b } values %revs], [1, 3, 3], 'split into 3 + 3 + 1');
+
+# max_delay holds the batch open across loop iterations
+my $slow = EV::Etcd->new(endpoints => ['127.0.0.1:2379'], autobatch => { max_delay => 0.2 });
+@results = ();
+$slow->put("$prefix/d1", 1, sub { push @results, $_[0]; EV::break if @results == 2 });
+my $later = EV::timer(0.05, 0, sub {
+    $slow->put("$prefix/d2", 2, sub { push @results, $_[0]; EV::break if @results == 2 });
+});
+run_with_timeout();
+is($results[0]{header}{revision}, $results[1]{header}{revision}, 'writes within max_delay combined');
+
+# A txn sends the queued batch, which no longer waits for its timer
+my ($queued, $txn);
+$slow->put("$prefix/queued", 'v', sub { $queued = $_[0]; EV::break if $txn });
+$slow->txn(
+    compare => [],
+    success => [],
+    sub { $txn = $_[0]; EV::break if $queued },
+);
+my $t0 = EV::time;
+run_with_timeout();
+ok($queued && $txn, 'batched put and txn answered');
+cmp_ok(EV::time - $t0, '<', 0.2, 'batch sent with the txn, before max_delay');
+
+# A put with an unknown lease fails alone, not the writes batched with it
+my ($good, $bad);
+$batched->put("$prefix/good", 'v', sub { $good = [@_]; EV::break if $bad });
+$batched->put("$prefix/bad", 'v', { lease => 0x7fffffff }, sub { $bad = [@_]; EV::break if $good });
+run_with_timeout();
+ok($bad && $bad->[1], 'put with a missing lease fails');
+ok($good && !$good->[1], 'batched write beside it succeeds');
+
+# raw and timeout writes are sent on their own
+my $raw;
+$batched->put("$prefix/raw", 'x', { raw => 1 }, sub { $raw = $_[0]; EV::break });
+run_with_timeout();
+ok(defined $raw && !ref $raw, 'raw put bypasses the batch');
+
+$client->delete($prefix, { prefix => 1 }, sub { EV::break });
+run_with_timeout();
+
+done_testing();
@@ -0,0 +1,122 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use lib 'blib/lib', 'blib/arch';
+use Test::More;
+
+BEGIN {
+    eval { require EV };
+    plan skip_all => 'EV required' if $@;
+}
+
+use EV;
+use EV::Etcd;
+
+# Check if etcd is available
+my $etcd_available = 0;
+eval {
+    my $client = EV::Etcd->new(
+        endpoints => ['127.0.0.1:2379'],
+        timeout => 2,
+    );
+    $client->status(sub {
+        my ($resp, $err) = @_;
+        $etcd_available = 1 if !$err;
+        EV::break;
+    });
+    my $t = EV::timer(3, 0, sub { EV::break });
+    EV::run;
+};
+plan skip_all => 'etcd not available on 127.0.0.1:2379' unless $etcd_available;
+
+my $client = EV::Etcd->new(
+    endpoints => ['127.0.0.1:2379'],
+);
+
+my $prefix = "/test-cache-$$-" . time();
+
+sub run_with_timeout {
+    my $t = EV::timer(5, 0, sub { fail('timeout'); EV::break });
+    EV::run;
+}
+
+sub wait_for {
+    my ($cond) = @_;
+    my $t = EV::timer(5, 0, sub { fail('timeout'); EV::break });
+    my $p = EV::timer(0.02, 0.02, sub { EV::break if $cond->() });
+    EV::run;
+}
+
+# Argument validation
+eval { $client->cache("$prefix/") };
+like($@, qr/Usage/, 'cache requires a callback');
+eval { $client->cache("$prefix/", { page_size => -1 }, sub {}) };
+like($@, qr/page_size/, 'cache rejects a non-positive page_size');
+
+my $seeded = 0;
+for my $i (1..3) {
+    $client->put("$prefix/a/k$i", "v$i", sub { EV::break if ++$seeded == 3 });
+}
+run_with_timeout();
+
+# Loaded in pages, then served synchronously
+my @loaded;
+my $cache = $client->cache("$prefix/", { page_size => 2 }, sub {
+    my ($resp, $err) = @_;
+    ok(!$err, 'cache loaded without error') or diag explain $err;
+    push @loaded, $resp;
+    EV::break;
+});
+isa_ok($cache, 'EV::Etcd::Cache');
+ok(!$cache->ready, 'not ready before the snapshot');
+is($cache->get("$prefix/a/k1"), undef, 'read before ready is a miss');
+run_with_timeout();
+
+ok($cache->ready, 'ready after the snapshot');
+is($loaded[0]{keys}, 3, 'snapshot reports its key count');
+is($cache->revision, $loaded[0]{revision}, 'revision matches the snapshot');
+is($cache->get("$prefix/a/k2"), 'v2', 'get from cache');
+is($cache->get("$prefix/a/none"), undef, 'absent key');
+is_deeply($cache->get_prefix("$prefix/a/"),
+    { map { ("$prefix/a/k$_" => "v$_") } 1..3 }, 'get_prefix from cache');
+
+eval { $cache->get('/elsewhere') };
+like($@, qr/outside the cached prefix/, 'get outside the prefix croaks');
+eval { my $v = $cache->get("$prefix/a/k1"); $v .= 'x'; };
+is($@, '', 'copy of a cached value is writable');
+
+# Writes and deletes reach the cache through the watch
+my $rev;
+$client->put("$prefix/a/k1", "new", sub {
+    $rev = $_[0]{header}{revision};
+    $client->delete("$prefix/a/k3", sub { EV::break });
+});
+run_with_timeout();
+wait_for(sub { !defined $cache->get("$prefix/a/k3") });
+is($cache->get("$prefix/a/k1"), 'new', 'update applied');
+ok(!exists $cache->get_prefix("$prefix/")->{"$prefix/a/k3"}, 'delete applied');
+cmp_ok($cache->revision, '>', $rev, 'revision follows the watch');
+
+my $s = $cache->stats;
+is($s->{keys}, 2, 'stats keys');
+is($s->{loads}, 1, 'one snapshot loaded');
+ok($s->{watching}, 'watch is running');
+cmp_ok($s->{hits}, '>=', 4, 'hits counted');
+cmp_ok($s->{misses}, '>=', 2, 'misses counted');
+cmp_ok($s->{age}, '>=', 0, 'age reported');
+cmp_ok($s->{age}, '<', 5, 'age is recent');
+
+# Dropping the cache stops its watch
+undef $cache;
+my $t = EV::timer(0.3, 0, sub { EV::break });
+EV::run;
+pass('cache destroyed while watching');
+
+# Cleanup
+$client->delete("$prefix/", { prefix => 1 }, sub {
+    ok(!$_[1], 'cleanup succeeded');
+    EV::break;
+});
+run_with_timeout();
+
+done_testing();
@@ -0,0 +1,139 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use lib 'blib/lib', 'blib/arch';
+use Test::More;
+
+BEGIN {
+    eval { require EV };
+    plan skip_all => 'EV required' if $@;
+}
+
+use EV;
+use EV::Etcd;
+
+# Check if etcd is available
+my $etcd_available = 0;
+eval {
+    my $client = EV::Etcd->new(
+        endpoints => ['127.0.0.1:2379'],
+        timeout => 2,
+    );
+    $client->status(sub {
+        my ($resp, $err) = @_;
+        $etcd_available = 1 if !$err;
+        EV::break;
+    });
+    my $t = EV::timer(3, 0, sub { EV::break });
+    EV::run;
+};
+plan skip_all => 'etcd not available on 127.0.0.1:2379' unless $etcd_available;
+
+my $client = EV::Etcd->new(
+    endpoints => ['127.0.0.1:2379'],
+);
+
+my $prefix = "/test-cache-history-$$-" . time();
+
+sub run_with_timeout {
+    my $t = EV::timer(5, 0, sub { fail('timeout'); EV::break });
+    EV::run;
+}
+
+sub wait_for {
+    my ($cond) = @_;
+    my $t = EV::timer(5, 0, sub { fail('timeout'); EV::break });
+    my $p = EV::timer(0.02, 0.02, sub { EV::break if $cond->() });
+    EV::run;
+}
+
+sub put_all {
+    my @kv = @_;
+    my $rev;
+    my $next; $next = sub {
+        return EV::break unless @kv;
+        my ($k, $v) = splice(@kv, 0, 2);
+        $client->put($k, $v, sub { $rev = $_[0]{header}{revision}; $next->() });
+    };
+    $next->();
+    run_with_timeout();
+    return $rev;
+}
+
+put_all(map { ("$prefix/k$_", "v$_") } reverse 1..4);
+
+my $cache = $client->cache("$prefix/", { history => 2 }, sub { EV::break });
+run_with_timeout();
+
+eval { $client->cache("$prefix/", { history => 0 }, sub {}) };
+like($@, qr/history/, 'history must be positive');
+
+my $snap = $cache->revision;
+is($cache->floor, $snap, 'floor starts at the snapshot revision');
+
+# Ordered listing, independent of insertion order
+my $all = $cache->range("$prefix/", { prefix => 1 });
+is_deeply([map { $_->{key} } @$all], [map { "$prefix/k$_" } 1..4], 'range is key ordered');
+is($cache->range("$prefix/k2")->[0]{value}, 'v2', 'single key range');
+is(scalar @{$cache->range("$prefix/k2", { range_end => "$prefix/k4" })}, 2,
+    'range_end is exclusive');
+
+# Sorted by mod_revision: keys were written k4 first
+my $by_mod = $cache->range("$prefix/", { prefix => 1, sort_target => 'mod' });
+is_deeply([map { $_->{key} } @$by_mod], [map { "$prefix/k$_" } reverse 1..4],
+    'sort_target mod');
+my $last2 = $cache->range("$prefix/", {
+    prefix => 1, sort_target => 'mod', sort_order => 'descend', limit => 2,
+});
+is_deeply([map { $_->{key} } @$last2], ["$prefix/k1", "$prefix/k2"],
+    'descend with limit');
+
+# History: update one key, delete another, add a new one
+my $r1 = put_all("$prefix/k1", "v1b");
+$client->delete("$prefix/k2", sub { EV::break });
+run_with_timeout();
+my $r3 = put_all("$prefix/k0", "new");
+wait_for(sub { $cache->revision >= $r3 });
+
+my $now = { map { ($_->{key} => $_->{value}) } @{$cache->range("$prefix/", { prefix => 1 })} };
+is_deeply($now, { "$prefix/k0" => 'new', "$prefix/k1" => 'v1b',
+                  "$prefix/k3" => 'v3', "$prefix/k4" => 'v4' }, 'current state');
+
+my $then = { map { ($_->{key} => $_->{value}) }
+             @{$cache->range("$prefix/", { prefix => 1, revision => $snap })} };
+is_deeply($then, { map { ("$prefix/k$_" => "v$_") } 1..4 }, 'state as of the snapshot');
+
+my $mid = { map { ($_->{key} => $_->{value}) }
+            @{$cache->range("$prefix/", { prefix => 1, revision => $r1 })} };
+is($mid->{"$prefix/k1"}, 'v1b', 'update visible at its revision');
+ok(exists $mid->{"$prefix/k2"}, 'deleted key still visible before the delete');
+ok(!exists $mid->{"$prefix/k0"}, 'later key not visible yet');
+
+is_deeply([sort keys %{$cache->get_prefix("$prefix/")}],
+    [map { "$prefix/k$_" } 0, 1, 3, 4], 'get_prefix uses the index');
+
+# Two more writes to k1 push its snapshot version out: the floor rises
+my $r5 = put_all("$prefix/k1", "v1c", "$prefix/k1", "v1d");
+wait_for(sub { $cache->revision >= $r5 });
+cmp_ok($cache->floor, '>', $snap, 'floor rises when history is trimmed');
+eval { $cache->range("$prefix/", { prefix => 1, revision => $snap }) };
+like($@, qr/outside the cached history/, 'reading below the floor croaks');
+is($cache->stats->{floor}, $cache->floor, 'stats reports the floor');
+
+# Without history there is no range
+my $plain = $client->cache("$prefix/", sub { EV::break });
+run_with_timeout();
+eval { $plain->range("$prefix/k1") };
+like($@, qr/history option/, 'range needs history');
+undef $plain;
+
+undef $cache;
+
+# Cleanup
+$client->delete("$prefix/", { prefix => 1 }, sub {
+    ok(!$_[1], 'cleanup succeeded');
+    EV::break;
+});
+run_with_timeout();
+
+done_testing();
@@ -0,0 +1,140 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use lib 'blib/lib', 'blib/arch';
+use Test::More;
+
+BEGIN {
+    eval { require EV };
+    plan skip_all => 'EV required' if $@;
+}
+
+use EV;
+use EV::Etcd;
+
+# Check if etcd is available
+my $etcd_available = 0;
+eval {
+    my $client = EV::Etcd->new(
+        endpoints => ['127.0.0.1:2379'],
+        timeout => 2,
+    );
+    $client->status(sub {
+        my ($resp, $err) = @_;
+        $etcd_available = 1 if !$err;
+        EV::break;
+    });
+    my $t = EV::timer(3, 0, sub { EV::break });
+    EV::run;
+};
+plan skip_all => 'etcd not available on 127.0.0.1:2379' unless $etcd_available;
+
+my $client = EV::Etcd->new(
+    endpoints => ['127.0.0.1:2379'],
+);
+
+my $prefix = "/test-cache-persist-$$-" . time();
+
+sub run_with_timeout {
+    my $t = EV::timer(5, 0, sub { fail('timeout'); EV::break });
+    EV::run;
+}
+
+use File::Temp qw(tempdir);
+my $dir = tempdir(CLEANUP => 1);
+my $path = "$dir/cache.bin";
+
+sub wait_for {
+    my ($cond) = @_;
+    my $t = EV::timer(5, 0, sub { fail('timeout'); EV::break });
+    my $p = EV::timer(0.02, 0.02, sub { EV::break if $cond->() });
+    EV::run;
+}
+
+my $n = 0;
+$client->put("$prefix/$_", "v$_", sub { EV::break if ++$n == 3 }) for 1..3;
+run_with_timeout();
+
+# Cold start: full load, written to the file
+my @cb;
+my $cache = $client->cache("$prefix/", { persist => $path, history => 2 }, sub {
+    push @cb, $_[0];
+    EV::break;
+});
+run_with_timeout();
+ok(!$cb[0]{warm}, 'first start is a full load');
+ok(-s $path, 'snapshot file written after the load');
+is($cache->stats->{saved_revision}, $cache->revision, 'saved revision recorded');
+ok($cache->save, 'explicit save');
+undef $cache;
+
+# Changes while "down"
+my $rev;
+$client->put("$prefix/1", "changed", sub {
+    $client->delete("$prefix/2", sub {
+        $client->put("$prefix/4", "added", sub { $rev = $_[0]{header}{revision}; EV::break });
+    });
+});
+run_with_timeout();
+
+# Warm start: served from the file at once, then caught up by the watch
+@cb = ();
+$cache = $client->cache("$prefix/", { persist => $path, history => 2 }, sub {
+    push @cb, $_[0];
+    EV::break;
+});
+ok($cache->ready, 'ready immediately from the file');
+is($cache->get("$prefix/1"), 'v1', 'saved value served before any round trip');
+my $range = $cache->range("$prefix/1");
+cmp_ok($range->[0]{mod_revision}, '>', 0, 'revisions restored with history');
+
+run_with_timeout();
+ok($cb[0]{warm}, 'callback reports a warm start');
+wait_for(sub { $cache->revision >= $rev });
+is($cache->get("$prefix/1"), 'changed', 'update made while down applied');
+is($cache->get("$prefix/2"), undef, 'delete made while down applied');
+is($cache->get("$prefix/4"), 'added', 'key added while down applied');
+is($cache->stats->{loads}, 0, 'no full load on a warm start');
+undef $cache;
+
+# A file for another prefix is ignored
+@cb = ();
+$cache = $client->cache("$prefix/1", { persist => $path }, sub { push @cb, $_[0]; EV::break });
+ok(!$cache->ready, 'file for another prefix is not used');
+run_with_timeout();
+ok(!$cb[0]{warm}, 'full load instead');
+undef $cache;
+
+# A corrupt file means a full load
+open my $fh, '>', $path or die $!;
+print $fh "garbage" x 10;
+close $fh;
+$cache = $client->cache("$prefix/", { persist => $path }, sub { EV::break });
+ok(!$cache->ready, 'corrupt file is ignored');
+run_with_timeout();
+is($cache->get("$prefix/4"), 'added', 'full load after a corrupt file');
+undef $cache;
+
+# Saved without history (on destroy above): no revisions for a history cache
+@cb = ();
+$cache = $client->cache("$prefix/", { persist => $path, history => 2 }, sub {
+    push @cb, $_[0];
+    EV::break;
+});
+ok(!$cache->ready, 'file without revisions not used with history');
+run_with_timeout();
+ok(!$cb[0]{warm}, 'full load instead');
+cmp_ok($cache->range("$prefix/4")->[0]{mod_revision}, '>', 0, 'revisions from the load');
+undef $cache;
+
+eval { $client->cache("$prefix/", sub {})->save };
+like($@, qr/persist option/, 'save needs persist');
+
+# Cleanup
+$client->delete("$prefix/", { prefix => 1 }, sub {
+    ok(!$_[1], 'cleanup succeeded');
+    EV::break;
+});
+run_with_timeout();
+
+done_testing();
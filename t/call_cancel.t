@@ -0,0 +1,137 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use lib 'blib/lib', 'blib/arch';
+use Test::More;
+
+BEGIN {
+    eval { require EV };
+    plan skip_all => 'EV required' if $@;
+}
+
+use EV;
+use EV::Etcd;
+
+# Check if etcd is available
+my $etcd_available = 0;
+eval {
+    my $client = EV::Etcd->new(
+        endpoints => ['127.0.0.1:2379'],
+        timeout => 2,
+    );
+    $client->status(sub {
+        my ($resp, $err) = @_;
+        $etcd_available = 1 if !$err;
+        EV::break;
+    });
+    my $t = EV::timer(3, 0, sub { EV::break });
+    EV::run;
+};
+plan skip_all => 'etcd not available on 127.0.0.1:2379' unless $etcd_available;
+
+my $client = EV::Etcd->new(
+    endpoints => ['127.0.0.1:2379'],
+);
+
+my $prefix = "/test-call-cancel-$$-" . time();
+
+sub run_with_timeout {
+    my $t = EV::timer(5, 0, sub { fail('timeout'); EV::break });
+    EV::run;
+}
+
+sub grant {
+    my $id;
+    $client->lease_grant(30, sub { $id = $_[0]{id}; EV::break });
+    run_with_timeout();
+    return $id;
+}
+
+sub wait_for {
+    my ($seconds) = @_;
+    my $t = EV::timer($seconds, 0, sub { EV::break });
+    EV::run;
+}
+
+# Argument validation
+eval { $client->lock('x', 1, { timeout => -1 }, sub {}) };
+like($@, qr/timeout must not be negative/, 'negative timeout rejected');
+eval { $client->lock('x', 1, 'x', sub {}) };
+like($@, qr/options must be a hash reference/, 'non-hash options rejected');
+eval { $client->lock('x', 1) };
+like($@, qr/Usage/, 'lock without callback');
+
+my ($lease1, $lease2) = (grant(), grant());
+my $name = "$prefix/lock";
+
+my $held;
+$client->lock($name, $lease1, sub { $held = $_[0]; EV::break });
+run_with_timeout();
+ok($held && $held->{key}, 'first lock held');
+
+# A short client timeout does not cut short a wait without deadline
+my $short = EV::Etcd->new(endpoints => ['127.0.0.1:2379'], timeout => 1);
+my ($waited, $wait_err);
+my $call = $short->lock($name, $lease2, { timeout => 0 }, sub {
+    ($waited, $wait_err) = @_;
+    EV::break;
+});
+isa_ok($call, 'EV::Etcd::Call');
+ok($call->active, 'call in flight');
+wait_for(2);
+ok(!$waited && !$wait_err, 'still waiting past the client timeout');
+
+# Cancel the wait
+ok($call->cancel, 'cancel returns true while in flight');
+run_with_timeout();
+ok(!$waited, 'no lock after cancel');
+is($wait_err->{status}, 'CANCELLED', 'callback got CANCELLED');
+ok(!$call->active, 'call no longer active');
+ok(!$call->cancel, 'second cancel is a no-op');
+
+# Fractional per-call deadline
+my $timed_err;
+my $t0 = EV::now;
+$client->lock($name, $lease2, { timeout => 0.5 }, sub { $timed_err = $_[1]; EV::break });
+run_with_timeout();
+is($timed_err->{status}, 'DEADLINE_EXCEEDED', 'per-call deadline applied');
+ok(EV::now - $t0 < 3, 'well before the client timeout');
+
+# Campaign takes the same options
+my $leader;
+my $campaign = $client->election_campaign("$prefix/election", $lease1, 'v', { timeout => 5 }, sub {
+    $leader = $_[0]{leader};
+    EV::break;
+});
+isa_ok($campaign, 'EV::Etcd::Call');
+run_with_timeout();
+ok($leader, 'campaign with timeout option won');
+ok(!$campaign->active, 'campaign handle done');
+
+# Unary calls return handles too
+my ($got, $got_err);
+my $get = $client->get("$prefix/k", sub { ($got, $got_err) = @_; EV::break });
+isa_ok($get, 'EV::Etcd::Call', 'get handle');
+ok($get->cancel, 'get cancelled');
+run_with_timeout();
+ok(!$got, 'no response after cancel');
+is($got_err->{status}, 'CANCELLED', 'get got CANCELLED');
+
+# A response already received when the call is cancelled is dropped
+($got, $got_err) = ();
+$get = $client->put("$prefix/k", 'v', sub { ($got, $got_err) = @_; EV::break });
+select(undef, undef, undef, 0.5);   # block the loop while the reply lands
+ok($get->cancel, 'put cancelled after its reply arrived');
+run_with_timeout();
+ok(!$got, 'late reply not delivered');
+is($got_err->{status}, 'CANCELLED', 'put got CANCELLED');
+ok(!$get->active, 'put handle done');
+
+for my $lease ($lease1, $lease2) {
+    $client->lease_revoke($lease, sub { EV::break });
+    run_with_timeout();
+}
+$client->delete($prefix, { prefix => 1 }, sub { EV::break });
+run_with_timeout();
+
+done_testing();
@@ -0,0 +1,118 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use lib 'blib/lib', 'blib/arch';
+use Test::More;
+
+BEGIN {
+    eval { require EV };
+    plan skip_all => 'EV required' if $@;
+}
+
+use EV;
+use EV::Etcd;
+
+# Check if etcd is available
+my $etcd_available = 0;
+eval {
+    my $client = EV::Etcd->new(
+        endpoints => ['127.0.0.1:2379'],
+        timeout => 2,
+    );
+    $client->status(sub {
+        my ($resp, $err) = @_;
+        $etcd_available = 1 if !$err;
+        EV::break;
+    });
+    my $t = EV::timer(3, 0, sub { EV::break });
+    EV::run;
+};
+plan skip_all => 'etcd not available on 127.0.0.1:2379' unless $etcd_available;
+
+my $client = EV::Etcd->new(
+    endpoints => ['127.0.0.1:2379'],
+);
+
+my $prefix = "/test-dedupe-$$-" . time();
+
+sub run_with_timeout {
+    my $t = EV::timer(5, 0, sub { fail('timeout'); EV::break });
+    EV::run;
+}
+
+my $shared = EV::Etcd->new(endpoints => ['127.0.0.1:2379'], dedupe => 1);
+
+$client->put("$prefix/k", 'v1', sub { EV::break });
+run_with_timeout();
+
+# Identical gets issued together share one call and one response
+my @got;
+my @calls = map {
+    $shared->get("$prefix/k", sub { push @got, [@_]; EV::break if @got == 5 })
+} 1 .. 5;
+run_with_timeout();
+is(scalar @got, 5, 'every caller answered');
+is($got[0][0]{kvs}[0]{value}, 'v1', 'value delivered');
+is(scalar(grep { $_->[0] == $got[0][0] } @got), 5, 'one decoded response shared');
+isa_ok($_, 'EV::Etcd::Call') for @calls[0, 4];
+
+# Different options are different requests
+@got = ();
+$shared->get("$prefix/k", sub { push @got, $_[0]; EV::break if @got == 2 });
+$shared->get("$prefix/k", { keys_only => 1 }, sub { push @got, $_[0]; EV::break if @got == 2 });
+run_with_timeout();
+isnt($got[0], $got[1], 'different requests not merged');
+
+# Per-call opt-out and opt-in
+@got = ();
+$shared->get("$prefix/k", sub { push @got, $_[0]; EV::break if @got == 2 });
+$shared->get("$prefix/k", { dedupe => 0 }, sub { push @got, $_[0]; EV::break if @got == 2 });
+run_with_timeout();
+isnt($got[0], $got[1], 'dedupe => 0 sends its own request');
+
+# A call's own deadline is never shared
+@got = ();
+$shared->get("$prefix/k", sub { push @got, $_[0]; EV::break if @got == 3 });
+$shared->get("$prefix/k", { timeout => 5 }, sub { push @got, $_[0]; EV::break if @got == 3 });
+$shared->get("$prefix/k", { timeout => 5 }, sub { push @got, $_[0]; EV::break if @got == 3 });
+run_with_timeout();
+is(scalar(keys %{{ map { $_ => 1 } @got }}), 3, 'gets with a timeout send their own requests');
+
+@got = ();
+$client->get("$prefix/k", { dedupe => 1 }, sub { push @got, $_[0]; EV::break if @got == 2 });
+$client->get("$prefix/k", { dedupe => 1 }, sub { push @got, $_[0]; EV::break if @got == 2 });
+run_with_timeout();
+is($got[0], $got[1], 'per-call dedupe on a plain client');
+
+# Cancelling one caller leaves the others waiting
+my (%res, %err);
+my $first = $shared->get("$prefix/k", sub { ($res{a}, $err{a}) = @_ });
+my $second = $shared->get("$prefix/k", sub { ($res{b}, $err{b}) = @_; EV::break });
+ok($second->cancel, 'joined caller cancelled');
+ok(!$second->cancel, 'second cancel is a no-op');
+run_with_timeout();
+is($err{b}{status}, 'CANCELLED', 'cancelled caller got CANCELLED');
+is($res{a}{kvs}[0]{value}, 'v1', 'other caller still answered');
+
+# When every caller cancels, the call is cancelled
+%res = %err = ();
+$first = $shared->get("$prefix/k", sub { ($res{a}, $err{a}) = @_ });
+$second = $shared->get("$prefix/k", sub { ($res{b}, $err{b}) = @_; EV::break });
+$_->cancel for $first, $second;
+run_with_timeout();
+is($err{a}{status}, 'CANCELLED', 'first caller cancelled');
+is($err{b}{status}, 'CANCELLED', 'second caller cancelled');
+
+# A get issued from a callback is not merged into the finished call
+my ($outer, $inner);
+$shared->get("$prefix/k", sub {
+    $outer = $_[0];
+    $shared->get("$prefix/k", sub { $inner = $_[0]; EV::break });
+});
+run_with_timeout();
+ok($inner && $inner != $outer, 'callback get starts a new call');
+
+$client->delete($prefix, { prefix => 1 }, sub { EV::break });
+run_with_timeout();
+
+done_testing();
@@ -0,0 +1,148 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use lib 'blib/lib', 'blib/arch';
+use Test::More;
+
+BEGIN {
+    eval { require EV };
+    plan skip_all => 'EV required' if $@;
+}
+
+# gRPC reads this when EV::Etcd loads
+BEGIN { $ENV{GRPC_ENABLE_FORK_SUPPORT} = 1 }
+
+use EV;
+use EV::Etcd;
+use POSIX ();
+
+# Check if etcd is available
+my $etcd_available = 0;
+eval {
+    my $client = EV::Etcd->new(
+        endpoints => ['127.0.0.1:2379'],
+        timeout => 2,
+    );
+    $client->status(sub {
+        my ($resp, $err) = @_;
+        $etcd_available = 1 if !$err;
+        EV::break;
+    });
+    my $t = EV::timer(3, 0, sub { EV::break });
+    EV::run;
+};
+plan skip_all => 'etcd not available on 127.0.0.1:2379' unless $etcd_available;
+
+my $client = EV::Etcd->new(
+    endpoints => ['127.0.0.1:2379'],
+);
+
+my $prefix = "/test-fork-$$-" . time();
+
+sub run_with_timeout {
+    my $t = EV::timer(5, 0, sub { fail('timeout'); EV::break });
+    EV::run;
+}
+
+# Run a child and return its exit code
+sub reap {
+    my ($pid) = @_;
+    waitpid($pid, 0);
+    return $? >> 8;
+}
+
+# Option validation happens before anything is touched
+eval { EV::Etcd->atfork_child(bogus => 1) };
+like($@, qr/unknown option/, 'atfork_child rejects unknown options');
+eval { EV::Etcd->atfork_child('watches') };
+like($@, qr/Usage/, 'atfork_child needs key/value pairs');
+
+# Warm cache in the parent
+{
+    my $done = 0;
+    $client->put("$prefix/a", 'one', sub { $done++; EV::break });
+    run_with_timeout();
+    is($done, 1, 'seeded key');
+}
+
+my $cache = $client->cache("$prefix/", sub { EV::break });
+run_with_timeout();
+ok($cache->ready, 'cache loaded in the parent');
+
+# Child: inherited cache is warm, the client works and the watch is restored
+{
+    my $pid = EV::Etcd->fork;
+    die "fork: $!" unless defined $pid;
+    if (!$pid) {
+        my $code = 0;
+        $code |= 1 unless ($cache->get("$prefix/a") // '') eq 'one';
+
+        my $got;
+        $client->put("$prefix/b", 'two', sub {
+            my ($resp, $err) = @_;
+            $code |= 2 if $err;
+            $client->get("$prefix/b", sub {
+                my ($resp, $err) = @_;
+                $got = $resp && $resp->{kvs}[0]{value};
+            });
+        });
+        my $t = EV::timer(5, 0, sub { $code |= 4; EV::break });
+        my $poll = EV::timer(0.05, 0.05, sub {
+            EV::break if defined $got && defined $cache->get("$prefix/b");
+        });
+        EV::run;
+        $code |= 8 unless ($got // '') eq 'two';
+        $code |= 16 unless ($cache->get("$prefix/b") // '') eq 'two';
+        POSIX::_exit($code);
+    }
+    is(reap($pid), 0, 'child used the client, the warm cache and its restored watch');
+}
+
+# Parent still works after the child
+{
+    my $got;
+    $client->get("$prefix/b", sub {
+        my ($resp, $err) = @_;
+        $got = $resp && $resp->{kvs}[0]{value};
+        EV::break;
+    });
+    run_with_timeout();
+    is($got, 'two', 'parent client works after atfork_parent');
+
+    my $t = EV::timer(0.2, 0, sub { EV::break });
+    EV::run;
+    is($cache->get("$prefix/b"), 'two', 'parent cache saw the child\'s write');
+}
+
+# Child that never reinitializes: destroying its copy leaves the parent alone
+{
+    EV::Etcd->atfork_prepare;
+    my $pid = fork;
+    die "fork: $!" unless defined $pid;
+    if (!$pid) {
+        undef $cache;
+        undef $client;
+        POSIX::_exit(0);
+    }
+    EV::Etcd->atfork_parent;
+    is(reap($pid), 0, 'child dropped its inherited client');
+
+    my $got;
+    $client->get("$prefix/a", sub {
+        my ($resp, $err) = @_;
+        $got = $resp && $resp->{kvs}[0]{value};
+        EV::break;
+    });
+    run_with_timeout();
+    is($got, 'one', 'parent client unaffected');
+}
+
+# Cleanup
+undef $cache;
+$client->delete("$prefix/", { prefix => 1 }, sub {
+    ok(!$_[1], 'cleanup succeeded');
+    EV::break;
+});
+run_with_timeout();
+
+done_testing();
@@ -0,0 +1,131 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use lib 'blib/lib', 'blib/arch';
+use Test::More;
+
+BEGIN {
+    eval { require EV };
+    plan skip_all => 'EV required' if $@;
+}
+
+use EV;
+use EV::Etcd;
+
+# Check if etcd is available
+my $etcd_available = 0;
+eval {
+    my $client = EV::Etcd->new(
+        endpoints => ['127.0.0.1:2379'],
+        timeout => 2,
+    );
+    $client->status(sub {
+        my ($resp, $err) = @_;
+        $etcd_available = 1 if !$err;
+        EV::break;
+    });
+    my $t = EV::timer(3, 0, sub { EV::break });
+    EV::run;
+};
+plan skip_all => 'etcd not available on 127.0.0.1:2379' unless $etcd_available;
+
+my $client = EV::Etcd->new(
+    endpoints => ['127.0.0.1:2379'],
+);
+
+my $prefix = "/test-lease-manager-$$-" . time();
+
+sub run_with_timeout {
+    my $t = EV::timer(5, 0, sub { fail('timeout'); EV::break });
+    EV::run;
+}
+
+sub wait_for {
+    my ($seconds) = @_;
+    my $t = EV::timer($seconds, 0, sub { EV::break });
+    EV::run;
+}
+
+sub grant {
+    my ($ttl, $by) = @_;
+    my $id;
+    ($by // $client)->lease_grant($ttl, sub {
+        my ($resp, $err) = @_;
+        $id = $resp->{id} unless $err;
+        EV::break;
+    });
+    run_with_timeout();
+    return $id;
+}
+
+# Argument validation
+eval { $client->lease_keep(0) };
+like($@, qr/positive/, 'lease_keep rejects a non-positive id');
+eval { $client->lease_keep(1, { ttl => 0 }) };
+like($@, qr/ttl must be positive/, 'lease_keep rejects a non-positive ttl');
+eval { $client->lease_keep(1, 'x') };
+like($@, qr/Usage/, 'lease_keep rejects stray arguments');
+is($client->lease_remaining(1), undef, 'unmanaged lease has no local estimate');
+ok(!$client->lease_release(1), 'releasing an unmanaged lease');
+
+# Renewed past its TTL
+my $lease = grant(2);
+ok($lease, 'granted a short lease');
+
+my $lost;
+$client->lease_keep($lease, { ttl => 2 }, sub { $lost = $_[1] });
+my $left = $client->lease_remaining($lease);
+ok(defined $left && $left > 0 && $left <= 2, 'remaining known from the ttl option');
+
+wait_for(4.5);
+ok(!$lost, 'lease not lost while managed');
+
+my $server_ttl;
+$client->lease_time_to_live($lease, sub {
+    my ($resp, $err) = @_;
+    $server_ttl = $resp->{ttl} unless $err;
+    EV::break;
+});
+run_with_timeout();
+ok(defined $server_ttl && $server_ttl > 0, 'lease still alive on the server after twice its TTL');
+$left = $client->lease_remaining($lease);
+ok(defined $left && $left > 0, 'remaining estimated from the last renewal');
+
+# TTL learned from the first renewal (granted elsewhere, so unknown here)
+my $other = EV::Etcd->new(endpoints => ['127.0.0.1:2379']);
+my $lease2 = grant(30, $other);
+$client->lease_keep($lease2);
+is($client->lease_remaining($lease2), undef, 'remaining unknown before the first renewal');
+wait_for(1);
+$left = $client->lease_remaining($lease2);
+ok(defined $left && $left > 20, 'first renewal supplied the TTL');
+
+# Release keeps the lease but stops renewing it
+ok($client->lease_release($lease2), 'release a managed lease');
+ok(!$client->lease_release($lease2), 'second release is a no-op');
+$left = $client->lease_remaining($lease2);
+ok(defined $left && $left > 20, 'released lease estimated from its last renewal');
+
+# Revoke of a managed lease is not a loss
+$client->lease_revoke($lease, sub { EV::break });
+run_with_timeout();
+wait_for(1.5);
+ok(!$lost, 'revoked lease did not report a loss');
+is($client->lease_remaining($lease), undef, 'revoked lease released');
+
+# A lease the server does not know is reported lost
+my $gone;
+$client->lease_keep(0x7fff0000 + $$, sub {
+    my ($resp, $err) = @_;
+    $gone = $err;
+    EV::break;
+});
+run_with_timeout();
+ok($gone, 'unknown lease reported lost');
+is($gone->{message}, 'Lease expired', 'loss reported by the server');
+is($gone->{source}, 'lease', 'error source');
+
+$client->lease_revoke($lease2, sub { EV::break });
+run_with_timeout();
+
+done_testing();
@@ -0,0 +1,116 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use lib 'blib/lib', 'blib/arch';
+use Test::More;
+
+BEGIN {
+    eval { require EV };
+    plan skip_all => 'EV required' if $@;
+}
+
+use EV;
+use EV::Etcd;
+
+# Check if etcd is available
+my $etcd_available = 0;
+eval {
+    my $client = EV::Etcd->new(
+        endpoints => ['127.0.0.1:2379'],
+        timeout => 2,
+    );
+    $client->status(sub {
+        my ($resp, $err) = @_;
+        $etcd_available = 1 if !$err;
+        EV::break;
+    });
+    my $t = EV::timer(3, 0, sub { EV::break });
+    EV::run;
+};
+plan skip_all => 'etcd not available on 127.0.0.1:2379' unless $etcd_available;
+
+my $client = EV::Etcd->new(
+    endpoints => ['127.0.0.1:2379'],
+);
+
+my $prefix = "/test-lease-pool-$$-" . time();
+
+sub run_with_timeout {
+    my $t = EV::timer(5, 0, sub { fail('timeout'); EV::break });
+    EV::run;
+}
+
+sub wait_until {
+    my ($cond) = @_;
+    my $t = EV::timer(5, 0, sub { fail('timeout'); EV::break });
+    my $poll = EV::timer(0.02, 0.02, sub { EV::break if $cond->() });
+    EV::run;
+}
+
+# Argument validation
+eval { $client->lease_pool(size => 2) };
+like($@, qr/ttl must be positive/, 'ttl is required');
+eval { $client->lease_pool(ttl => 10, size => 0) };
+like($@, qr/size must be between/, 'size is bounded');
+eval { $client->lease_pool(ttl => 10, bogus => 1) };
+like($@, qr/unknown option/, 'unknown option rejected');
+
+my $pool = $client->lease_pool(ttl => 10, size => 3);
+isa_ok($pool, 'EV::Etcd::LeasePool');
+is($pool->stats->{granting}, 3, 'grants start right away');
+
+wait_until(sub { $pool->available == 3 });
+is($pool->available, 3, 'pool filled');
+
+# Taking is synchronous and refills behind
+my $lease = $pool->take;
+ok($lease, 'took a lease');
+is($pool->available, 2, 'one fewer idle');
+is($pool->stats->{granting}, 1, 'replacement grant in flight');
+ok(defined $client->lease_remaining($lease), 'taken lease is managed');
+
+# One put with the lease
+my $put_err = 'none';
+$client->put("$prefix/ephemeral", 'x', { lease => $lease }, sub {
+    $put_err = $_[1];
+    EV::break;
+});
+run_with_timeout();
+ok(!$put_err, 'ephemeral put with a pooled lease');
+
+wait_until(sub { $pool->available == 3 });
+is($pool->available, 3, 'refilled');
+
+# Draining faster than grants complete
+my @taken = grep { defined } map { $pool->take } 1 .. 5;
+is(scalar @taken, 3, 'only idle leases are handed out');
+is($pool->take, undef, 'empty pool returns undef');
+my %seen;
+ok(!(grep { $seen{$_}++ } @taken, $lease), 'every lease handed out once');
+
+my $stats = $pool->stats;
+is($stats->{taken}, 4, 'taken counted');
+ok($stats->{granted} >= 6, 'granted counted');
+is($stats->{failures}, 0, 'no failed grants');
+
+# Revoking a taken lease removes its key
+$client->lease_revoke($lease, sub { EV::break });
+run_with_timeout();
+my $count;
+$client->get("$prefix/ephemeral", sub {
+    $count = $_[0]{count};
+    EV::break;
+});
+run_with_timeout();
+is($count, 0, 'key went with its lease');
+
+for my $id (@taken) {
+    $client->lease_revoke($id, sub { EV::break });
+    run_with_timeout();
+}
+
+wait_until(sub { $pool->available == 3 });
+undef $pool;
+pass('pool destroyed with idle leases');
+
+done_testing();
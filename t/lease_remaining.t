@@ -0,0 +1,122 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use lib 'blib/lib', 'blib/arch';
+use Test::More;
+
+BEGIN {
+    eval { require EV };
+    plan skip_all => 'EV required' if $@;
+}
+
+use EV;
+use EV::Etcd;
+
+# Check if etcd is available
+my $etcd_available = 0;
+eval {
+    my $client = EV::Etcd->new(
+        endpoints => ['127.0.0.1:2379'],
+        timeout => 2,
+    );
+    $client->status(sub {
+        my ($resp, $err) = @_;
+        $etcd_available = 1 if !$err;
+        EV::break;
+    });
+    my $t = EV::timer(3, 0, sub { EV::break });
+    EV::run;
+};
+plan skip_all => 'etcd not available on 127.0.0.1:2379' unless $etcd_available;
+
+my $client = EV::Etcd->new(
+    endpoints => ['127.0.0.1:2379'],
+);
+
+my $prefix = "/test-lease-remaining-$$-" . time();
+
+sub run_with_timeout {
+    my $t = EV::timer(5, 0, sub { fail('timeout'); EV::break });
+    EV::run;
+}
+
+sub grant {
+    my ($ttl, $by) = @_;
+    my $id;
+    ($by // $client)->lease_grant($ttl, sub {
+        my ($resp, $err) = @_;
+        $id = $resp->{id} unless $err;
+        EV::break;
+    });
+    run_with_timeout();
+    return $id;
+}
+
+sub wait_for {
+    my ($seconds) = @_;
+    my $t = EV::timer($seconds, 0, sub { EV::break });
+    EV::run;
+}
+
+# Granted here: known at once, never above the TTL
+my $lease = grant(20);
+ok($lease, 'granted a lease');
+my $left = $client->lease_remaining($lease);
+ok(defined $left && $left > 18 && $left <= 20, 'granted lease estimated locally');
+
+wait_for(1.2);
+my $later = $client->lease_remaining($lease);
+ok($later < $left - 1, 'estimate counts down on the monotonic clock');
+
+# Margins
+my $with_margin = $client->lease_remaining($lease, 5);
+ok($with_margin <= $later - 5 + 0.1, 'explicit margin subtracted');
+is($client->lease_remaining($lease, 1000), 0, 'estimate never goes below 0');
+
+my $margined = EV::Etcd->new(endpoints => ['127.0.0.1:2379'], lease_margin => 3);
+my $lease_m = grant(20, $margined);
+$left = $margined->lease_remaining($lease_m);
+ok(defined $left && $left <= 17, 'client lease_margin applied');
+$left = $margined->lease_remaining($lease_m, 0);
+ok($left > 17, 'margin overridden per call');
+
+# Granted elsewhere: unknown until looked up once
+is($margined->lease_remaining($lease), undef, 'lease granted by another client is unknown');
+my $server_ttl;
+$margined->lease_time_to_live($lease, sub {
+    my ($resp, $err) = @_;
+    $server_ttl = $resp->{ttl} unless $err;
+    EV::break;
+});
+run_with_timeout();
+$left = $margined->lease_remaining($lease, 0);
+ok(defined $left && $left <= $server_ttl, 'estimate learned from lease_time_to_live');
+
+# lease_keep picks up the TTL seen at grant time
+$client->lease_keep($lease);
+$left = $client->lease_remaining($lease);
+ok(defined $left && $left > 15, 'managed lease starts from the noted TTL');
+ok($client->lease_release($lease), 'released');
+
+# lease_keepalive renewals are noted too
+my $ka_lease = grant(10, $margined);
+my $renewed;
+$client->lease_keepalive($ka_lease, sub {
+    my ($resp, $err) = @_;
+    $renewed = $resp unless $err;
+    EV::break;
+});
+run_with_timeout();
+ok($renewed, 'keepalive response');
+$left = $client->lease_remaining($ka_lease);
+ok(defined $left && $left > 8 && $left <= 10, 'keepalive renewal noted');
+
+# Revoked leases are forgotten
+for my $id ($lease, $lease_m, $ka_lease) {
+    $client->lease_revoke($id, sub { EV::break });
+    run_with_timeout();
+}
+is($client->lease_remaining($lease), undef, 'revoked lease forgotten');
+is($client->lease_remaining($ka_lease), undef, 'revoked keepalive lease forgotten');
+
+done_testing();
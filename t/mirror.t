@@ -0,0 +1,121 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use lib 'blib/lib', 'blib/arch';
+use Test::More;
+
+BEGIN {
+    eval { require EV };
+    plan skip_all => 'EV required' if $@;
+}
+
+use EV;
+use EV::Etcd;
+
+# Check if etcd is available
+my $etcd_available = 0;
+eval {
+    my $client = EV::Etcd->new(
+        endpoints => ['127.0.0.1:2379'],
+        timeout => 2,
+    );
+    $client->status(sub {
+        my ($resp, $err) = @_;
+        $etcd_available = 1 if !$err;
+        EV::break;
+    });
+    my $t = EV::timer(3, 0, sub { EV::break });
+    EV::run;
+};
+plan skip_all => 'etcd not available on 127.0.0.1:2379' unless $etcd_available;
+
+my $client = EV::Etcd->new(
+    endpoints => ['127.0.0.1:2379'],
+);
+
+my $prefix = "/test-mirror-$$-" . time();
+
+sub run_with_timeout {
+    my $t = EV::timer(5, 0, sub { fail('timeout'); EV::break });
+    EV::run;
+}
+
+use File::Temp qw(tempdir);
+my $dir = tempdir(CLEANUP => 1);
+my $path = "$dir/mirror";
+
+sub wait_for {
+    my ($cond) = @_;
+    my $t = EV::timer(5, 0, sub { fail('timeout'); EV::break });
+    my $p = EV::timer(0.02, 0.02, sub { EV::break if $cond->() });
+    EV::run;
+}
+
+eval { EV::Etcd::Mirror->new("$dir/missing") };
+like($@, qr/Cannot open shared mirror/, 'missing mirror file croaks');
+
+my $n = 0;
+$client->put("$prefix/$_", "v$_", sub { EV::break if ++$n == 3 }) for 1..3;
+run_with_timeout();
+
+my $cache = $client->cache("$prefix/", { shared => $path, shared_size => 65536 }, sub { EV::break });
+ok(-e $path, 'mirror file created');
+my $mirror = EV::Etcd::Mirror->new($path);
+isa_ok($mirror, 'EV::Etcd::Mirror');
+ok(!$mirror->ready, 'nothing published before the load');
+is($mirror->get("$prefix/1"), undef, 'empty before the load');
+
+run_with_timeout();
+wait_for(sub { $mirror->ready });
+is($mirror->revision, $cache->revision, 'mirror revision follows the cache');
+is($mirror->get("$prefix/2"), 'v2', 'get through the mirror');
+is($mirror->get("$prefix/none"), undef, 'absent key');
+is_deeply($mirror->get_prefix("$prefix/"), { map { ("$prefix/$_" => "v$_") } 1..3 },
+    'get_prefix through the mirror');
+
+# Changes are republished
+my $gen = $mirror->generation;
+$client->put("$prefix/1", "new", sub { $client->delete("$prefix/3", sub { EV::break }) });
+run_with_timeout();
+wait_for(sub { !defined $mirror->get("$prefix/3") });
+is($mirror->get("$prefix/1"), 'new', 'update published');
+cmp_ok($mirror->generation, '>', $gen, 'generation advanced');
+cmp_ok($cache->stats->{publishes}, '>=', 2, 'publishes counted');
+
+# Another process reads it without a client
+pipe(my $r, my $w) or die $!;
+my $pid = fork;
+die "fork: $!" unless defined $pid;
+if (!$pid) {
+    close $r;
+    my $m = EV::Etcd::Mirror->new($path);
+    print $w $m->get("$prefix/1") // 'undef';
+    close $w;
+    require POSIX;
+    POSIX::_exit(0);
+}
+close $w;
+my $seen = do { local $/; <$r> };
+waitpid($pid, 0);
+is($seen, 'new', 'child process reads the mirror');
+
+# Contents larger than the mirror are not published
+my $big = 'x' x 40000;
+$client->put("$prefix/big", $big, sub { EV::break });
+run_with_timeout();
+wait_for(sub { $cache->get("$prefix/big") });
+wait_for(sub { $cache->stats->{publish_failures} });
+is($mirror->get("$prefix/big"), undef, 'oversized contents leave the previous copy');
+is($mirror->get("$prefix/1"), 'new', 'previous copy still readable');
+
+undef $cache;
+is($mirror->get("$prefix/1"), 'new', 'mirror outlives the publisher');
+
+# Cleanup
+$client->delete("$prefix/", { prefix => 1 }, sub {
+    ok(!$_[1], 'cleanup succeeded');
+    EV::break;
+});
+run_with_timeout();
+
+done_testing();
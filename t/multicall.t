@@ -0,0 +1,127 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use lib 'blib/lib', 'blib/arch';
+use Test::More;
+
+BEGIN {
+    eval { require EV };
+    plan skip_all => 'EV required' if $@;
+}
+
+use EV;
+use EV::Etcd;
+
+# Check if etcd is available
+my $etcd_available = 0;
+eval {
+    my $client = EV::Etcd->new(
+        endpoints => ['127.0.0.1:2379'],
+        timeout => 2,
+    );
+    $client->status(sub {
+        my ($resp, $err) = @_;
+        $etcd_available = 1 if !$err;
+        EV::break;
+    });
+    my $t = EV::timer(3, 0, sub { EV::break });
+    EV::run;
+};
+
+plan skip_all => 'etcd not available on 127.0.0.1:2379' unless $etcd_available;
+
+my $prefix = "/test-multicall-$$-" . time();
+
+sub run_with_timeout {
+    my $t = EV::timer(10, 0, sub { fail('timeout'); EV::break });
+    EV::run;
+}
+
+sub flood {
+    my ($client, $dir, $count, $cb) = @_;
+    my $done = 0;
+    for my $i (1..$count) {
+        $client->put("$dir$i", "v$i", sub { $cb->() if ++$done == $count });
+    }
+}
+
+my $writer = EV::Etcd->new(endpoints => ['127.0.0.1:2379']);
+my $count = 300;
+
+# Bursts of watch responses arrive in order and intact, with and without MULTICALL
+for my $multicall (1, 0) {
+    my $client = EV::Etcd->new(
+        endpoints => ['127.0.0.1:2379'],
+        multicall => $multicall,
+    );
+    my $dir = "$prefix/flood$multicall/";
+    my (@revs, %refs, $ready, $calls);
+
+    my $watch = $client->watch($dir, { prefix => 1 }, sub {
+        my ($resp, $err) = @_;
+        return fail("watch error: $err->{message}") if $err;
+        $calls++;
+        $refs{\$resp} = \$resp;  # held refs force a fresh lexical per call
+        if (!$ready) {
+            $ready = 1;
+            EV::break;
+            return;
+        }
+        push @revs, $_->{kv}{mod_revision} for @{$resp->{events}};
+        EV::break if @revs >= $count;
+    });
+    run_with_timeout();
+
+    flood($writer, $dir, $count, sub {});
+    run_with_timeout();
+
+    is(scalar @revs, $count, "multicall=$multicall: all events delivered");
+    is_deeply(\@revs, [sort { $a <=> $b } @revs],
+        "multicall=$multicall: events delivered in revision order");
+    is(scalar keys %refs, $calls,
+        "multicall=$multicall: each call got fresh lexicals");
+
+    $watch->cancel(sub { EV::break });
+    run_with_timeout();
+}
+
+# Cancelling from inside the callback stops delivery of a held-back burst
+{
+    my $client = EV::Etcd->new(endpoints => ['127.0.0.1:2379']);
+    my $dir = "$prefix/cancel/";
+    my ($ready, $calls_after_cancel, $watch) = (0, 0, undef);
+    my $cancelled;
+
+    $watch = $client->watch($dir, { prefix => 1 }, sub {
+        my ($resp, $err) = @_;
+        if (!$ready) {
+            $ready = 1;
+            EV::break;
+            return;
+        }
+        if ($cancelled) {
+            $calls_after_cancel++;
+            return;
+        }
+        $cancelled = 1;
+        $watch->cancel(sub {});
+    });
+    run_with_timeout();
+
+    flood($writer, $dir, $count, sub {
+        my $t; $t = EV::timer(0.5, 0, sub { undef $t; EV::break });
+    });
+    run_with_timeout();
+
+    ok($cancelled, 'watch saw events before cancel');
+    is($calls_after_cancel, 0, 'no watch callbacks after cancel');
+}
+
+# Cleanup
+$writer->delete("$prefix/", { prefix => 1 }, sub {
+    ok(!$_[1], 'cleanup succeeded');
+    EV::break;
+});
+run_with_timeout();
+
+done_testing();
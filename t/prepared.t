@@ -0,0 +1,115 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use lib 'blib/lib', 'blib/arch';
+use Test::More;
+
+BEGIN {
+    eval { require EV };
+    plan skip_all => 'EV required' if $@;
+}
+
+use EV;
+use EV::Etcd;
+
+# Check if etcd is available
+my $etcd_available = 0;
+eval {
+    my $client = EV::Etcd->new(
+        endpoints => ['127.0.0.1:2379'],
+        timeout => 2,
+    );
+    $client->status(sub {
+        my ($resp, $err) = @_;
+        $etcd_available = 1 if !$err;
+        EV::break;
+    });
+    my $t = EV::timer(3, 0, sub { EV::break });
+    EV::run;
+};
+plan skip_all => 'etcd not available on 127.0.0.1:2379' unless $etcd_available;
+
+my $client = EV::Etcd->new(
+    endpoints => ['127.0.0.1:2379'],
+);
+
+my $prefix = "/test-prepared-$$-" . time();
+
+sub run_with_timeout {
+    my $t = EV::timer(5, 0, sub { fail('timeout'); EV::break });
+    EV::run;
+}
+
+# Argument validation
+eval { $client->prepare(delete => "$prefix/x") };
+like($@, qr/unsupported operation/, 'prepare rejects unknown operation');
+eval { $client->prepare(get => "$prefix/x", { format => 'bogus' }) };
+like($@, qr/unknown format/, 'prepare validates options up front');
+
+my $put = $client->prepare(put => "$prefix/key", { prev_kv => 1 });
+isa_ok($put, 'EV::Etcd::Prepared');
+
+eval { $put->run(sub {}) };
+like($@, qr/Usage/, 'prepared put requires a value');
+
+# Repeated prepared put: value is spliced in per run
+my @prev;
+my $n = 0;
+my $next;
+$next = sub {
+    if ($n == 3) { EV::break; return }
+    $put->run('v' . $n++, sub {
+        my ($resp, $err) = @_;
+        ok(!$err, "prepared put $n succeeded");
+        push @prev, $resp->{prev_kv} ? $resp->{prev_kv}{value} : undef;
+        $next->();
+    });
+};
+$next->();
+run_with_timeout();
+is_deeply(\@prev, [undef, 'v0', 'v1'], 'prev_kv option was baked into the request');
+
+# Large value (multi-byte length varint) and empty value
+$put->run('x' x 300, sub {
+    my ($resp, $err) = @_;
+    ok(!$err, 'prepared put with 300-byte value');
+    $client->get("$prefix/key", sub {
+        is($_[0]{kvs}[0]{value}, 'x' x 300, 'large value stored intact');
+        $put->run('', sub {
+            ok(!$_[1], 'prepared put with empty value');
+            $client->get("$prefix/key", sub {
+                is($_[0]{kvs}[0]{value}, '', 'empty value stored');
+                EV::break;
+            });
+        });
+    });
+});
+run_with_timeout();
+
+# Prepared get with prefix and format
+$client->put("$prefix/other", "o", sub { EV::break });
+run_with_timeout();
+
+my $get = $client->prepare(get => "$prefix/", { prefix => 1, format => 'map' });
+for my $round (1..2) {
+    $get->run(sub {
+        my ($resp, $err) = @_;
+        ok(!$err, "prepared get run $round");
+        is_deeply($resp->{kvs}, { "$prefix/key" => '', "$prefix/other" => 'o' },
+            "prepared get run $round returns map");
+        EV::break;
+    });
+    run_with_timeout();
+}
+
+eval { $get->run('extra', sub {}) };
+like($@, qr/Usage/, 'prepared get takes only a callback');
+
+# Cleanup
+$client->delete("$prefix/", { prefix => 1 }, sub {
+    ok(!$_[1], 'cleanup succeeded');
+    EV::break;
+});
+run_with_timeout();
+
+done_testing();
@@ -0,0 +1,101 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use lib 'blib/lib', 'blib/arch';
+use Test::More;
+
+BEGIN {
+    eval { require EV };
+    plan skip_all => 'EV required' if $@;
+}
+
+use EV;
+use EV::Etcd;
+
+# Check if etcd is available
+my $etcd_available = 0;
+eval {
+    my $client = EV::Etcd->new(
+        endpoints => ['127.0.0.1:2379'],
+        timeout => 2,
+    );
+    $client->status(sub {
+        my ($resp, $err) = @_;
+        $etcd_available = 1 if !$err;
+        EV::break;
+    });
+    my $t = EV::timer(3, 0, sub { EV::break });
+    EV::run;
+};
+plan skip_all => 'etcd not available on 127.0.0.1:2379' unless $etcd_available;
+
+my $client = EV::Etcd->new(
+    endpoints => ['127.0.0.1:2379'],
+);
+
+my $prefix = "/test-raw-$$-" . time();
+
+sub run_with_timeout {
+    my $t = EV::timer(5, 0, sub { fail('timeout'); EV::break });
+    EV::run;
+}
+
+# Minimal protobuf encoding of a RangeRequest { key = $key }
+sub range_request {
+    my ($key) = @_;
+    return "\x0a" . chr(length $key) . $key;   # keys here are < 128 bytes
+}
+
+eval { $client->raw_call('/etcdserverpb.KV/Nope', '', sub {}) };
+like($@, qr/unknown or streaming method/, 'unknown method croaks');
+eval { $client->raw_call('/etcdserverpb.Watch/Watch', '', sub {}) };
+like($@, qr/unknown or streaming method/, 'streaming method croaks');
+
+# raw put
+$client->put("$prefix/k", "hello", { raw => 1 }, sub {
+    my ($bytes, $err) = @_;
+    ok(!$err, 'raw put succeeded');
+    ok(defined $bytes && !ref $bytes, 'raw put delivers a plain scalar');
+    EV::break;
+});
+run_with_timeout();
+
+# raw get and raw_call(Range) return the same bytes for the same request
+my ($get_bytes, $call_bytes);
+$client->get("$prefix/k", { raw => 1 }, sub {
+    my ($bytes, $err) = @_;
+    ok(!$err, 'raw get succeeded');
+    $get_bytes = $bytes;
+    $client->raw_call('etcdserverpb.KV/Range', range_request("$prefix/k"), sub {
+        my ($bytes, $err) = @_;
+        ok(!$err, 'raw_call Range succeeded (no leading slash)');
+        $call_bytes = $bytes;
+        EV::break;
+    });
+});
+run_with_timeout();
+
+ok(length $get_bytes, 'raw get returned bytes');
+is($call_bytes, $get_bytes, 'raw_call matches raw get');
+like($get_bytes, qr/\Q$prefix\E\/k/, 'response bytes contain the key');
+like($get_bytes, qr/hello/, 'response bytes contain the value');
+
+# Errors are still delivered as hashrefs
+$client->raw_call('/etcdserverpb.KV/Range', "\xff\xff\xff", sub {
+    my ($bytes, $err) = @_;
+    ok(!defined $bytes, 'no bytes on error');
+    ok(ref $err eq 'HASH' && $err->{code}, 'error hashref on malformed request');
+    EV::break;
+});
+run_with_timeout();
+
+# raw delete
+$client->delete("$prefix/", { prefix => 1, raw => 1 }, sub {
+    my ($bytes, $err) = @_;
+    ok(!$err, 'raw delete succeeded');
+    ok(defined $bytes && !ref $bytes, 'raw delete delivers bytes');
+    EV::break;
+});
+run_with_timeout();
+
+done_testing();
@@ -0,0 +1,160 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use lib 'blib/lib', 'blib/arch';
+use Test::More;
+
+BEGIN {
+    eval { require EV };
+    plan skip_all => 'EV required' if $@;
+}
+
+use EV;
+use EV::Etcd;
+
+# Check if etcd is available
+my $etcd_available = 0;
+eval {
+    my $client = EV::Etcd->new(
+        endpoints => ['127.0.0.1:2379'],
+        timeout => 2,
+    );
+    $client->status(sub {
+        my ($resp, $err) = @_;
+        $etcd_available = 1 if !$err;
+        EV::break;
+    });
+    my $t = EV::timer(3, 0, sub { EV::break });
+    EV::run;
+};
+plan skip_all => 'etcd not available on 127.0.0.1:2379' unless $etcd_available;
+
+my $client = EV::Etcd->new(
+    endpoints => ['127.0.0.1:2379'],
+);
+
+my $prefix = "/test-format-$$-" . time();
+
+sub run_with_timeout {
+    my $t = EV::timer(5, 0, sub { fail('timeout'); EV::break });
+    EV::run;
+}
+
+# Unknown format croaks before any call is made
+eval { $client->get("$prefix/", { format => 'bogus' }, sub {}) };
+like($@, qr/unknown format/, 'unknown format croaks');
+eval {
+    $client->txn([], [ { request_range => { key => "$prefix/a", format => 'map' } } ],
+        [ { request_range => { key => "$prefix/a", format => 'bogus' } } ], sub {});
+};
+like($@, qr/unknown format/, 'unknown txn op format croaks');
+
+# Setup
+my $setup_done = 0;
+for my $i (1..3) {
+    $client->put("$prefix/key$i", "val$i", sub {
+        $setup_done++;
+        EV::break if $setup_done == 3;
+    });
+}
+run_with_timeout();
+
+# map
+$client->get("$prefix/", { prefix => 1, format => 'map' }, sub {
+    my ($resp, $err) = @_;
+    ok(!$err, 'get format=map succeeded');
+    is_deeply($resp->{kvs},
+        { map { ("$prefix/key$_" => "val$_") } 1..3 },
+        'map format returns key => value');
+    is($resp->{count}, 3, 'count still present');
+    EV::break;
+});
+run_with_timeout();
+
+# pairs
+$client->get("$prefix/", { prefix => 1, format => 'pairs', sort_order => 'ascend' }, sub {
+    my ($resp, $err) = @_;
+    ok(!$err, 'get format=pairs succeeded');
+    is_deeply($resp->{kvs},
+        [ map { ("$prefix/key$_", "val$_") } 1..3 ],
+        'pairs format returns flat key/value list');
+    EV::break;
+});
+run_with_timeout();
+
+# columns
+$client->get("$prefix/", { prefix => 1, format => 'columns' }, sub {
+    my ($resp, $err) = @_;
+    ok(!$err, 'get format=columns succeeded');
+    is_deeply($resp->{kvs}{keys}, [ map { "$prefix/key$_" } 1..3 ], 'columns keys');
+    is_deeply($resp->{kvs}{values}, [ map { "val$_" } 1..3 ], 'columns values');
+    is(scalar @{$resp->{kvs}{mod_revisions}}, 3, 'columns mod_revisions');
+    EV::break;
+});
+run_with_timeout();
+
+# keys_only with map gives empty values
+$client->get("$prefix/", { prefix => 1, keys_only => 1, format => 'map' }, sub {
+    my ($resp, $err) = @_;
+    is_deeply($resp->{kvs}, { map { ("$prefix/key$_" => '') } 1..3 },
+        'keys_only map has empty values');
+    EV::break;
+});
+run_with_timeout();
+
+# txn range op with format
+$client->txn(
+    compare => [],
+    success => [
+        { request_put => { key => "$prefix/key4", value => "val4" } },
+        { request_range => { key => "$prefix/key1", format => 'map' } },
+        { request_range => { key => "$prefix/key2" } },
+    ],
+    failure => [],
+    sub {
+        my ($resp, $err) = @_;
+        ok(!$err, 'txn with formatted range succeeded');
+        is_deeply($resp->{responses}[1]{response_range}{kvs},
+            { "$prefix/key1" => 'val1' }, 'txn range op uses map format');
+        is($resp->{responses}[2]{response_range}{kvs}[0]{value}, 'val2',
+            'other txn range op keeps full format');
+        EV::break;
+    }
+);
+run_with_timeout();
+
+# watch with columns format
+my @batches;
+my $watch;
+$watch = $client->watch("$prefix/", { prefix => 1, format => 'columns' }, sub {
+    my ($resp, $err) = @_;
+    return if $err || !@{$resp->{events}{keys}};
+    push @batches, $resp->{events};
+    EV::break if grep { $_ eq 'DELETE' } @{$resp->{events}{types}};
+});
+my $kick = EV::timer(0.5, 0, sub {
+    $client->put("$prefix/key1", "new1", sub {
+        $client->delete("$prefix/key2", sub {});
+    });
+});
+run_with_timeout();
+
+my (%values, %types);
+for my $cols (@batches) {
+    for my $i (0 .. $#{$cols->{keys}}) {
+        $values{$cols->{keys}[$i]} = $cols->{values}[$i];
+        $types{$cols->{keys}[$i]} = $cols->{types}[$i];
+    }
+}
+is($values{"$prefix/key1"}, 'new1', 'watch columns carries PUT value');
+is($types{"$prefix/key2"}, 'DELETE', 'watch columns marks DELETE');
+ok(!defined $values{"$prefix/key2"}, 'DELETE has undef value');
+
+# Cleanup
+$client->delete("$prefix/", { prefix => 1 }, sub {
+    ok(!$_[1], 'cleanup succeeded');
+    EV::break;
+});
+run_with_timeout();
+
+done_testing();
@@ -0,0 +1,145 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use lib 'blib/lib', 'blib/arch';
+use Test::More;
+
+BEGIN {
+    eval { require EV };
+    plan skip_all => 'EV required' if $@;
+}
+
+use EV;
+use EV::Etcd;
+
+# Check if etcd is available
+my $etcd_available = 0;
+eval {
+    my $client = EV::Etcd->new(
+        endpoints => ['127.0.0.1:2379'],
+        timeout => 2,
+    );
+    $client->status(sub {
+        my ($resp, $err) = @_;
+        $etcd_available = 1 if !$err;
+        EV::break;
+    });
+    my $t = EV::timer(3, 0, sub { EV::break });
+    EV::run;
+};
+plan skip_all => 'etcd not available on 127.0.0.1:2379' unless $etcd_available;
+
+my $client = EV::Etcd->new(
+    endpoints => ['127.0.0.1:2379'],
+);
+
+my $prefix = "/test-session-$$-" . time();
+
+sub run_with_timeout {
+    my $t = EV::timer(5, 0, sub { fail('timeout'); EV::break });
+    EV::run;
+}
+
+sub wait_for {
+    my ($seconds) = @_;
+    my $t = EV::timer($seconds, 0, sub { EV::break });
+    EV::run;
+}
+
+# Argument validation
+eval { $client->session(ttl => 0) };
+like($@, qr/ttl must be a positive integer/, 'session rejects a zero ttl');
+eval { $client->session(on_lost => 1) };
+like($@, qr/on_lost must be a code reference/, 'session rejects a non-code on_lost');
+
+my (@ready, @lost);
+my $session = $client->session(
+    ttl      => 3,
+    on_ready => sub { push @ready, $_[0]; EV::break },
+    on_lost  => sub { push @lost, $_[0] },
+);
+ok(!defined $session->lease, 'no lease before the grant completes');
+
+# Queued until the lease is there
+my ($lock, $lock_lost);
+my $queued = $session->lock("$prefix/lock", sub {
+    my ($resp, $err) = @_;
+    if ($err) { $lock_lost = $err } else { $lock = $resp }
+    EV::break;
+});
+my @puts;
+$session->put("$prefix/member", 'me', sub { push @puts, [@_]; EV::break });
+
+my $t = EV::timer(5, 0, sub { fail('timeout'); EV::break });
+EV::run until $lock && @puts || !$t->is_active;
+is(scalar @ready, 1, 'on_ready called once');
+my $lease = $session->lease;
+ok($lease, 'session has a lease');
+is($ready[0], $lease, 'on_ready got the lease id');
+like($lock->{key}, qr/^\Q$prefix\E\/lock/, 'lock acquired under the session');
+ok(!$puts[0][1], 'ephemeral key put');
+
+ok(!defined $queued, 'no handle while waiting for the lease');
+
+my $leader;
+my $campaign = $session->campaign("$prefix/election", 'me', sub {
+    my ($resp, $err) = @_;
+    $leader = $err ? 0 : $resp->{leader};
+    EV::break;
+});
+isa_ok($campaign, 'EV::Etcd::Call', 'campaign under a lease');
+run_with_timeout();
+ok($leader, 'campaign won under the session');
+
+my $stats = $session->stats;
+is($stats->{locks}, 1, 'one lock held');
+is($stats->{leaders}, 1, 'one leadership held');
+is($stats->{keys}, 1, 'one ephemeral key');
+
+my $kv;
+$client->get("$prefix/member", sub { $kv = $_[0]{kvs}[0]; EV::break });
+run_with_timeout();
+is($kv->{lease}, $lease, 'ephemeral key attached to the session lease');
+
+# Lose the lease behind the session's back
+my $other = EV::Etcd->new(endpoints => ['127.0.0.1:2379']);
+$other->lease_revoke($lease, sub { EV::break });
+run_with_timeout();
+
+$t = EV::timer(5, 0, sub { EV::break });
+EV::run until @ready == 2 && @puts == 2 || !$t->is_active;
+is(scalar @lost, 1, 'on_lost called once');
+is($lost[0]{source}, 'lease', 'loss reported by the lease manager');
+ok($lock_lost, 'lock holder told about the loss');
+is($lock_lost, $lost[0], 'same error fanned out');
+is(scalar @ready, 2, 'one re-establishment');
+isnt($session->lease, $lease, 'new lease');
+is(scalar @puts, 2, 'ephemeral key put again');
+
+$client->get("$prefix/member", sub { $kv = $_[0]{kvs}[0]; EV::break });
+run_with_timeout();
+is($kv->{lease}, $session->lease, 'ephemeral key restored under the new lease');
+
+$stats = $session->stats;
+is($stats->{grants}, 2, 'two grants');
+is($stats->{losses}, 1, 'one loss');
+is($stats->{locks}, 0, 'lost lock no longer held');
+is($stats->{leaders}, 0, 'lost leadership no longer held');
+
+# Close revokes the lease and everything bound to it
+$session->close(sub { EV::break });
+run_with_timeout();
+$client->get("$prefix/member", sub { $kv = $_[0]{kvs}; EV::break });
+run_with_timeout();
+is(scalar @{ $kv || [] }, 0, 'ephemeral key removed by close');
+eval { $session->lock('x', sub {}) };
+like($@, qr/closed/, 'closed session rejects work');
+
+# Work waiting for a lease fails on close
+my $waiting_err;
+my $s2 = $client->session(ttl => 5);
+$s2->lock("$prefix/lock2", sub { $waiting_err = $_[1] });
+$s2->close;
+is($waiting_err->{status}, 'CANCELLED', 'waiting work cancelled by close');
+
+done_testing();
@@ -0,0 +1,122 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use lib 'blib/lib', 'blib/arch';
+use Test::More;
+
+BEGIN {
+    eval { require EV };
+    plan skip_all => 'EV required' if $@;
+}
+
+use EV;
+use EV::Etcd;
+
+# Check if etcd is available
+my $etcd_available = 0;
+eval {
+    my $client = EV::Etcd->new(
+        endpoints => ['127.0.0.1:2379'],
+        timeout => 2,
+    );
+    $client->status(sub {
+        my ($resp, $err) = @_;
+        $etcd_available = 1 if !$err;
+        EV::break;
+    });
+    my $t = EV::timer(3, 0, sub { EV::break });
+    EV::run;
+};
+plan skip_all => 'etcd not available on 127.0.0.1:2379' unless $etcd_available;
+
+my $client = EV::Etcd->new(
+    endpoints => ['127.0.0.1:2379'],
+);
+
+my $prefix = "/test-sync-$$-" . time();
+
+sub run_with_timeout {
+    my $t = EV::timer(5, 0, sub { fail('timeout'); EV::break });
+    EV::run;
+}
+
+# Argument validation
+eval { $client->sync($prefix, sub {}) };
+like($@, qr/Usage/, 'sync requires both callbacks');
+eval { $client->sync($prefix, { page_size => 0 }, sub {}, sub {}) };
+like($@, qr/page_size/, 'sync rejects a non-positive page_size');
+eval { $client->sync($prefix, { format => 'bogus' }, sub {}, sub {}) };
+like($@, qr/unknown format/, 'sync validates format up front');
+
+# Seed five keys
+my $seeded = 0;
+for my $i (1..5) {
+    $client->put("$prefix/k$i", "v$i", sub { EV::break if ++$seeded == 5 });
+}
+run_with_timeout();
+
+# Paged snapshot pinned to one revision, then events from the next one
+my (@chunks, %snapshot, @events);
+my $watch = $client->sync("$prefix/", { page_size => 2 }, sub {
+    my ($chunk, $err) = @_;
+    ok(!$err, 'snapshot chunk without error') or diag explain $err;
+    push @chunks, $chunk;
+    $snapshot{$_->{key}} = $_->{value} for @{$chunk->{kvs}};
+    # Written mid-snapshot: must arrive as an event, not in a later page
+    $client->put("$prefix/k9", "late", sub {}) if @chunks == 1;
+}, sub {
+    my ($resp, $err) = @_;
+    return if $err || !$resp->{events} || !@{$resp->{events}};
+    push @events, @{$resp->{events}};
+    EV::break;
+});
+isa_ok($watch, 'EV::Etcd::Watch');
+run_with_timeout();
+
+is(scalar @chunks, 3, 'five keys in pages of two arrive as three chunks');
+is_deeply([map { $_->{more} } @chunks], [1, 1, 0], 'more is cleared on the last chunk');
+is(scalar(grep { $_->{revision} == $chunks[0]{revision} } @chunks), 3,
+    'all chunks report the same snapshot revision');
+is_deeply(\%snapshot, { map { ("$prefix/k$_" => "v$_") } 1..5 },
+    'snapshot holds exactly the seeded keys');
+is(scalar @events, 1, 'one event after the snapshot');
+is($events[0]{kv}{key}, "$prefix/k9", 'write made during the snapshot arrives as an event');
+cmp_ok($events[0]{kv}{mod_revision}, '>', $chunks[0]{revision},
+    'event is newer than the snapshot');
+
+$watch->cancel(sub { EV::break });
+run_with_timeout();
+
+# Empty range: a single final chunk, format applies to kvs
+my @empty;
+my $w2 = $client->sync("$prefix-none/", { format => 'map' }, sub {
+    push @empty, $_[0];
+    EV::break;
+}, sub {});
+run_with_timeout();
+is(scalar @empty, 1, 'empty range yields one chunk');
+is_deeply($empty[0]{kvs}, {}, 'empty map for an empty range');
+is($empty[0]{more}, 0, 'empty chunk is the last one');
+
+# Cancel from the chunk callback stops paging
+my $pages = 0;
+my $w3;
+$w3 = $client->sync("$prefix/", { page_size => 1 }, sub {
+    $pages++;
+    $w3->cancel(sub {});
+    my $t; $t = EV::timer(0.3, 0, sub { undef $t; EV::break });
+}, sub { fail('no events after cancel') });
+run_with_timeout();
+is($pages, 1, 'cancel during the snapshot stops further pages');
+
+$w2->cancel(sub { EV::break });
+run_with_timeout();
+
+# Cleanup
+$client->delete("$prefix/", { prefix => 1 }, sub {
+    ok(!$_[1], 'cleanup succeeded');
+    EV::break;
+});
+run_with_timeout();
+
+done_testing();
@@ -0,0 +1,113 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use lib 'blib/lib', 'blib/arch';
+use Test::More;
+
+BEGIN {
+    eval { require EV };
+    plan skip_all => 'EV required' if $@;
+}
+
+use EV;
+use EV::Etcd;
+
+# Check if etcd is available
+my $etcd_available = 0;
+eval {
+    my $client = EV::Etcd->new(
+        endpoints => ['127.0.0.1:2379'],
+        timeout => 2,
+    );
+    $client->status(sub {
+        my ($resp, $err) = @_;
+        $etcd_available = 1 if !$err;
+        EV::break;
+    });
+    my $t = EV::timer(3, 0, sub { EV::break });
+    EV::run;
+};
+plan skip_all => 'etcd not available on 127.0.0.1:2379' unless $etcd_available;
+
+my $client = EV::Etcd->new(
+    endpoints => ['127.0.0.1:2379'],
+);
+
+my $prefix = "/test-timeouts-$$-" . time();
+
+sub run_with_timeout {
+    my $t = EV::timer(5, 0, sub { fail('timeout'); EV::break });
+    EV::run;
+}
+
+# Option validation
+eval { EV::Etcd->new(timeouts => { nosuch => 1 }) };
+like($@, qr/unknown method 'nosuch'/, 'unknown method rejected');
+eval { EV::Etcd->new(timeouts => { get => -1 }) };
+like($@, qr/must not be negative/, 'negative method timeout rejected');
+eval { EV::Etcd->new(timeouts => [get => 1]) };
+like($@, qr/timeouts must be a hash reference/, 'non-hash timeouts rejected');
+eval { $client->get("$prefix/x", { timeout => -1 }, sub {}) };
+like($@, qr/get: timeout must not be negative/, 'negative per-call timeout rejected');
+
+# Plain calls still work with fractional and per-method timeouts
+my $fast = EV::Etcd->new(
+    endpoints => ['127.0.0.1:2379'],
+    timeout   => 2.5,
+    timeouts  => { get => 1.5, put => 0, lock => 0.3 },
+);
+my ($resp, $err);
+$fast->put("$prefix/k", 'v', sub { ($resp, $err) = @_; EV::break });
+run_with_timeout();
+ok(!$err, 'put without deadline');
+$fast->get("$prefix/k", { timeout => 0.75 }, sub { ($resp, $err) = @_; EV::break });
+run_with_timeout();
+is($resp->{kvs}[0]{value}, 'v', 'get with per-call timeout');
+$fast->txn(
+    compare => [{ key => "$prefix/k", target => 'value', value => 'v' }],
+    success => [],
+    timeout => 0.75,
+    sub { ($resp, $err) = @_; EV::break },
+);
+run_with_timeout();
+ok($resp->{succeeded}, 'txn with per-call timeout');
+$fast->txn([], [], [], { timeout => 0.75 }, sub { ($resp, $err) = @_; EV::break });
+run_with_timeout();
+ok(!$err, 'positional txn with options');
+eval { $client->txn([], [], [], { timeout => -1 }, sub {}) };
+like($@, qr/txn: timeout must not be negative/, 'txn timeout validated');
+
+# Per-method default: lock on a held name times out after 0.3s
+my @leases;
+for (1 .. 2) {
+    $client->lease_grant(30, { timeout => 1 }, sub { push @leases, $_[0]{id}; EV::break });
+    run_with_timeout();
+}
+my $name = "$prefix/lock";
+$client->lock($name, $leases[0], sub { $resp = $_[0]; EV::break });
+run_with_timeout();
+ok($resp->{key}, 'lock held');
+
+my $t0 = EV::time;
+$fast->lock($name, $leases[1], sub { ($resp, $err) = @_; EV::break });
+run_with_timeout();
+is($err->{status}, 'DEADLINE_EXCEEDED', 'per-method lock deadline');
+my $took = EV::time - $t0;
+ok($took < 2, "well before the client timeout ($took s)");
+
+# Per-call option wins over the per-method default
+$t0 = EV::time;
+$fast->lock($name, $leases[1], { timeout => 1 }, sub { ($resp, $err) = @_; EV::break });
+run_with_timeout();
+is($err->{status}, 'DEADLINE_EXCEEDED', 'per-call lock deadline');
+$took = EV::time - $t0;
+ok($took >= 0.9, "per-call timeout overrides method default ($took s)");
+
+for my $lease (@leases) {
+    $client->lease_revoke($lease, sub { EV::break });
+    run_with_timeout();
+}
+$client->delete($prefix, { prefix => 1 }, sub { EV::break });
+run_with_timeout();
+
+done_testing();
@@ -0,0 +1,130 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use lib 'blib/lib', 'blib/arch';
+use Test::More;
+
+BEGIN {
+    eval { require EV };
+    plan skip_all => 'EV required' if $@;
+}
+
+use EV;
+use EV::Etcd;
+
+# Check if etcd is available
+my $etcd_available = 0;
+eval {
+    my $client = EV::Etcd->new(
+        endpoints => ['127.0.0.1:2379'],
+        timeout => 2,
+    );
+    $client->status(sub {
+        my ($resp, $err) = @_;
+        $etcd_available = 1 if !$err;
+        EV::break;
+    });
+    my $t = EV::timer(3, 0, sub { EV::break });
+    EV::run;
+};
+plan skip_all => 'etcd not available on 127.0.0.1:2379' unless $etcd_available;
+
+my $client = EV::Etcd->new(
+    endpoints => ['127.0.0.1:2379'],
+);
+
+my $prefix = "/test-try-lock-$$-" . time();
+
+sub run_with_timeout {
+    my $t = EV::timer(5, 0, sub { fail('timeout'); EV::break });
+    EV::run;
+}
+
+sub grant {
+    my $id;
+    $client->lease_grant(30, sub { $id = $_[0]{id}; EV::break });
+    run_with_timeout();
+    return $id;
+}
+
+sub wait_for {
+    my ($seconds) = @_;
+    my $t = EV::timer($seconds, 0, sub { EV::break });
+    EV::run;
+}
+
+my @leases = map { grant() } 1 .. 4;
+ok(!grep({ !$_ } @leases), 'granted leases');
+my $name = "$prefix/lock";
+
+# Free lock is taken at once
+my $held;
+$client->try_lock($name, $leases[0], sub { $held = $_[0]; EV::break });
+run_with_timeout();
+ok($held->{acquired}, 'try_lock acquired a free lock');
+is($held->{key}, "$name/" . sprintf('%x', $leases[0]), 'lock key matches the server lock layout');
+
+my $again;
+$client->try_lock($name, $leases[0], sub { $again = $_[0]; EV::break });
+run_with_timeout();
+ok($again->{acquired}, 'same lease acquires again');
+
+# Busy lock is refused without a waiter left behind
+my $busy;
+$client->try_lock($name, $leases[1], sub { $busy = $_[0]; EV::break });
+run_with_timeout();
+ok(!$busy->{acquired}, 'try_lock refused while held');
+is($busy->{owner}, $held->{key}, 'owner reported');
+my $count;
+$client->get("$name/", { prefix => 1, count_only => 1 }, sub { $count = $_[0]{count}; EV::break });
+run_with_timeout();
+is($count, 1, 'refused key removed again');
+
+# Waiters are served in order
+my @order;
+$client->lock_wait($name, $leases[1], sub { push @order, [1, @_]; EV::break });
+$client->lock_wait($name, $leases[2], sub { push @order, [2, @_]; EV::break });
+wait_for(1);
+is(scalar @order, 0, 'lock_wait blocks while held');
+
+# The server's Lock queues behind them
+my $server_lock;
+$client->lock($name, $leases[3], sub { $server_lock = $_[0] });
+wait_for(0.5);
+
+$client->unlock($held->{key}, sub { EV::break });
+run_with_timeout();
+my $t = EV::timer(5, 0, sub { EV::break });
+EV::run until @order || !$t->is_active;
+is($order[0][0], 1, 'first waiter acquired after release');
+ok($order[0][1]{key}, 'lock_wait returns the lock key');
+wait_for(0.5);
+is(scalar @order, 1, 'second waiter still waiting');
+ok(!$server_lock, 'server lock still waiting');
+
+$client->unlock($order[0][1]{key}, sub { EV::break });
+run_with_timeout();
+$t = EV::timer(5, 0, sub { EV::break });
+EV::run until @order == 2 || !$t->is_active;
+is($order[1][0], 2, 'second waiter acquired next');
+
+$client->unlock($order[1][1]{key}, sub { EV::break });
+run_with_timeout();
+$t = EV::timer(5, 0, sub { EV::break });
+EV::run until $server_lock || !$t->is_active;
+ok($server_lock, 'server lock acquired last');
+
+# txn range ops take range options
+my $txn;
+$client->txn([], [ { request_range => {
+    key => "$name/", range_end => "${name}0", count_only => 1,
+} } ], [], sub { $txn = $_[0]; EV::break });
+run_with_timeout();
+is($txn->{responses}[0]{response_range}{count}, 1, 'count_only honoured in a txn range op');
+
+for my $lease (@leases) {
+    $client->lease_revoke($lease, sub { EV::break });
+    run_with_timeout();
+}
+
+done_testing();
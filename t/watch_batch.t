@@ -0,0 +1,152 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use lib 'blib/lib', 'blib/arch';
+use Test::More;
+
+BEGIN {
+    eval { require EV };
+    plan skip_all => 'EV required' if $@;
+}
+
+use EV;
+use EV::Etcd;
+
+# Check if etcd is available
+my $etcd_available = 0;
+eval {
+    my $client = EV::Etcd->new(
+        endpoints => ['127.0.0.1:2379'],
+        timeout => 2,
+    );
+    $client->status(sub {
+        my ($resp, $err) = @_;
+        $etcd_available = 1 if !$err;
+        EV::break;
+    });
+    my $t = EV::timer(3, 0, sub { EV::break });
+    EV::run;
+};
+
+plan skip_all => 'etcd not available on 127.0.0.1:2379' unless $etcd_available;
+
+my $client = EV::Etcd->new(endpoints => ['127.0.0.1:2379']);
+my $prefix = "/test-watch-batch-$$-" . time();
+
+sub run_with_timeout {
+    my $t = EV::timer(10, 0, sub { fail('timeout'); EV::break });
+    EV::run;
+}
+
+# Start a watch, wait for its creation notice, then put $count keys at once
+sub flood_watch {
+    my ($dir, $opts, $count, $on_resp) = @_;
+    my $ready = 0;
+    my $watch = $client->watch($dir, { prefix => 1, %$opts }, sub {
+        my ($resp, $err) = @_;
+        return fail("watch error: $err->{message}") if $err;
+        if (!$ready) {
+            $ready = 1;
+            ok($resp->{created}, 'creation notice delivered on its own');
+            EV::break;
+            return;
+        }
+        $on_resp->($resp);
+    });
+    run_with_timeout();
+    $client->put("$dir$_", "v$_", sub {}) for 1..$count;
+    run_with_timeout();
+    $watch->cancel(sub { EV::break });
+    run_with_timeout();
+}
+
+my $count = 200;
+
+# batch => 1: fewer callbacks than events, nothing lost or reordered
+{
+    my ($calls, @revs, $last_header_rev) = (0);
+    flood_watch("$prefix/all/", { batch => 1 }, $count, sub {
+        my ($resp) = @_;
+        $calls++;
+        push @revs, map { $_->{kv}{mod_revision} } @{$resp->{events}};
+        $last_header_rev = $resp->{header}{revision};
+        EV::break if @revs >= $count;
+    });
+    is(scalar @revs, $count, 'batch: all events delivered');
+    is_deeply(\@revs, [sort { $a <=> $b } @revs], 'batch: events in revision order');
+    cmp_ok($calls, '<', $count, "batch: $count events in $calls callbacks");
+    is($last_header_rev, $revs[-1], 'batch: header carries the last revision');
+}
+
+# max_batch caps merged events (each put arrives as a one-event response)
+{
+    my ($max, $total) = (0, 0);
+    flood_watch("$prefix/capped/", { max_batch => 10 }, $count, sub {
+        my $n = @{$_[0]{events}};
+        $max = $n if $n > $max;
+        $total += $n;
+        EV::break if $total >= $count;
+    });
+    is($total, $count, 'max_batch: all events delivered');
+    cmp_ok($max, '<=', 10, 'max_batch: no callback exceeds the cap');
+}
+
+# map format: keys merge, later values win
+{
+    my %seen;
+    flood_watch("$prefix/map/", { batch => 1, format => 'map' }, $count, sub {
+        my $events = $_[0]{events};
+        @seen{keys %$events} = values %$events;
+        EV::break if keys %seen >= $count;
+    });
+    is(scalar keys %seen, $count, 'map batch: every key seen');
+    is($seen{"$prefix/map/7"}, 'v7', 'map batch: values intact');
+}
+
+# coalesce: only the newest event per key survives the window
+{
+    my $dir = "$prefix/coalesce/";
+    my ($ready, @calls) = (0);
+    my $watch = $client->watch($dir, { prefix => 1, coalesce => 0.5 }, sub {
+        my ($resp, $err) = @_;
+        return fail("watch error: $err->{message}") if $err;
+        if (!$ready) { $ready = 1; EV::break; return }
+        push @calls, $resp;
+        EV::break;
+    });
+    run_with_timeout();
+
+    # Issue writes in sequence so the last write to each key is known
+    my @writes = ((map { [put => 'a', "a$_"], [put => 'b', "b$_"] } 1..20), [delete => 'a']);
+    my $next; $next = sub {
+        my $w = shift @writes or return;
+        my ($op, $k, $v) = @$w;
+        $op eq 'put'
+            ? $client->put("$dir$k", $v, $next)
+            : $client->delete("$dir$k", $next);
+    };
+    $next->();
+    run_with_timeout();
+
+    is(scalar @calls, 1, 'coalesce: one callback for the whole window');
+    my @events = @{$calls[0]{events}};
+    is(scalar @events, 2, 'coalesce: one event per key');
+    is_deeply([map { $_->{kv}{key} } @events], ["${dir}b", "${dir}a"],
+        'coalesce: events in revision order');
+    is($events[0]{kv}{value}, 'b20', 'coalesce: newest PUT kept');
+    is($events[1]{type}, 'DELETE', 'coalesce: DELETE replaced the PUTs');
+    is($calls[0]{header}{revision}, $events[1]{kv}{mod_revision},
+        'coalesce: header is the latest');
+
+    $watch->cancel(sub { EV::break });
+    run_with_timeout();
+}
+
+# Cleanup
+$client->delete("$prefix/", { prefix => 1 }, sub {
+    ok(!$_[1], 'cleanup succeeded');
+    EV::break;
+});
+run_with_timeout();
+
+done_testing();
@@ -0,0 +1,115 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use lib 'blib/lib', 'blib/arch';
+use Test::More;
+
+BEGIN {
+    eval { require EV };
+    plan skip_all => 'EV required' if $@;
+}
+
+use EV;
+use EV::Etcd;
+
+# Check if etcd is available
+my $etcd_available = 0;
+eval {
+    my $client = EV::Etcd->new(
+        endpoints => ['127.0.0.1:2379'],
+        timeout => 2,
+    );
+    $client->status(sub {
+        my ($resp, $err) = @_;
+        $etcd_available = 1 if !$err;
+        EV::break;
+    });
+    my $t = EV::timer(3, 0, sub { EV::break });
+    EV::run;
+};
+
+plan skip_all => 'etcd not available on 127.0.0.1:2379' unless $etcd_available;
+
+my $client = EV::Etcd->new(endpoints => ['127.0.0.1:2379']);
+my $dir = "/test-watch-compaction-$$-" . time() . "/";
+
+sub run_with_timeout {
+    my $t = EV::timer(10, 0, sub { fail('timeout'); EV::break });
+    EV::run;
+}
+
+# History: a=1 (first_rev), b=1, a=2, c=1, then compact everything
+my ($first_rev, $last_rev);
+my @ops = ([a => 1], [b => 1], [a => 2], [c => 1]);
+my $next; $next = sub {
+    my $op = shift @ops or return EV::break;
+    $client->put("$dir$op->[0]", $op->[1], sub {
+        my ($resp, $err) = @_;
+        return fail("put: $err->{message}") if $err;
+        $first_rev //= $resp->{header}{revision};
+        $last_rev = $resp->{header}{revision};
+        $next->();
+    });
+};
+$next->();
+run_with_timeout();
+
+$client->compact($last_rev, sub {
+    ok(!$_[1], 'compacted history');
+    EV::break;
+});
+run_with_timeout();
+
+# Without recover_compaction resuming from a compacted revision fails
+{
+    my $err;
+    $client->watch($dir, { prefix => 1, start_revision => $first_rev, auto_reconnect => 0 }, sub {
+        $err = $_[1];
+        EV::break if $err;
+    });
+    run_with_timeout();
+    ok($err, 'plain watch gets an error on compaction');
+    is($err && $err->{compact_revision}, $last_rev, 'error carries compact_revision');
+}
+
+# With recover_compaction the callback gets a synthetic diff, then live events
+{
+    my @responses;
+    my $watch = $client->watch($dir, {
+        prefix => 1, start_revision => $first_rev, recover_compaction => 1,
+    }, sub {
+        my ($resp, $err) = @_;
+        return fail("watch error: $err->{message}") if $err;
+        return unless @{$resp->{events} || []};
+        push @responses, $resp;
+        EV::break;
+    });
+    run_with_timeout();
+
+    my $resync = $responses[0];
+    ok($resync && $resync->{resync}, 'first response is the resync diff');
+    is($resync->{compact_revision}, $last_rev, 'compact_revision reported');
+    my %state = map { $_->{kv}{key} => $_->{kv}{value} }
+        grep { $_->{type} eq 'PUT' } @{$resync->{events}};
+    is_deeply(\%state, { "${dir}a" => 2, "${dir}b" => 1, "${dir}c" => 1 },
+        'diff carries the current value of each changed key');
+    cmp_ok($resync->{header}{revision}, '>=', $last_rev, 'diff read at the current revision');
+
+    $client->put("${dir}d", 1, sub {});
+    run_with_timeout();
+    my $live = $responses[1];
+    ok($live && !$live->{resync}, 'watch resumed after the resync');
+    is($live->{events}[0]{kv}{key}, "${dir}d", 'live event after resync');
+
+    $watch->cancel(sub { EV::break });
+    run_with_timeout();
+}
+
+# Cleanup
+$client->delete($dir, { prefix => 1 }, sub {
+    ok(!$_[1], 'cleanup succeeded');
+    EV::break;
+});
+run_with_timeout();
+
+done_testing();
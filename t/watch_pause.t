@@ -0,0 +1,125 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use lib 'blib/lib', 'blib/arch';
+use Test::More;
+
+BEGIN {
+    eval { require EV };
+    plan skip_all => 'EV required' if $@;
+}
+
+use EV;
+use EV::Etcd;
+
+# Check if etcd is available
+my $etcd_available = 0;
+eval {
+    my $client = EV::Etcd->new(
+        endpoints => ['127.0.0.1:2379'],
+        timeout => 2,
+    );
+    $client->status(sub {
+        my ($resp, $err) = @_;
+        $etcd_available = 1 if !$err;
+        EV::break;
+    });
+    my $t = EV::timer(3, 0, sub { EV::break });
+    EV::run;
+};
+
+plan skip_all => 'etcd not available on 127.0.0.1:2379' unless $etcd_available;
+
+my $client = EV::Etcd->new(endpoints => ['127.0.0.1:2379']);
+my $prefix = "/test-watch-pause-$$-" . time();
+
+sub run_with_timeout {
+    my $t = EV::timer(10, 0, sub { fail('timeout'); EV::break });
+    EV::run;
+}
+
+sub wait_for {
+    my ($seconds) = @_;
+    my $t = EV::timer($seconds, 0, sub { EV::break });
+    EV::run;
+}
+
+sub put_all {
+    my ($dir, @keys) = @_;
+    my $next; $next = sub {
+        my $k = shift @keys;
+        return EV::break unless defined $k;
+        $client->put("$dir$k", "v$k", $next);
+    };
+    $next->();
+    run_with_timeout();
+}
+
+# pause/resume: events wait on the server side and arrive in order afterwards
+{
+    my $dir = "$prefix/pr/";
+    my (@keys, $ready);
+    my $watch;
+    $watch = $client->watch($dir, { prefix => 1 }, sub {
+        my ($resp, $err) = @_;
+        return fail("watch error: $err->{message}") if $err;
+        if (!$ready) {
+            $ready = 1;
+            $watch->pause;
+            EV::break;
+            return;
+        }
+        push @keys, map { $_->{kv}{key} } @{$resp->{events}};
+    });
+    run_with_timeout();
+    ok($watch->paused, 'paused reports true after pause');
+
+    put_all($dir, 1..5);
+    wait_for(0.5);
+    cmp_ok(scalar @keys, '<=', 1, 'at most the in-flight response arrives while paused');
+
+    $watch->resume;
+    ok(!$watch->paused, 'paused reports false after resume');
+    wait_for(0.5);
+    is_deeply(\@keys, [map { "$dir$_" } 1..5], 'all events delivered in order after resume');
+
+    # Cancelling a paused watch still completes
+    $watch->pause;
+    put_all($dir, 6..7);
+    wait_for(0.3);
+    my $cancelled;
+    $watch->cancel(sub { $cancelled = !$_[1]; EV::break });
+    run_with_timeout();
+    ok($cancelled, 'paused watch can be cancelled');
+}
+
+# max_pending_events with a coalescing window: nothing is lost
+{
+    my $dir = "$prefix/mpe/";
+    my (%seen, $ready);
+    my $watch = $client->watch($dir, {
+        prefix => 1, coalesce => 0.2, max_pending_events => 2, format => 'map',
+    }, sub {
+        my ($resp, $err) = @_;
+        return fail("watch error: $err->{message}") if $err;
+        if (!$ready) { $ready = 1; EV::break; return }
+        %seen = (%seen, %{$resp->{events}});
+    });
+    run_with_timeout();
+
+    put_all($dir, 1..10);
+    wait_for(3);
+    is(scalar keys %seen, 10, 'max_pending_events: every key delivered');
+
+    $watch->cancel(sub { EV::break });
+    run_with_timeout();
+}
+
+# Cleanup
+$client->delete("$prefix/", { prefix => 1 }, sub {
+    ok(!$_[1], 'cleanup succeeded');
+    EV::break;
+});
+run_with_timeout();
+
+done_testing();